@@ -589,12 +589,18 @@ void CpuEvalOutputAPI::setCoarsePositionsFromBuffer(const void *buffer,
   // TODO(sergey): Add sanity check on indices.
   const unsigned char *current_buffer = (unsigned char *)buffer;
   current_buffer += start_offset;
-  for (int i = 0; i < num_vertices; ++i) {
-    const int current_vertex_index = start_vertex_index + i;
+  if (stride == sizeof(float) * 3) {
     implementation_->updateData(
-        reinterpret_cast<const float *>(current_buffer), current_vertex_index, 1);
+        reinterpret_cast<const float *>(current_buffer), start_vertex_index, num_vertices);
+    return;
+  }
+  // Gather strided positions, so the vertex buffer is updated with a single call.
+  vector<float> positions(num_vertices * 3);
+  for (int i = 0; i < num_vertices; ++i) {
+    memcpy(&positions[i * 3], current_buffer, sizeof(float) * 3);
     current_buffer += stride;
   }
+  implementation_->updateData(positions.data(), start_vertex_index, num_vertices);
 }
 
 void CpuEvalOutputAPI::setVaryingDataFromBuffer(const void *buffer,
@@ -21,6 +21,9 @@
 
 #include <openvdb/tools/ValueTransformer.h> /* for tools::foreach */
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace internal {
 
 openvdb::Mat4R convertMatrix(const float mat[4][4])
@@ -122,6 +125,8 @@ openvdb::GridBase *OpenVDB_export_vector_grid(OpenVDBWriter *writer,
     vecgrid = tools::clip(*vecgrid, *mask);
   }
 
+  tools::prune(vecgrid->tree(), Vec3s(clipping));
+
   vecgrid->setName(name);
   vecgrid->setIsInWorldSpace(false);
   vecgrid->setVectorType(vec_type);
@@ -151,21 +156,25 @@ void OpenVDB_import_grid_vector(OpenVDBReader *reader,
   }
 
   Vec3SGrid::Ptr vgrid = gridPtrCast<Vec3SGrid>(reader->getGrid(name));
-  Vec3SGrid::ConstAccessor acc = vgrid->getConstAccessor();
-  math::Coord xyz;
-  int &x = xyz[0], &y = xyz[1], &z = xyz[2];
-
-  size_t index = 0;
-  for (z = 0; z < res[2]; ++z) {
-    for (y = 0; y < res[1]; ++y) {
-      for (x = 0; x < res[0]; ++x, ++index) {
-        math::Vec3s value = acc.getValue(xyz);
-        (*data_x)[index] = value.x();
-        (*data_y)[index] = value.y();
-        (*data_z)[index] = value.z();
+
+  /* Split the components slice by slice, each range uses its own accessor. */
+  tbb::parallel_for(tbb::blocked_range<int>(0, res[2]), [&](const tbb::blocked_range<int> &range) {
+    Vec3SGrid::ConstAccessor acc = vgrid->getConstAccessor();
+    math::Coord xyz;
+    int &x = xyz[0], &y = xyz[1], &z = xyz[2];
+
+    for (z = range.begin(); z != range.end(); ++z) {
+      size_t index = (size_t)z * res[0] * res[1];
+      for (y = 0; y < res[1]; ++y) {
+        for (x = 0; x < res[0]; ++x, ++index) {
+          math::Vec3s value = acc.getValue(xyz);
+          (*data_x)[index] = value.x();
+          (*data_y)[index] = value.y();
+          (*data_z)[index] = value.z();
+        }
       }
     }
-  }
+  });
 }
 
 openvdb::Name do_name_versionning(const openvdb::Name &name)
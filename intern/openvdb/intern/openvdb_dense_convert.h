@@ -25,6 +25,7 @@
 
 #include <openvdb/tools/Clip.h>
 #include <openvdb/tools/Dense.h>
+#include <openvdb/tools/Prune.h>
 
 #include <cstdio>
 
@@ -63,6 +64,9 @@ GridType *OpenVDB_export_grid(OpenVDBWriter *writer,
     grid = tools::clip(*grid, *mask);
   }
 
+  /* Collapse nodes of constant value within the clipping tolerance into tiles. */
+  tools::prune(grid->tree(), static_cast<typename GridType::ValueType>(clipping));
+
   grid->setName(name);
   grid->setIsInWorldSpace(false);
   grid->setVectorType(openvdb::VEC_INVARIANT);
@@ -93,19 +97,11 @@ void OpenVDB_import_grid(OpenVDBReader *reader,
   }
 
   typename GridType::Ptr grid = gridPtrCast<GridType>(reader->getGrid(temp_name));
-  typename GridType::ConstAccessor acc = grid->getConstAccessor();
-
-  math::Coord xyz;
-  int &x = xyz[0], &y = xyz[1], &z = xyz[2];
 
-  size_t index = 0;
-  for (z = 0; z < res[2]; ++z) {
-    for (y = 0; y < res[1]; ++y) {
-      for (x = 0; x < res[0]; ++x, ++index) {
-        (*data)[index] = acc.getValue(xyz);
-      }
-    }
-  }
+  /* Fills the whole box, voxels outside of the stored tree get the background value. */
+  math::CoordBBox bbox(Coord(0), Coord(res[0] - 1, res[1] - 1, res[2] - 1));
+  tools::Dense<T, tools::LayoutXYZ> dense_grid(bbox, *data);
+  tools::copyToDense(*grid, dense_grid);
 }
 
 openvdb::GridBase *OpenVDB_export_vector_grid(OpenVDBWriter *writer,
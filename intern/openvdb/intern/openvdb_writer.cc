@@ -20,6 +20,8 @@
 #include "openvdb_writer.h"
 #include "openvdb_util.h"
 
+#include <algorithm>
+
 OpenVDBWriter::OpenVDBWriter()
     : m_grids(new openvdb::GridPtrVec()), m_meta_map(new openvdb::MetaMap()), m_save_as_half(false)
 {
@@ -33,11 +35,14 @@ OpenVDBWriter::~OpenVDBWriter()
 void OpenVDBWriter::insert(const openvdb::GridBase::Ptr &grid)
 {
   grid->setSaveFloatAsHalf(m_save_as_half);
+
+  std::lock_guard<std::mutex> lock(m_grids_mutex);
   m_grids->push_back(grid);
 }
 
 void OpenVDBWriter::insert(const openvdb::GridBase &grid)
 {
+  std::lock_guard<std::mutex> lock(m_grids_mutex);
 #if (OPENVDB_LIBRARY_MAJOR_VERSION_NUMBER <= 3) || defined(OPENVDB_3_ABI_COMPATIBLE)
   m_grids->push_back(grid.copyGrid());
 #else
@@ -110,6 +115,13 @@ void OpenVDBWriter::setFlags(const int compression, const bool save_as_half)
 
 void OpenVDBWriter::write(const openvdb::Name &filename) const
 {
+  /* Insertion order depends on which export finished first, keep the files reproducible. */
+  std::sort(m_grids->begin(),
+            m_grids->end(),
+            [](const openvdb::GridBase::Ptr &a, const openvdb::GridBase::Ptr &b) {
+              return a->getName() < b->getName();
+            });
+
   try {
     openvdb::io::File file(filename);
     file.setCompression(m_compression_flags);
@@ -22,11 +22,16 @@
 
 #include <openvdb/openvdb.h>
 
+#include <mutex>
+
 struct OpenVDBWriter {
  private:
   openvdb::GridPtrVecPtr m_grids;
   openvdb::MetaMap::Ptr m_meta_map;
 
+  /* Grids may be exported from multiple threads at once. */
+  std::mutex m_grids_mutex;
+
   int m_compression_flags;
   bool m_save_as_half;
 
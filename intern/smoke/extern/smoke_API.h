@@ -38,6 +38,8 @@ void smoke_free(struct FLUID_3D *fluid);
 void smoke_initBlenderRNA(struct FLUID_3D *fluid, float *alpha, float *beta, float *dt_factor, float *vorticity, int *border_colli, float *burning_rate,
 						  float *flame_smoke, float *flame_smoke_color, float *flame_vorticity, float *flame_ignition_temp, float *flame_max_temp);
 void smoke_step(struct FLUID_3D *fluid, float gravity[3], float dtSubdiv);
+/* number of threads used by the solver steps, zero for all cores */
+void smoke_set_thread_count(int num_threads);
 
 float *smoke_get_density(struct FLUID_3D *fluid);
 float *smoke_get_flame(struct FLUID_3D *fluid);
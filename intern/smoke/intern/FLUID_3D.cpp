@@ -36,9 +36,7 @@
 
 #include "float.h"
 
-#if PARALLEL==1
-#include <omp.h>
-#endif // PARALLEL
+#include "THREADING.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -346,48 +344,16 @@ void FLUID_3D::step(float dt, float gravity[3])
 	// set vorticity from RNA value
 	_vorticityEps = (*_vorticityRNA)/_constantScaling;
 
-#if PARALLEL==1
-	int threadval = 1;
-	threadval = omp_get_max_threads();
-
-	int stepParts = 1;
-	float partSize = _zRes;
-
-	stepParts = threadval*2;	// Dividing parallelized sections into numOfThreads * 2 sections
-	partSize = (float)_zRes/stepParts;	// Size of one part;
-
-  if (partSize < 4) {stepParts = threadval;					// If the slice gets too low (might actually slow things down, change it to larger
-					partSize = (float)_zRes/stepParts;}
-  if (partSize < 4) {stepParts = (int)(ceil((float)_zRes/4.0f));	// If it's still too low (only possible on future systems with +24 cores), change it to 4
-					partSize = (float)_zRes/stepParts;}
-#else
-	int zBegin=0;
-	int zEnd=_zRes;
-#endif
+	const THREADING::SlabParts slabs(_zRes, _slabSize);
 
 	wipeBoundariesSL(0, _zRes);
 
-#if PARALLEL==1
-	#pragma omp parallel
-	{
-	#pragma omp for schedule(static,1)
-	for (int i=0; i<stepParts; i++)
-	{
-		int zBegin = (int)((float)i*partSize + 0.5f);
-		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
-#endif
-
+	THREADING::forSlabs(slabs, [this, gravity](int zBegin, int zEnd) {
 		addVorticity(zBegin, zEnd);
 		addBuoyancy(_heat, _density, gravity, zBegin, zEnd);
 		addForce(zBegin, zEnd);
+	});
 
-#if PARALLEL==1
-	}	// end of parallel
-	#pragma omp barrier
-
-	#pragma omp single
-	{
-#endif
 	/*
 	* addForce() changed Temp values to preserve thread safety
 	* (previous functions in per thread loop still needed
@@ -398,35 +364,15 @@ void FLUID_3D::step(float dt, float gravity[3])
 	SWAP_POINTERS(_xVelocity, _xVelocityTemp);
 	SWAP_POINTERS(_yVelocity, _yVelocityTemp);
 	SWAP_POINTERS(_zVelocity, _zVelocityTemp);
-#if PARALLEL==1
-	}	// end of single
 
-	#pragma omp barrier
-
-	#pragma omp for
-	for (int i=0; i<2; i++)
-	{
-		if (i==0)
-		{
-#endif
-			project();
-#if PARALLEL==1
-		}
-		else if (i==1)
-		{
-#endif
-			if (_heat) {
-				diffuseHeat();
-			}
-#if PARALLEL==1
+	// heat diffusion doesn't depend on the projection, so run them concurrently
+	THREADING::both([this]() { project(); },
+	                [this]() {
+		if (_heat) {
+			diffuseHeat();
 		}
-	}
-
-	#pragma omp barrier
+	});
 
-	#pragma omp single
-	{
-#endif
 	/*
 	* For thread safety use "Old" to read
 	* "current" values but still allow changing values.
@@ -446,55 +392,25 @@ void FLUID_3D::step(float dt, float gravity[3])
 
 	advectMacCormackBegin(0, _zRes);
 
-#if PARALLEL==1
-	}	// end of single
-
-	#pragma omp barrier
-
-
-	#pragma omp for schedule(static,1)
-	for (int i=0; i<stepParts; i++)
-	{
-
-		int zBegin = (int)((float)i*partSize + 0.5f);
-		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
-#endif
-
-	advectMacCormackEnd1(zBegin, zEnd);
-
-#if PARALLEL==1
-	}	// end of parallel
-
-	#pragma omp barrier
-
-	#pragma omp for schedule(static,1)
-	for (int i=0; i<stepParts; i++)
-	{
-
-		int zBegin = (int)((float)i*partSize + 0.5f);
-		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
-#endif
+	THREADING::forSlabs(slabs, [this](int zBegin, int zEnd) {
+		advectMacCormackEnd1(zBegin, zEnd);
+	});
 
+	THREADING::forSlabs(slabs, [this](int zBegin, int zEnd) {
 		advectMacCormackEnd2(zBegin, zEnd);
 
 		artificialDampingSL(zBegin, zEnd);
 
 		// Using forces as temp arrays
+	});
 
-#if PARALLEL==1
-	}
-	}
-
-
-
-	for (int i=1; i<stepParts; i++)
+	for (int i=1; i<slabs.parts; i++)
 	{
-		int zPos=(int)((float)i*partSize + 0.5f);
+		int zPos = slabs.begin(i);
 
 		artificialDampingExactSL(zPos);
 
 	}
-#endif
 
 	/*
 	* swap final velocity back to Velocity array
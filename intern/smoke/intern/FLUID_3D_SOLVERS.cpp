@@ -28,6 +28,7 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "FLUID_3D.h"
+#include "THREADING.h"
 #include <cstring>
 #define SOLVER_ACCURACY 1e-06
 
@@ -167,8 +168,6 @@ void FLUID_3D::solveHeat(float* field, float* b, unsigned char* skip)
 
 void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 {
-	int x, y, z;
-	size_t index;
 	float *_q, *_Precond, *_h, *_residual, *_direction;
 
 	// i = 0
@@ -186,50 +185,70 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 	memset(_h, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_Precond, 0, sizeof(float)*_xRes*_yRes*_zRes);
 
-	float deltaNew = 0.0f;
+	// The loops are split in z slabs over threads. Sums and maxima are
+	// computed per z slice and reduced in order afterwards, so results
+	// don't depend on the number of threads.
+	const THREADING::SlabParts slabs(_zRes, _slabSize);
+	float *_sliceSum = new float[_zRes];
+	float *_sliceMax = new float[_zRes];
+
+	memset(_sliceSum, 0, sizeof(float)*_zRes);
+	memset(_sliceMax, 0, sizeof(float)*_zRes);
 
 	// r = b - Ax
-	index = _slabSize + _xRes + 1;
-	for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-		for (y = 1; y < _yRes - 1; y++, index += 2)
-		  for (x = 1; x < _xRes - 1; x++, index++)
-		  {
-			// if the cell is a variable
-			float Acenter = 0.0f;
-			if (!skip[index])
-			{
-			  // set the matrix to the Poisson stencil in order
-			  if (!skip[index + 1]) Acenter += 1.0f;
-			  if (!skip[index - 1]) Acenter += 1.0f;
-			  if (!skip[index + _xRes]) Acenter += 1.0f;
-			  if (!skip[index - _xRes]) Acenter += 1.0f;
-			  if (!skip[index + _slabSize]) Acenter += 1.0f;
-			  if (!skip[index - _slabSize]) Acenter += 1.0f;
-
-			  _residual[index] = b[index] - (Acenter * field[index] +  
-			  field[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
-			  field[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
-			  field[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f)+
-			  field[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
-			  field[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f)+
-			  field[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f) );
-			}
-			else
-			{
-			_residual[index] = 0.0f;
-			}
-
-			// P^-1
-			if(Acenter < 1.0f)
-				_Precond[index] = 0.0;
-			else
-				_Precond[index] = 1.0f / Acenter;
-
-			// p = P^-1 * r
-			_direction[index] = _residual[index] * _Precond[index];
-
-			deltaNew += _residual[index] * _direction[index];
-		  }
+	THREADING::forSlabs(slabs, [&](int zBegin, int zEnd) {
+		for (int z = max(zBegin, 1); z < min(zEnd, _zRes - 1); z++)
+		{
+			size_t index = z * _slabSize + _xRes + 1;
+			float sum = 0.0f;
+
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+			  for (int x = 1; x < _xRes - 1; x++, index++)
+			  {
+				// if the cell is a variable
+				float Acenter = 0.0f;
+				if (!skip[index])
+				{
+				  // set the matrix to the Poisson stencil in order
+				  if (!skip[index + 1]) Acenter += 1.0f;
+				  if (!skip[index - 1]) Acenter += 1.0f;
+				  if (!skip[index + _xRes]) Acenter += 1.0f;
+				  if (!skip[index - _xRes]) Acenter += 1.0f;
+				  if (!skip[index + _slabSize]) Acenter += 1.0f;
+				  if (!skip[index - _slabSize]) Acenter += 1.0f;
+
+				  _residual[index] = b[index] - (Acenter * field[index] +  
+				  field[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
+				  field[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
+				  field[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f)+
+				  field[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
+				  field[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f)+
+				  field[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f) );
+				}
+				else
+				{
+				_residual[index] = 0.0f;
+				}
+
+				// P^-1
+				if(Acenter < 1.0f)
+					_Precond[index] = 0.0;
+				else
+					_Precond[index] = 1.0f / Acenter;
+
+				// p = P^-1 * r
+				_direction[index] = _residual[index] * _Precond[index];
+
+				sum += _residual[index] * _direction[index];
+			  }
+
+			_sliceSum[z] = sum;
+		}
+	});
+
+	float deltaNew = 0.0f;
+	for (int z = 1; z < _zRes - 1; z++)
+		deltaNew += _sliceSum[z];
 
 
   // While deltaNew > (eps^2) * delta0
@@ -242,39 +261,49 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 
 	float alpha = 0.0f;
 
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-        {
-          // if the cell is a variable
-          float Acenter = 0.0f;
-          if (!skip[index])
+    THREADING::forSlabs(slabs, [&](int zBegin, int zEnd) {
+      for (int z = max(zBegin, 1); z < min(zEnd, _zRes - 1); z++)
+      {
+        size_t index = z * _slabSize + _xRes + 1;
+        float sum = 0.0f;
+
+        for (int y = 1; y < _yRes - 1; y++, index += 2)
+          for (int x = 1; x < _xRes - 1; x++, index++)
           {
-            // set the matrix to the Poisson stencil in order
-            if (!skip[index + 1]) Acenter += 1.0f;
-            if (!skip[index - 1]) Acenter += 1.0f;
-            if (!skip[index + _xRes]) Acenter += 1.0f;
-            if (!skip[index - _xRes]) Acenter += 1.0f;
-            if (!skip[index + _slabSize]) Acenter += 1.0f;
-            if (!skip[index - _slabSize]) Acenter += 1.0f;
-
-			_q[index] = Acenter * _direction[index] +  
-            _direction[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
-            _direction[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
-            _direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f) +
-            _direction[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
-            _direction[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f) +
-            _direction[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f);
+            // if the cell is a variable
+            float Acenter = 0.0f;
+            if (!skip[index])
+            {
+              // set the matrix to the Poisson stencil in order
+              if (!skip[index + 1]) Acenter += 1.0f;
+              if (!skip[index - 1]) Acenter += 1.0f;
+              if (!skip[index + _xRes]) Acenter += 1.0f;
+              if (!skip[index - _xRes]) Acenter += 1.0f;
+              if (!skip[index + _slabSize]) Acenter += 1.0f;
+              if (!skip[index - _slabSize]) Acenter += 1.0f;
+
+			  _q[index] = Acenter * _direction[index] +  
+              _direction[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
+              _direction[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
+              _direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f) +
+              _direction[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
+              _direction[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f) +
+              _direction[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f);
+            }
+		    else
+		    {
+            _q[index] = 0.0f;
+		    }
+
+		    sum += _direction[index] * _q[index];
           }
-		  else
-		  {
-          _q[index] = 0.0f;
-		  }
 
-		  alpha += _direction[index] * _q[index];
-        }
+        _sliceSum[z] = sum;
+      }
+    });
 
+    for (int z = 1; z < _zRes - 1; z++)
+      alpha += _sliceSum[z];
 
     if (fabs(alpha) > 0.0f)
       alpha = deltaNew / alpha;
@@ -284,36 +313,53 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 
 	maxR = 0.0;
 
-	float tmp;
-
     // x = x + alpha * d
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-		{
-          field[index] += alpha * _direction[index];
+    THREADING::forSlabs(slabs, [&](int zBegin, int zEnd) {
+      for (int z = max(zBegin, 1); z < min(zEnd, _zRes - 1); z++)
+      {
+        size_t index = z * _slabSize + _xRes + 1;
+        float sum = 0.0f, sliceMax = 0.0f;
 
-		  _residual[index] -= alpha * _q[index];
+        for (int y = 1; y < _yRes - 1; y++, index += 2)
+          for (int x = 1; x < _xRes - 1; x++, index++)
+		  {
+            field[index] += alpha * _direction[index];
 
-		  _h[index] = _Precond[index] * _residual[index];
+		    _residual[index] -= alpha * _q[index];
 
-		  tmp = _residual[index] * _h[index];
-		  deltaNew += tmp;
-		  maxR = (tmp > maxR) ? tmp : maxR;
+		    _h[index] = _Precond[index] * _residual[index];
 
-		}
+		    float tmp = _residual[index] * _h[index];
+		    sum += tmp;
+		    sliceMax = (tmp > sliceMax) ? tmp : sliceMax;
+		  }
+
+        _sliceSum[z] = sum;
+        _sliceMax[z] = sliceMax;
+      }
+    });
+
+    for (int z = 1; z < _zRes - 1; z++)
+    {
+      deltaNew += _sliceSum[z];
+      maxR = (_sliceMax[z] > maxR) ? _sliceMax[z] : maxR;
+    }
 
 
     // beta = deltaNew / deltaOld
     float beta = deltaNew / deltaOld;
 
     // d = h + beta * d
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-          _direction[index] = _h[index] + beta * _direction[index];
+    THREADING::forSlabs(slabs, [&](int zBegin, int zEnd) {
+      for (int z = max(zBegin, 1); z < min(zEnd, _zRes - 1); z++)
+      {
+        size_t index = z * _slabSize + _xRes + 1;
+
+        for (int y = 1; y < _yRes - 1; y++, index += 2)
+          for (int x = 1; x < _xRes - 1; x++, index++)
+            _direction[index] = _h[index] + beta * _direction[index];
+      }
+    });
 
     // i = i + 1
     i++;
@@ -325,4 +371,6 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 	if (_residual) delete[] _residual;
 	if (_direction) delete[] _direction;
 	if (_q)       delete[] _q;
+	delete[] _sliceSum;
+	delete[] _sliceMax;
 }
@@ -0,0 +1,142 @@
+/** \file
+ * \ingroup smoke
+ */
+//////////////////////////////////////////////////////////////////////
+// This file is part of Wavelet Turbulence.
+//
+// Wavelet Turbulence is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Wavelet Turbulence is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Wavelet Turbulence.  If not, see <http://www.gnu.org/licenses/>.
+//
+// THREADING.cpp: persistent worker threads for the slab loops.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "THREADING.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace THREADING {
+
+static std::atomic<int> g_threadCount(0);
+
+void setThreadCount(int threads)
+{
+	g_threadCount = threads;
+}
+
+int threadCount()
+{
+	int threads = g_threadCount;
+	if (threads <= 0) {
+		threads = (int)std::thread::hardware_concurrency();
+	}
+	return (threads > 0) ? threads : 1;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Workers sleep on a condition variable between jobs. A job is posted by
+// bumping the generation, workers that aren't needed for it go back to
+// sleep. Only one job runs at a time, see runOnWorkers().
+//////////////////////////////////////////////////////////////////////
+class SlabThreadPool
+{
+public:
+	SlabThreadPool() : _generation(0), _threads(0), _pending(0), _func(NULL), _quit(false) {}
+
+	~SlabThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_quit = true;
+		}
+		_wake.notify_all();
+		for (std::thread &worker : _workers) {
+			worker.join();
+		}
+	}
+
+	bool run(int threads, const std::function<void(int)> &func)
+	{
+		std::unique_lock<std::mutex> job(_jobMutex, std::try_to_lock);
+		if (!job.owns_lock()) {
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			while ((int)_workers.size() < threads - 1) {
+				const int index = (int)_workers.size() + 1;
+				_workers.emplace_back(&SlabThreadPool::workerMain, this, index, _generation);
+			}
+			_func = &func;
+			_threads = threads;
+			_pending = threads - 1;
+			_generation++;
+		}
+		_wake.notify_all();
+
+		func(0);
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_done.wait(lock, [this] { return _pending == 0; });
+		_func = NULL;
+		return true;
+	}
+
+private:
+	void workerMain(int index, unsigned int generation)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		for (;;) {
+			_wake.wait(lock, [this, generation] { return _quit || _generation != generation; });
+			if (_quit) {
+				return;
+			}
+			generation = _generation;
+			if (index >= _threads) {
+				continue;
+			}
+
+			const std::function<void(int)> *func = _func;
+			lock.unlock();
+			(*func)(index);
+			lock.lock();
+
+			if (--_pending == 0) {
+				_done.notify_one();
+			}
+		}
+	}
+
+	std::mutex _jobMutex;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	std::condition_variable _done;
+	std::vector<std::thread> _workers;
+	unsigned int _generation;
+	int _threads;
+	int _pending;
+	const std::function<void(int)> *_func;
+	bool _quit;
+};
+
+bool runOnWorkers(int threads, const std::function<void(int)> &func)
+{
+	static SlabThreadPool pool;
+	return pool.run(threads, func);
+}
+
+} // namespace THREADING
@@ -0,0 +1,129 @@
+/** \file
+ * \ingroup smoke
+ */
+//////////////////////////////////////////////////////////////////////
+// This file is part of Wavelet Turbulence.
+//
+// Wavelet Turbulence is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Wavelet Turbulence is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Wavelet Turbulence.  If not, see <http://www.gnu.org/licenses/>.
+//
+// THREADING.h: threading helpers for the slab decomposed solver steps.
+//
+//////////////////////////////////////////////////////////////////////
+// These replace the former OpenMP regions, so the solver uses all
+// cores whether or not the build has OpenMP enabled. The worker threads
+// are persistent (THREADING.cpp), the solver runs many short parallel
+// loops per step.
+//////////////////////////////////////////////////////////////////////
+#ifndef THREADING_H
+#define THREADING_H
+
+#include <cmath>
+#include <functional>
+#include <thread>
+
+namespace THREADING {
+
+// Grids with fewer cells than this are processed on the calling thread,
+// waking up the workers costs more than the work itself.
+#define THREADING_MIN_CELLS (32 * 32 * 32)
+
+// number of threads the solver steps are split over, zero for all cores
+void setThreadCount(int threads);
+int threadCount();
+
+// Run func(thread) for thread in [0, threads) on the persistent worker
+// threads, the calling thread runs func(0). Returns false without calling
+// func when the workers are busy with another call (nested or concurrent
+// use), the caller then does all the work itself.
+bool runOnWorkers(int threads, const std::function<void(int)> &func);
+
+//////////////////////////////////////////////////////////////////////
+// Split of the z range of a grid into slabs. The same split is used by
+// all parallel sections of a step, so the seams between slabs stay in
+// place (see FLUID_3D::artificialDampingExactSL).
+//////////////////////////////////////////////////////////////////////
+struct SlabParts
+{
+	int threads;
+	int parts;
+	float partSize;
+
+	// slabSize is the number of cells in one z slice
+	SlabParts(int zRes, int slabSize)
+	{
+		threads = threadCount();
+
+		// Dividing parallelized sections into numOfThreads * 2 sections
+		parts = threads * 2;
+		partSize = (float)zRes / parts;
+
+		// If the slice gets too low (might actually slow things down, change it to larger
+		if (partSize < 4) {
+			parts = threads;
+			partSize = (float)zRes / parts;
+		}
+		// If it's still too low, change it to 4
+		if (partSize < 4) {
+			parts = (int)(ceil((float)zRes / 4.0f));
+			partSize = (float)zRes / parts;
+		}
+		if (parts < 1) {
+			parts = 1;
+			partSize = (float)zRes;
+		}
+		if (threads > parts) {
+			threads = parts;
+		}
+		// Small grids keep the split, so results don't change, but run serially.
+		if ((long long)zRes * slabSize < THREADING_MIN_CELLS) {
+			threads = 1;
+		}
+	}
+
+	int begin(int part) const { return (int)((float)part * partSize + 0.5f); }
+	int end(int part) const { return (int)((float)(part + 1) * partSize + 0.5f); }
+};
+
+// Call func(zBegin, zEnd) for every slab, slabs being interleaved over
+// the threads (like OpenMP's schedule(static,1)). The calling thread
+// takes part in the work.
+template<typename Func>
+static inline void forSlabs(const SlabParts &slabs, const Func &func)
+{
+	auto run = [&slabs, &func](int thread, int threads) {
+		for (int part = thread; part < slabs.parts; part += threads) {
+			func(slabs.begin(part), slabs.end(part));
+		}
+	};
+
+	if (slabs.threads > 1 &&
+	    runOnWorkers(slabs.threads, [&run, &slabs](int thread) { run(thread, slabs.threads); }))
+	{
+		return;
+	}
+	run(0, 1);
+}
+
+// Run two independent functions concurrently.
+template<typename FuncA, typename FuncB>
+static inline void both(const FuncA &funcA, const FuncB &funcB)
+{
+	std::thread worker(funcB);
+	funcA();
+	worker.join();
+}
+
+} // namespace THREADING
+
+#endif
@@ -41,9 +41,7 @@
 // needed to access static advection functions
 #include "FLUID_3D.h"
 
-#if PARALLEL==1
-#include <omp.h>
-#endif // PARALLEL 
+#include "THREADING.h"
 
 // 2^ {-5/6}
 static const float persistence = 0.56123f;
@@ -865,33 +863,15 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 	FLUID_3D::setNeumannZ(highFreqEnergy, ressm, 0 , ressm[2]);
 
 
-   int threadval = 1;
-#if PARALLEL==1
-  threadval = omp_get_max_threads();
-#endif
-
-
-  // parallel region setup
-  // Uses omp_get_max_trheads to get number of required cells.
-  float* maxVelMagThreads = new float[threadval];
-
-  for (int i=0; i<threadval; i++) maxVelMagThreads[i] = -1.0f;
-
-#if PARALLEL==1
-
-#pragma omp parallel
-#endif
-  { float maxVelMag1 = 0.;
-#if PARALLEL==1
-    const int id  = omp_get_thread_num(); /*, num = omp_get_num_threads(); */
-#endif
+  // maximum velocity magnitude per slice, reduced after the parallel loop
+  float* maxVelMagSlices = new float[_zResSm];
 
   // vector noise main loop
-#if PARALLEL==1
-#pragma omp for schedule(static,1)
-#endif
-  for (int zSmall = 0; zSmall < _zResSm; zSmall++)
+  const THREADING::SlabParts slabsSm(_zResSm, _slabSizeSm);
+  THREADING::forSlabs(slabsSm, [&](int zSmallBegin, int zSmallEnd) {
+  for (int zSmall = zSmallBegin; zSmall < zSmallEnd; zSmall++)
   {
+  float maxVelMag1 = 0.;
   for (int ySmall = 0; ySmall < _yResSm; ySmall++) 
   for (int xSmall = 0; xSmall < _xResSm; xSmall++)
   {
@@ -1025,23 +1005,17 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
         bigUx[index] = bigUy[index] = bigUz[index] = 0.;
     } // xyz*/
 
-#if PARALLEL==1
-    maxVelMagThreads[id] = maxVelMag1;
-#else
-    maxVelMagThreads[0] = maxVelMag1;
-#endif
   }
+  maxVelMagSlices[zSmall] = maxVelMag1;
   }
-  } // omp
-  
-  // compute maximum over threads
-  float maxVelMag = maxVelMagThreads[0];
-#if PARALLEL==1
-  for (int i = 1; i < threadval; i++) 
-    if (maxVelMag < maxVelMagThreads[i]) 
-      maxVelMag = maxVelMagThreads[i];
-#endif
-  delete [] maxVelMagThreads;
+  });
+
+  // compute maximum over slices
+  float maxVelMag = maxVelMagSlices[0];
+  for (int i = 1; i < _zResSm; i++) 
+    if (maxVelMag < maxVelMagSlices[i]) 
+      maxVelMag = maxVelMagSlices[i];
+  delete [] maxVelMagSlices;
 
 
   // prepare density for an advection
@@ -1068,33 +1042,13 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
   FLUID_3D::setZeroY(bigUy, _resBig, 0 , _resBig[2]); 
   FLUID_3D::setZeroZ(bigUz, _resBig, 0 , _resBig[2]);
 
-#if PARALLEL==1
-  int stepParts = threadval*2;	// Dividing parallelized sections into numOfThreads * 2 sections
-  float partSize = (float)_zResBig/stepParts;	// Size of one part;
-
-  if (partSize < 4) {stepParts = threadval;					// If the slice gets too low (might actually slow things down, change it to larger
-					partSize = (float)_zResBig/stepParts;}
-  if (partSize < 4) {stepParts = (int)(ceil((float)_zResBig/4.0f));	// If it's still too low (only possible on future systems with +24 cores), change it to 4
-					partSize = (float)_zResBig/stepParts;}
-#else
-  int zBegin=0;
-  int zEnd=_resBig[2];
-#endif
+  const THREADING::SlabParts slabs(_resBig[2], _slabSizeBig);
 
   // do the MacCormack advection, with substepping if necessary
   for(int substep = 0; substep < totalSubsteps; substep++)
   {
 
-#if PARALLEL==1
-	#pragma omp parallel
-	{
-
-	#pragma omp for schedule(static,1)
-	for (int i=0; i<stepParts; i++)
-	{
-		int zBegin = (int)((float)i*partSize + 0.5f);
-		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
-#endif
+	THREADING::forSlabs(slabs, [&](int zBegin, int zEnd) {
 		FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
 		    _densityBigOld, tempDensityBig, _resBig, zBegin, zEnd);
 		if (_fuelBig) {
@@ -1111,17 +1065,9 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
 				_color_bBigOld, tempColor_bBig, _resBig, zBegin, zEnd);
 		}
-#if PARALLEL==1
-	}
-
-	#pragma omp barrier
+	});
 
-	#pragma omp for schedule(static,1)
-	for (int i=0; i<stepParts; i++)
-	{
-		int zBegin = (int)((float)i*partSize + 0.5f);
-		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
-#endif
+	THREADING::forSlabs(slabs, [&](int zBegin, int zEnd) {
 		FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
 		    _densityBigOld, _densityBig, tempDensityBig, tempBig, _resBig, NULL, zBegin, zEnd);
 		if (_fuelBig) {
@@ -1138,10 +1084,7 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
 				_color_bBigOld, _color_bBig, tempColor_bBig, tempBig, _resBig, NULL, zBegin, zEnd);
 		}
-#if PARALLEL==1
-	}
-	}
-#endif
+	});
 
 	if (substep < totalSubsteps - 1) {
       SWAP_POINTERS(_densityBig, _densityBigOld);
@@ -23,6 +23,7 @@
 
 #include "FLUID_3D.h"
 #include "WTURBULENCE.h"
+#include "THREADING.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -79,6 +80,11 @@ extern "C" void smoke_step(FLUID_3D *fluid, float gravity[3], float dtSubdiv)
 	}
 }
 
+extern "C" void smoke_set_thread_count(int num_threads)
+{
+	THREADING::setThreadCount(num_threads);
+}
+
 extern "C" void smoke_turbulence_step(WTURBULENCE *wt, FLUID_3D *fluid)
 {
 	if (wt->_fuelBig) {
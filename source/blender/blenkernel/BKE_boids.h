@@ -40,11 +40,19 @@ typedef struct BoidBrainData {
   float goal_nor[3];
   float goal_priority;
 
+  /* Results of #boid_brain that change data other boids read,
+   * they are applied once the brains of all boids have been evaluated. */
+  float jump_vel[3];
+  bool jump;
+  struct BoidParticle *enemy;
+  float enemy_damage;
+
   struct RNG *rng;
 } BoidBrainData;
 
 void boids_precalc_rules(struct ParticleSettings *part, float cfra);
 void boid_brain(BoidBrainData *bbd, int p, struct ParticleData *pa);
+void boid_apply_damage(BoidBrainData *bbd);
 void boid_body(BoidBrainData *bbd, struct ParticleData *pa);
 void boid_default_settings(BoidSettings *boids);
 BoidRule *boid_new_rule(int type);
@@ -89,6 +89,12 @@ typedef struct Cloth {
   struct Implicit_Data *implicit; /* our implicit solver connects to this pointer */
   struct EdgeSet *edgeset;        /* used for selfcollisions */
   int last_frame, pad4;
+  /* Springs ordered by color for parallel force calculation, NULL for small cloths.
+   * Color c spans [spring_color_start[c], spring_color_start[c + 1]), the springs after the
+   * last color are calculated serially. */
+  struct ClothSpring **spring_order;
+  int *spring_color_start;
+  int spring_order_len, spring_colors;
 } Cloth;
 
 /**
@@ -27,6 +27,7 @@ struct DynamicPaintModifierData;
 struct DynamicPaintRuntime;
 struct Main;
 struct Scene;
+struct TaskPool;
 struct ViewLayer;
 
 /* Actual surface point */
@@ -102,7 +103,8 @@ int dynamicPaint_calculateFrame(struct DynamicPaintSurface *surface,
                                 int frame);
 void dynamicPaint_outputSurfaceImage(struct DynamicPaintSurface *surface,
                                      char *filename,
-                                     short output_layer);
+                                     short output_layer,
+                                     struct TaskPool *save_pool);
 
 /* PaintPoint state */
 #define DPAINT_PAINT_NONE -1
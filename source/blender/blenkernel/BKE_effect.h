@@ -127,6 +127,8 @@ void BKE_effectors_apply(struct ListBase *effectors,
                          struct EffectedPoint *point,
                          float *force,
                          float *impulse);
+bool BKE_effectors_use_noise(struct ListBase *effectors);
+void BKE_effectors_reset_rng(struct Depsgraph *depsgraph, struct ListBase *effectors);
 void BKE_effectors_free(struct ListBase *lb);
 
 void pd_point_from_particle(struct ParticleSimulationData *sim,
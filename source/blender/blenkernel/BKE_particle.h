@@ -165,6 +165,14 @@ typedef struct ParticleThreadContext {
 
   float cfra;
 
+  /* parent paths the children are interpolated from */
+  struct ParticleCacheKey **pcache;
+  /* per parent data shared by all of its children, indexed like psys->particles,
+   * NULL when evaluated per child (edit updates) */
+  float (*parent_hairmat)[4][4];
+  float (*parent_orco)[3];
+  float (*simple_orco)[3];
+
   float *vg_length, *vg_clump, *vg_kink;
   float *vg_rough1, *vg_rough2, *vg_roughe;
   float *vg_effector;
@@ -104,6 +104,8 @@ typedef struct PTCacheData {
 
 typedef struct PTCacheFile {
   FILE *fp;
+  /* Data is collected here when writing, the file is written asynchronously on close. */
+  struct PTCacheWriteJob *write_job;
 
   int frame, old_format;
   unsigned int totpoint, type;
@@ -305,6 +307,8 @@ bool BKE_ptcache_object_has(struct Scene *scene, struct Object *ob, int duplis);
 
 /***************** Global funcs ****************************/
 void BKE_ptcache_remove(void);
+void BKE_ptcache_write_flush(void);
+void BKE_ptcache_write_exit(void);
 
 /************ ID specific functions ************************/
 void BKE_ptcache_id_clear(PTCacheID *id, int mode, unsigned int cfra);
@@ -155,6 +155,21 @@ void BKE_scene_view_layer_graph_evaluated_ensure(struct Main *bmain,
                                                  struct Scene *scene,
                                                  struct ViewLayer *view_layer);
 
+/* Called once per evaluated frame, in the order frames were requested.
+ * The depsgraph is only valid for reading until the callback returns. */
+typedef void (*SceneFrameEvaluatedFn)(struct Depsgraph *depsgraph, float ctime, void *userdata);
+
+bool BKE_scene_has_simulation_history(struct Scene *scene, struct ViewLayer *view_layer);
+bool BKE_scene_graph_evaluate_frames(struct Main *bmain,
+                                     struct Scene *scene,
+                                     struct ViewLayer *view_layer,
+                                     const bool for_render,
+                                     const float *frames,
+                                     const int frames_len,
+                                     int num_graphs,
+                                     SceneFrameEvaluatedFn frame_fn,
+                                     void *userdata);
+
 struct SceneRenderView *BKE_scene_add_render_view(struct Scene *sce, const char *name);
 bool BKE_scene_remove_render_view(struct Scene *scene, struct SceneRenderView *srv);
 
@@ -105,6 +105,12 @@ typedef struct SubdivStats {
   /* Per-value timestamp on when corresponding BKE_subdiv_stats_begin() was
    * called. */
   double begin_timestamp_[NUM_SUBDIV_STATS_VALUES];
+
+  /* Number of updates which re-used the existing topology refiner, and number
+   * of updates which had to create a new one. Kept when the refiner is
+   * re-created. */
+  int num_topology_cache_hits;
+  int num_topology_cache_misses;
 } SubdivStats;
 
 /* Functor which evaluates dispalcement at a given (u, v) of given ptex face. */
@@ -160,6 +166,16 @@ typedef struct Subdiv {
   struct SubdivDisplacement *displacement_evaluator;
   /* Statistics for debugging. */
   SubdivStats stats;
+  /* Hash of the mesh topology the topology refiner was last validated for,
+   * zero when unknown. Allows to skip topology comparison in
+   * BKE_subdiv_update_from_mesh() when only vertex positions changed. */
+  unsigned int topology_hash;
+  /* Element counts of that mesh. Compared exactly on a hash match, so a hash
+   * collision can never make positions of a bigger mesh go to this refiner. */
+  int topology_totvert, topology_totedge, topology_totpoly, topology_totloop;
+  /* Copy of the loops of that mesh, compared exactly on a hash match, so a
+   * hash collision can not make a rewired mesh use this refiner. */
+  struct MLoop *topology_mloop;
 
   /* Cached values, are not supposed to be accessed directly. */
   struct {
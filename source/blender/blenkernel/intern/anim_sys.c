@@ -35,6 +35,7 @@
 #include "BLI_dynstr.h"
 #include "BLI_listbase.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.h"
 #include "BLI_math_rotation.h"
 #include "BLI_math_vector.h"
 
@@ -1872,10 +1873,52 @@ static void animsys_write_orig_anim_rna(PointerRNA *ptr,
   }
 }
 
+/* Minimum number of F-Curves before their values are calculated in parallel. */
+#define ANIMSYS_FCURVES_PARALLEL_THRESHOLD 256
+
+/* An F-Curve with its resolved property, gathered before evaluating. */
+typedef struct AnimsysFCurveChannel {
+  FCurve *fcu;
+  PathResolvedRNA anim_rna;
+  float value;
+} AnimsysFCurveChannel;
+
+typedef struct AnimsysFCurvesData {
+  AnimsysFCurveChannel *channels;
+  float ctime;
+} AnimsysFCurvesData;
+
+static bool animsys_fcurve_is_evaluated(const FCurve *fcu)
+{
+  /* Check if this F-Curve doesn't belong to a muted group. */
+  if ((fcu->grp != NULL) && (fcu->grp->flag & AGRP_MUTED)) {
+    return false;
+  }
+  /* Check if this curve should be skipped. */
+  if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED))) {
+    return false;
+  }
+  return true;
+}
+
+static void animsys_calculate_fcurve_cb(void *__restrict userdata,
+                                        const int i,
+                                        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  AnimsysFCurvesData *data = userdata;
+  AnimsysFCurveChannel *channel = &data->channels[i];
+
+  channel->value = calculate_fcurve(&channel->anim_rna, channel->fcu, data->ctime);
+}
+
 /**
  * Evaluate all the F-Curves in the given list
  * This performs a set of standard checks. If extra checks are required,
  * separate code should be used.
+ *
+ * Large lists are evaluated in three passes: properties are resolved first,
+ * then the curve values are calculated in parallel and finally written back
+ * (writing through RNA is not threadsafe).
  */
 static void animsys_evaluate_fcurves(Depsgraph *depsgraph,
                                      PointerRNA *ptr,
@@ -1883,25 +1926,64 @@ static void animsys_evaluate_fcurves(Depsgraph *depsgraph,
                                      float ctime)
 {
   const bool is_active_depsgraph = DEG_is_active(depsgraph);
-  /* Calculate then execute each curve. */
+  const int fcurves_len = BLI_listbase_count(list);
+
+  if (fcurves_len < ANIMSYS_FCURVES_PARALLEL_THRESHOLD) {
+    /* Calculate then execute each curve. */
+    for (FCurve *fcu = list->first; fcu; fcu = fcu->next) {
+      if (!animsys_fcurve_is_evaluated(fcu)) {
+        continue;
+      }
+      PathResolvedRNA anim_rna;
+      if (animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
+        const float curval = calculate_fcurve(&anim_rna, fcu, ctime);
+        animsys_write_rna_setting(&anim_rna, curval);
+        if (is_active_depsgraph) {
+          animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
+        }
+      }
+    }
+    return;
+  }
+
+  AnimsysFCurveChannel *channels = MEM_malloc_arrayN(
+      (size_t)fcurves_len, sizeof(*channels), __func__);
+  int channels_len = 0;
+  /* Drivers may run Python, never expected in actions but keep them on this thread. */
+  bool has_driver = false;
+
   for (FCurve *fcu = list->first; fcu; fcu = fcu->next) {
-    /* Check if this F-Curve doesn't belong to a muted group. */
-    if ((fcu->grp != NULL) && (fcu->grp->flag & AGRP_MUTED)) {
+    if (!animsys_fcurve_is_evaluated(fcu)) {
       continue;
     }
-    /* Check if this curve should be skipped. */
-    if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED))) {
-      continue;
+    AnimsysFCurveChannel *channel = &channels[channels_len];
+    if (animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, &channel->anim_rna)) {
+      channel->fcu = fcu;
+      channels_len++;
+      has_driver |= (fcu->driver != NULL);
     }
-    PathResolvedRNA anim_rna;
-    if (animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
-      const float curval = calculate_fcurve(&anim_rna, fcu, ctime);
-      animsys_write_rna_setting(&anim_rna, curval);
-      if (is_active_depsgraph) {
-        animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
-      }
+  }
+
+  AnimsysFCurvesData data = {
+      .channels = channels,
+      .ctime = ctime,
+  };
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (channels_len >= ANIMSYS_FCURVES_PARALLEL_THRESHOLD) && !has_driver;
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, channels_len, &data, animsys_calculate_fcurve_cb, &settings);
+
+  for (int i = 0; i < channels_len; i++) {
+    AnimsysFCurveChannel *channel = &channels[i];
+    animsys_write_rna_setting(&channel->anim_rna, channel->value);
+    if (is_active_depsgraph) {
+      animsys_write_orig_anim_rna(
+          ptr, channel->fcu->rna_path, channel->fcu->array_index, channel->value);
     }
   }
+
+  MEM_freeN(channels);
 }
 
 /* ***************************************** */
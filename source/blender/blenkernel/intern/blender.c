@@ -50,6 +50,7 @@
 #include "BKE_layer.h"
 #include "BKE_main.h"
 #include "BKE_node.h"
+#include "BKE_pointcache.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -78,6 +79,9 @@ void BKE_blender_free(void)
   /* Needs to run before main free as wm is still referenced for icons preview jobs. */
   BKE_studiolight_free();
 
+  /* Make sure disk caches are complete. */
+  BKE_ptcache_write_exit();
+
   BKE_main_free(G_MAIN);
   G_MAIN = NULL;
 
@@ -774,8 +774,9 @@ static int rule_fight(BoidRule *rule, BoidBrainData *bbd, BoidValues *val, Parti
 
       /* must face enemy to fight */
       if (dot_v3v3(pa->prev_state.ave, enemy_dir) > 0.5f) {
-        bpa = enemy_pa->boid;
-        bpa->data.health -= bbd->part->boids->strength * bbd->timestep *
+        /* Applied by #boid_apply_damage, the enemy may be evaluated at the same time. */
+        bbd->enemy = enemy_pa->boid;
+        bbd->enemy_damage = bbd->part->boids->strength * bbd->timestep *
                             ((1.0f - bbd->part->boids->accuracy) * damage +
                              bbd->part->boids->accuracy);
       }
@@ -1225,12 +1226,22 @@ void boid_brain(BoidBrainData *bbd, int p, ParticleData *pa)
       }
 
       if (jump) {
-        copy_v3_v3(pa->prev_state.vel, jump_v);
+        /* Other boids read the previous velocity, it's changed in #boid_body. */
+        copy_v3_v3(bbd->jump_vel, jump_v);
+        bbd->jump = true;
         bpa->data.mode = eBoidMode_Falling;
       }
     }
   }
 }
+/* deal the damage decided on in #boid_brain,
+ * only once all brains are evaluated since other boids read the health */
+void boid_apply_damage(BoidBrainData *bbd)
+{
+  if (bbd->enemy) {
+    bbd->enemy->data.health -= bbd->enemy_damage;
+  }
+}
 /* tries to realize the wanted velocity taking all constraints into account */
 void boid_body(BoidBrainData *bbd, ParticleData *pa)
 {
@@ -1250,6 +1261,10 @@ void boid_body(BoidBrainData *bbd, ParticleData *pa)
 
   set_boid_values(&val, boids, pa);
 
+  if (bbd->jump) {
+    copy_v3_v3(pa->prev_state.vel, bbd->jump_vel);
+  }
+
   /* make sure there's something in new velocity, location & rotation */
   copy_particle_key(&pa->state, &pa->prev_state, 0);
 
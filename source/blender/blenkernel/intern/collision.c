@@ -34,6 +34,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
@@ -72,6 +73,20 @@ typedef struct SelfColDetectData {
   bool collided;
 } SelfColDetectData;
 
+typedef struct SelfColResponseData {
+  ClothModifierData *clmd;
+  CollPair *collisions;
+  const int *pair_index;
+  float dt;
+  bool collided;
+  bool clamped;
+} SelfColResponseData;
+
+/* Number of colors used to resolve self-collision pairs in parallel, one bit per color. */
+#define SELFCOLL_COLOR_MAX 32
+/* Only resolve colors with more pairs than this in parallel. */
+#define SELFCOLL_PARALLEL_THRESHOLD 256
+
 /***********************************
  * Collision modifier code start
  ***********************************/
@@ -661,188 +676,277 @@ static int cloth_collision_response_static(ClothModifierData *clmd,
   return result;
 }
 
-static int cloth_selfcollision_response_static(ClothModifierData *clmd,
-                                               CollPair *collpair,
-                                               uint collision_count,
-                                               const float dt)
+static void cloth_selfcollision_response_cb(void *__restrict userdata,
+                                            const int index,
+                                            const ParallelRangeTLS *__restrict UNUSED(tls))
 {
+  SelfColResponseData *data = (SelfColResponseData *)userdata;
+  ClothModifierData *clmd = data->clmd;
+  CollPair *collpair = &data->collisions[data->pair_index[index]];
+  const float dt = data->dt;
   int result = 0;
   Cloth *cloth1;
   float w1, w2, w3, u1, u2, u3;
   float v1[3], v2[3], relativeVelocity[3];
+  float i1[3], i2[3], i3[3];
   float magrelVel;
 
   cloth1 = clmd->clothObject;
 
-  for (int i = 0; i < collision_count; i++, collpair++) {
-    float i1[3], i2[3], i3[3];
+  zero_v3(i1);
+  zero_v3(i2);
+  zero_v3(i3);
 
-    zero_v3(i1);
-    zero_v3(i2);
-    zero_v3(i3);
+  /* Compute barycentric coordinates for both collision points. */
+  collision_compute_barycentric(collpair->pa,
+                                cloth1->verts[collpair->ap1].tx,
+                                cloth1->verts[collpair->ap2].tx,
+                                cloth1->verts[collpair->ap3].tx,
+                                &w1,
+                                &w2,
+                                &w3);
 
-    /* Only handle static collisions here. */
-    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
-      continue;
-    }
+  collision_compute_barycentric(collpair->pb,
+                                cloth1->verts[collpair->bp1].tx,
+                                cloth1->verts[collpair->bp2].tx,
+                                cloth1->verts[collpair->bp3].tx,
+                                &u1,
+                                &u2,
+                                &u3);
 
-    /* Compute barycentric coordinates for both collision points. */
-    collision_compute_barycentric(collpair->pa,
-                                  cloth1->verts[collpair->ap1].tx,
-                                  cloth1->verts[collpair->ap2].tx,
-                                  cloth1->verts[collpair->ap3].tx,
-                                  &w1,
-                                  &w2,
-                                  &w3);
+  /* Calculate relative "velocity". */
+  collision_interpolateOnTriangle(v1,
+                                  cloth1->verts[collpair->ap1].tv,
+                                  cloth1->verts[collpair->ap2].tv,
+                                  cloth1->verts[collpair->ap3].tv,
+                                  w1,
+                                  w2,
+                                  w3);
+
+  collision_interpolateOnTriangle(v2,
+                                  cloth1->verts[collpair->bp1].tv,
+                                  cloth1->verts[collpair->bp2].tv,
+                                  cloth1->verts[collpair->bp3].tv,
+                                  u1,
+                                  u2,
+                                  u3);
 
-    collision_compute_barycentric(collpair->pb,
-                                  cloth1->verts[collpair->bp1].tx,
-                                  cloth1->verts[collpair->bp2].tx,
-                                  cloth1->verts[collpair->bp3].tx,
-                                  &u1,
-                                  &u2,
-                                  &u3);
+  sub_v3_v3v3(relativeVelocity, v2, v1);
 
-    /* Calculate relative "velocity". */
-    collision_interpolateOnTriangle(v1,
-                                    cloth1->verts[collpair->ap1].tv,
-                                    cloth1->verts[collpair->ap2].tv,
-                                    cloth1->verts[collpair->ap3].tv,
-                                    w1,
-                                    w2,
-                                    w3);
+  /* Calculate the normal component of the relative velocity
+   * (actually only the magnitude - the direction is stored in 'normal'). */
+  magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
 
-    collision_interpolateOnTriangle(v2,
-                                    cloth1->verts[collpair->bp1].tv,
-                                    cloth1->verts[collpair->bp2].tv,
-                                    cloth1->verts[collpair->bp3].tv,
-                                    u1,
-                                    u2,
-                                    u3);
+  /* TODO: Impulses should be weighed by mass as this is self col,
+   * this has to be done after mass distribution is implemented. */
 
-    sub_v3_v3v3(relativeVelocity, v2, v1);
+  /* If magrelVel < 0 the edges are approaching each other. */
+  if (magrelVel > 0.0f) {
+    /* Calculate Impulse magnitude to stop all motion in normal direction. */
+    float magtangent = 0, repulse = 0, d = 0;
+    double impulse = 0.0;
+    float vrel_t_pre[3];
+    float temp[3], time_multiplier;
 
-    /* Calculate the normal component of the relative velocity
-     * (actually only the magnitude - the direction is stored in 'normal'). */
-    magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
+    /* Calculate tangential velocity. */
+    copy_v3_v3(temp, collpair->normal);
+    mul_v3_fl(temp, magrelVel);
+    sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
 
-    /* TODO: Impulses should be weighed by mass as this is self col,
-     * this has to be done after mass distribution is implemented. */
+    /* Decrease in magnitude of relative tangential velocity due to coulomb friction
+     * in original formula "magrelVel" should be the
+     * "change of relative velocity in normal direction". */
+    magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
 
-    /* If magrelVel < 0 the edges are approaching each other. */
-    if (magrelVel > 0.0f) {
-      /* Calculate Impulse magnitude to stop all motion in normal direction. */
-      float magtangent = 0, repulse = 0, d = 0;
-      double impulse = 0.0;
-      float vrel_t_pre[3];
-      float temp[3], time_multiplier;
+    /* Apply friction impulse. */
+    if (magtangent > ALMOST_ZERO) {
+      normalize_v3(vrel_t_pre);
 
-      /* Calculate tangential velocity. */
-      copy_v3_v3(temp, collpair->normal);
-      mul_v3_fl(temp, magrelVel);
-      sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
+      impulse = magtangent / 1.5;
 
-      /* Decrease in magnitude of relative tangential velocity due to coulomb friction
-       * in original formula "magrelVel" should be the
-       * "change of relative velocity in normal direction". */
-      magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
+      VECADDMUL(i1, vrel_t_pre, w1 * impulse);
+      VECADDMUL(i2, vrel_t_pre, w2 * impulse);
+      VECADDMUL(i3, vrel_t_pre, w3 * impulse);
+    }
 
-      /* Apply friction impulse. */
-      if (magtangent > ALMOST_ZERO) {
-        normalize_v3(vrel_t_pre);
+    /* Apply velocity stopping impulse. */
+    impulse = magrelVel / 3.0f;
 
-        impulse = magtangent / 1.5;
+    VECADDMUL(i1, collpair->normal, w1 * impulse);
+    cloth1->verts[collpair->ap1].impulse_count++;
 
-        VECADDMUL(i1, vrel_t_pre, w1 * impulse);
-        VECADDMUL(i2, vrel_t_pre, w2 * impulse);
-        VECADDMUL(i3, vrel_t_pre, w3 * impulse);
+    VECADDMUL(i2, collpair->normal, w2 * impulse);
+    cloth1->verts[collpair->ap2].impulse_count++;
+
+    VECADDMUL(i3, collpair->normal, w3 * impulse);
+    cloth1->verts[collpair->ap3].impulse_count++;
+
+    time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
+
+    d = clmd->coll_parms->selfepsilon * 8.0f / 9.0f * 2.0f - collpair->distance;
+
+    if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
+      repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+
+      if (impulse > ALMOST_ZERO) {
+        repulse = min_ff(repulse, 5.0 * impulse);
       }
 
-      /* Apply velocity stopping impulse. */
-      impulse = magrelVel / 3.0f;
+      repulse = max_ff(impulse, repulse);
 
-      VECADDMUL(i1, collpair->normal, w1 * impulse);
-      cloth1->verts[collpair->ap1].impulse_count++;
+      impulse = repulse / 1.5f;
 
+      VECADDMUL(i1, collpair->normal, w1 * impulse);
       VECADDMUL(i2, collpair->normal, w2 * impulse);
-      cloth1->verts[collpair->ap2].impulse_count++;
+      VECADDMUL(i3, collpair->normal, w3 * impulse);
+    }
+
+    result = 1;
+  }
+  else {
+    float time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
+    float d;
+
+    d = clmd->coll_parms->selfepsilon * 8.0f / 9.0f * 2.0f - collpair->distance;
+
+    if (d > ALMOST_ZERO) {
+      /* Stay on the safe side and clamp repulse. */
+      float repulse = d * 1.0f / time_multiplier;
+      float impulse = repulse / 9.0f;
 
+      VECADDMUL(i1, collpair->normal, w1 * impulse);
+      VECADDMUL(i2, collpair->normal, w2 * impulse);
       VECADDMUL(i3, collpair->normal, w3 * impulse);
-      cloth1->verts[collpair->ap3].impulse_count++;
 
-      time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
+      cloth1->verts[collpair->ap1].impulse_count++;
+      cloth1->verts[collpair->ap2].impulse_count++;
+      cloth1->verts[collpair->ap3].impulse_count++;
 
-      d = clmd->coll_parms->selfepsilon * 8.0f / 9.0f * 2.0f - collpair->distance;
+      result = 1;
+    }
+  }
 
-      if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
-        repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+  if (result) {
+    float clamp = clmd->coll_parms->self_clamp * dt;
 
-        if (impulse > ALMOST_ZERO) {
-          repulse = min_ff(repulse, 5.0 * impulse);
-        }
+    if ((clamp > 0.0f) &&
+        ((len_v3(i1) > clamp) || (len_v3(i2) > clamp) || (len_v3(i3) > clamp))) {
+      data->clamped = true;
+      return;
+    }
 
-        repulse = max_ff(impulse, repulse);
+    for (int j = 0; j < 3; j++) {
+      if (cloth1->verts[collpair->ap1].impulse_count > 0 &&
+          ABS(cloth1->verts[collpair->ap1].impulse[j]) < ABS(i1[j])) {
+        cloth1->verts[collpair->ap1].impulse[j] = i1[j];
+      }
 
-        impulse = repulse / 1.5f;
+      if (cloth1->verts[collpair->ap2].impulse_count > 0 &&
+          ABS(cloth1->verts[collpair->ap2].impulse[j]) < ABS(i2[j])) {
+        cloth1->verts[collpair->ap2].impulse[j] = i2[j];
+      }
 
-        VECADDMUL(i1, collpair->normal, w1 * impulse);
-        VECADDMUL(i2, collpair->normal, w2 * impulse);
-        VECADDMUL(i3, collpair->normal, w3 * impulse);
+      if (cloth1->verts[collpair->ap3].impulse_count > 0 &&
+          ABS(cloth1->verts[collpair->ap3].impulse[j]) < ABS(i3[j])) {
+        cloth1->verts[collpair->ap3].impulse[j] = i3[j];
       }
+    }
 
-      result = 1;
+    data->collided = true;
+  }
+}
+
+/* Greedy coloring of the active self-collision pairs: pairs of the same color don't share
+ * any of the cloth vertices they write impulses to, so each color can be resolved in parallel.
+ * Returns the pair indices sorted by color, with the pairs of color `i` stored from
+ * `r_color_start[i]` to `r_color_start[i + 1]`. Pairs that don't fit in any color are stored
+ * last, in the #SELFCOLL_COLOR_MAX batch which is resolved serially. */
+static int *cloth_selfcollision_color_pairs(Cloth *cloth,
+                                            CollPair *collisions,
+                                            int collision_count,
+                                            int r_color_start[SELFCOLL_COLOR_MAX + 2])
+{
+  uint *vert_colors = MEM_callocN(sizeof(*vert_colors) * cloth->mvert_num, __func__);
+  signed char *pair_color = MEM_mallocN(sizeof(*pair_color) * collision_count, __func__);
+  int *pair_index = MEM_mallocN(sizeof(*pair_index) * collision_count, __func__);
+  int color_len[SELFCOLL_COLOR_MAX + 1] = {0};
+
+  for (int i = 0; i < collision_count; i++) {
+    const CollPair *collpair = &collisions[i];
+
+    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
+      pair_color[i] = -1;
+      continue;
     }
-    else {
-      float time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
-      float d;
 
-      d = clmd->coll_parms->selfepsilon * 8.0f / 9.0f * 2.0f - collpair->distance;
+    const uint used = vert_colors[collpair->ap1] | vert_colors[collpair->ap2] |
+                      vert_colors[collpair->ap3];
+    int color = SELFCOLL_COLOR_MAX;
 
-      if (d > ALMOST_ZERO) {
-        /* Stay on the safe side and clamp repulse. */
-        float repulse = d * 1.0f / time_multiplier;
-        float impulse = repulse / 9.0f;
+    if (used != ~0u) {
+      color = (int)bitscan_forward_uint(~used);
 
-        VECADDMUL(i1, collpair->normal, w1 * impulse);
-        VECADDMUL(i2, collpair->normal, w2 * impulse);
-        VECADDMUL(i3, collpair->normal, w3 * impulse);
+      const uint color_bit = 1u << color;
+      vert_colors[collpair->ap1] |= color_bit;
+      vert_colors[collpair->ap2] |= color_bit;
+      vert_colors[collpair->ap3] |= color_bit;
+    }
 
-        cloth1->verts[collpair->ap1].impulse_count++;
-        cloth1->verts[collpair->ap2].impulse_count++;
-        cloth1->verts[collpair->ap3].impulse_count++;
+    pair_color[i] = (signed char)color;
+    color_len[color]++;
+  }
 
-        result = 1;
-      }
+  r_color_start[0] = 0;
+  for (int color = 0; color <= SELFCOLL_COLOR_MAX; color++) {
+    r_color_start[color + 1] = r_color_start[color] + color_len[color];
+    color_len[color] = r_color_start[color];
+  }
+
+  /* Keep the original pair order within each color, for deterministic results. */
+  for (int i = 0; i < collision_count; i++) {
+    if (pair_color[i] != -1) {
+      pair_index[color_len[(int)pair_color[i]]++] = i;
     }
+  }
 
-    if (result) {
-      float clamp = clmd->coll_parms->self_clamp * dt;
+  MEM_freeN(vert_colors);
+  MEM_freeN(pair_color);
 
-      if ((clamp > 0.0f) &&
-          ((len_v3(i1) > clamp) || (len_v3(i2) > clamp) || (len_v3(i3) > clamp))) {
-        return 0;
-      }
+  return pair_index;
+}
 
-      for (int j = 0; j < 3; j++) {
-        if (cloth1->verts[collpair->ap1].impulse_count > 0 &&
-            ABS(cloth1->verts[collpair->ap1].impulse[j]) < ABS(i1[j])) {
-          cloth1->verts[collpair->ap1].impulse[j] = i1[j];
-        }
+static int cloth_selfcollision_response_static(ClothModifierData *clmd,
+                                               CollPair *collisions,
+                                               const int *pair_index,
+                                               const int color_start[SELFCOLL_COLOR_MAX + 2],
+                                               const float dt)
+{
+  SelfColResponseData data = {
+      .clmd = clmd,
+      .collisions = collisions,
+      .dt = dt,
+      .collided = false,
+      .clamped = false,
+  };
 
-        if (cloth1->verts[collpair->ap2].impulse_count > 0 &&
-            ABS(cloth1->verts[collpair->ap2].impulse[j]) < ABS(i2[j])) {
-          cloth1->verts[collpair->ap2].impulse[j] = i2[j];
-        }
+  for (int color = 0; color <= SELFCOLL_COLOR_MAX; color++) {
+    const int pair_num = color_start[color + 1] - color_start[color];
 
-        if (cloth1->verts[collpair->ap3].impulse_count > 0 &&
-            ABS(cloth1->verts[collpair->ap3].impulse[j]) < ABS(i3[j])) {
-          cloth1->verts[collpair->ap3].impulse[j] = i3[j];
-        }
-      }
+    data.pair_index = &pair_index[color_start[color]];
+
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (color != SELFCOLL_COLOR_MAX) &&
+                             (pair_num > SELFCOLL_PARALLEL_THRESHOLD);
+    BLI_task_parallel_range(0, pair_num, &data, cloth_selfcollision_response_cb, &settings);
+
+    /* An impulse exceeding the clamp value invalidates the whole pass. */
+    if (data.clamped) {
+      return 0;
     }
   }
 
-  return result;
+  return data.collided;
 }
 
 #ifdef __GNUC__
@@ -1246,13 +1350,19 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
   int ret = 0;
   int result = 0;
 
+  int color_start[SELFCOLL_COLOR_MAX + 2];
+  int *pair_index;
+
   mvert_num = clmd->clothObject->mvert_num;
   verts = cloth->verts;
 
+  /* The pairs don't change between iterations, so color them once. */
+  pair_index = cloth_selfcollision_color_pairs(cloth, collisions, collision_count, color_start);
+
   for (j = 0; j < 2; j++) {
     result = 0;
 
-    result += cloth_selfcollision_response_static(clmd, collisions, collision_count, dt);
+    result += cloth_selfcollision_response_static(clmd, collisions, pair_index, color_start, dt);
 
     /* Apply impulses in parallel. */
     if (result) {
@@ -1273,6 +1383,9 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
       break;
     }
   }
+
+  MEM_freeN(pair_index);
+
   return ret;
 }
 
@@ -32,6 +32,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 
 #include "DNA_anim_types.h"
 #include "DNA_curve_types.h"
@@ -2704,6 +2705,118 @@ void BKE_curve_bevelList_free(ListBase *bev)
   BLI_listbase_clear(bev);
 }
 
+/* Minimum number of bevel points before the per bevel list work is threaded. */
+#define BEVLIST_PARALLEL_THRESHOLD 4096
+
+typedef struct BevelListTaskData {
+  BevList **bevlists;
+  const Curve *cu;
+  bool use_seglen;
+  int smooth_iter;
+} BevelListTaskData;
+
+static BevList **bevel_list_array_from_listbase(ListBase *bev, int *r_len, int *r_totpoint)
+{
+  BevList **bevlists = MEM_malloc_arrayN(
+      BLI_listbase_count(bev), sizeof(*bevlists), "bevel_list_array");
+  int len = 0, totpoint = 0;
+  for (BevList *bl = bev->first; bl; bl = bl->next) {
+    bevlists[len++] = bl;
+    totpoint += bl->nr;
+  }
+  *r_len = len;
+  *r_totpoint = totpoint;
+  return bevlists;
+}
+
+static void bevel_list_parallel_settings_init(ParallelRangeSettings *settings,
+                                              const int len,
+                                              const int totpoint)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (len > 1) && (totpoint > BEVLIST_PARALLEL_THRESHOLD);
+  settings->min_iter_per_thread = 1;
+}
+
+static void bevel_list_tag_doubles_cb(void *__restrict userdata,
+                                      const int i,
+                                      const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const BevelListTaskData *data = userdata;
+  BevList *bl = data->bevlists[i];
+  BevPoint *bevp0, *bevp1;
+  const float treshold = 0.00001f;
+  int nr;
+
+  if (bl->nr == 0) { /* null bevel items come from single points */
+    return;
+  }
+
+  bool is_cyclic = bl->poly != -1;
+  nr = bl->nr;
+  if (is_cyclic) {
+    bevp1 = bl->bevpoints;
+    bevp0 = bevp1 + (nr - 1);
+  }
+  else {
+    bevp0 = bl->bevpoints;
+    bevp0->offset = 0;
+    bevp1 = bevp0 + 1;
+  }
+  nr--;
+  while (nr--) {
+    if (data->use_seglen) {
+      if (fabsf(bevp1->offset) < treshold) {
+        bevp0->dupe_tag = true;
+        bl->dupe_nr++;
+      }
+    }
+    else {
+      if (fabsf(bevp0->vec[0] - bevp1->vec[0]) < 0.00001f) {
+        if (fabsf(bevp0->vec[1] - bevp1->vec[1]) < 0.00001f) {
+          if (fabsf(bevp0->vec[2] - bevp1->vec[2]) < 0.00001f) {
+            bevp0->dupe_tag = true;
+            bl->dupe_nr++;
+          }
+        }
+      }
+    }
+    bevp0 = bevp1;
+    bevp1++;
+  }
+}
+
+static void bevel_list_orientation_cb(void *__restrict userdata,
+                                      const int i,
+                                      const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const BevelListTaskData *data = userdata;
+  BevList *bl = data->bevlists[i];
+
+  if (bl->nr < 2) {
+    BevPoint *bevp = bl->bevpoints;
+    unit_qt(bevp->quat);
+  }
+  else if ((data->cu->flag & CU_3D) == 0) {
+    /* 2D Curves */
+    if (bl->nr == 2) { /* 2 pnt, treat separate */
+      make_bevel_list_segment_2D(bl);
+    }
+    else {
+      make_bevel_list_2D(bl);
+    }
+  }
+  else {
+    /* 3D Curves */
+    if (bl->nr == 2) { /* 2 pnt, treat separate */
+      make_bevel_list_segment_3D(bl);
+    }
+    else {
+      make_bevel_list_3D(bl, data->smooth_iter, data->cu->twist_mode);
+    }
+  }
+}
+
 void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
 {
   /*
@@ -3048,44 +3161,19 @@ void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
   }
 
   /* STEP 2: DOUBLE POINTS AND AUTOMATIC RESOLUTION, REDUCE DATABLOCKS */
-  bl = bev->first;
-  while (bl) {
-    if (bl->nr) { /* null bevel items come from single points */
-      bool is_cyclic = bl->poly != -1;
-      nr = bl->nr;
-      if (is_cyclic) {
-        bevp1 = bl->bevpoints;
-        bevp0 = bevp1 + (nr - 1);
-      }
-      else {
-        bevp0 = bl->bevpoints;
-        bevp0->offset = 0;
-        bevp1 = bevp0 + 1;
-      }
-      nr--;
-      while (nr--) {
-        if (seglen != NULL) {
-          if (fabsf(bevp1->offset) < treshold) {
-            bevp0->dupe_tag = true;
-            bl->dupe_nr++;
-          }
-        }
-        else {
-          if (fabsf(bevp0->vec[0] - bevp1->vec[0]) < 0.00001f) {
-            if (fabsf(bevp0->vec[1] - bevp1->vec[1]) < 0.00001f) {
-              if (fabsf(bevp0->vec[2] - bevp1->vec[2]) < 0.00001f) {
-                bevp0->dupe_tag = true;
-                bl->dupe_nr++;
-              }
-            }
-          }
-        }
-        bevp0 = bevp1;
-        bevp1++;
-      }
-    }
-    bl = bl->next;
-  }
+  BevelListTaskData task_data = {
+      .cu = cu,
+      .use_seglen = (seglen != NULL),
+      .smooth_iter = 0,
+  };
+  ParallelRangeSettings settings;
+  int bevlists_len, totpoint;
+
+  task_data.bevlists = bevel_list_array_from_listbase(bev, &bevlists_len, &totpoint);
+  bevel_list_parallel_settings_init(&settings, bevlists_len, totpoint);
+  BLI_task_parallel_range(0, bevlists_len, &task_data, bevel_list_tag_doubles_cb, &settings);
+  MEM_freeN(task_data.bevlists);
+
   bl = bev->first;
   while (bl) {
     blnext = bl->next;
@@ -3223,36 +3311,12 @@ void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
   }
 
   /* STEP 4: 2D-COSINES or 3D ORIENTATION */
-  if ((cu->flag & CU_3D) == 0) {
-    /* 2D Curves */
-    for (bl = bev->first; bl; bl = bl->next) {
-      if (bl->nr < 2) {
-        BevPoint *bevp = bl->bevpoints;
-        unit_qt(bevp->quat);
-      }
-      else if (bl->nr == 2) { /* 2 pnt, treat separate */
-        make_bevel_list_segment_2D(bl);
-      }
-      else {
-        make_bevel_list_2D(bl);
-      }
-    }
-  }
-  else {
-    /* 3D Curves */
-    for (bl = bev->first; bl; bl = bl->next) {
-      if (bl->nr < 2) {
-        BevPoint *bevp = bl->bevpoints;
-        unit_qt(bevp->quat);
-      }
-      else if (bl->nr == 2) { /* 2 pnt, treat separate */
-        make_bevel_list_segment_3D(bl);
-      }
-      else {
-        make_bevel_list_3D(bl, (int)(resolu * cu->twist_smooth), cu->twist_mode);
-      }
-    }
-  }
+  /* Bevel lists are independent of each other. */
+  task_data.smooth_iter = (int)(resolu * cu->twist_smooth);
+  task_data.bevlists = bevel_list_array_from_listbase(bev, &bevlists_len, &totpoint);
+  bevel_list_parallel_settings_init(&settings, bevlists_len, totpoint);
+  BLI_task_parallel_range(0, bevlists_len, &task_data, bevel_list_orientation_cb, &settings);
+  MEM_freeN(task_data.bevlists);
 }
 
 /* ****************** HANDLES ************** */
@@ -39,6 +39,7 @@
 #include "BLI_scanfill.h"
 #include "BLI_utildefines.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 
 #include "BKE_displist.h"
 #include "BKE_cdderivedmesh.h"
@@ -1363,6 +1364,83 @@ static void rotateBevelPiece(Curve *cu,
   *r_data = data;
 }
 
+/* Minimum number of extruded vertices before bevel pieces are rotated in parallel. */
+#define BEVEL_PIECES_PARALLEL_THRESHOLD 8192
+
+typedef struct BevelPiecesData {
+  Depsgraph *depsgraph;
+  Scene *scene;
+  Curve *cu;
+  BevList *bl;
+  DispList *dlb;
+  float *data;
+  float widfac;
+  float firstblend, lastblend;
+  int start, steps;
+} BevelPiecesData;
+
+/* Fill one ring of the extruded surface, `a` is the step along the bevel list. */
+static void bevel_piece_cb(void *__restrict userdata,
+                           const int a,
+                           const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const BevelPiecesData *pd = userdata;
+  Curve *cu = pd->cu;
+  BevList *bl = pd->bl;
+  const int steps = pd->steps;
+  const int i = pd->start + a;
+  BevPoint *bevp_first = bl->bevpoints;
+  BevPoint *bevp_last = &bl->bevpoints[bl->nr - 1];
+  BevPoint *bevp = &bl->bevpoints[i];
+  float *data = pd->data + (size_t)3 * pd->dlb->nr * a;
+  float fac = 1.0;
+
+  if (cu->taperobj == NULL) {
+    fac = bevp->radius;
+  }
+  else {
+    float len, taper_fac;
+
+    if (cu->flag & CU_MAP_TAPER) {
+      len = (steps - 3) + pd->firstblend + pd->lastblend;
+
+      if (a == 0) {
+        taper_fac = 0.0f;
+      }
+      else if (a == steps - 1) {
+        taper_fac = 1.0f;
+      }
+      else {
+        taper_fac = ((float)a - (1.0f - pd->firstblend)) / len;
+      }
+    }
+    else {
+      len = bl->nr - 1;
+      taper_fac = (float)i / len;
+
+      if (a == 0) {
+        taper_fac += (1.0f - pd->firstblend) / len;
+      }
+      else if (a == steps - 1) {
+        taper_fac -= (1.0f - pd->lastblend) / len;
+      }
+    }
+
+    fac = displist_calc_taper(pd->depsgraph, pd->scene, cu->taperobj, taper_fac);
+  }
+
+  /* rotate bevel piece and write in data */
+  if ((a == 0) && (bevp != bevp_last)) {
+    rotateBevelPiece(cu, bevp, bevp + 1, pd->dlb, 1.0f - pd->firstblend, pd->widfac, fac, &data);
+  }
+  else if ((a == steps - 1) && (bevp != bevp_first)) {
+    rotateBevelPiece(cu, bevp, bevp - 1, pd->dlb, 1.0f - pd->lastblend, pd->widfac, fac, &data);
+  }
+  else {
+    rotateBevelPiece(cu, bevp, NULL, pd->dlb, 0.0f, pd->widfac, fac, &data);
+  }
+}
+
 static void fillBevelCap(Nurb *nu, DispList *dlb, float *prev_fp, ListBase *dispbase)
 {
   DispList *dl;
@@ -1634,7 +1712,7 @@ static void do_makeDispListCurveTypes(Depsgraph *depsgraph,
             float bottom_no[3] = {0.0f};
             float top_no[3] = {0.0f};
             float firstblend = 0.0f, lastblend = 0.0f;
-            int i, start, steps = 0;
+            int start = 0, steps = 0;
 
             if (nu->flagu & CU_NURB_CYCLIC) {
               calc_bevfac_mapping_default(bl, &start, &firstblend, &steps, &lastblend);
@@ -1648,7 +1726,6 @@ static void do_makeDispListCurveTypes(Depsgraph *depsgraph,
             }
 
             for (dlb = dlbev.first; dlb; dlb = dlb->next) {
-              BevPoint *bevp_first, *bevp_last;
               BevPoint *bevp;
 
               /* for each part of the bevel use a separate displblock */
@@ -1678,63 +1755,34 @@ static void do_makeDispListCurveTypes(Depsgraph *depsgraph,
               dl->bevel_split = BLI_BITMAP_NEW(steps, "bevel_split");
 
               /* for each point of poly make a bevel piece */
-              bevp_first = bl->bevpoints;
-              bevp_last = &bl->bevpoints[bl->nr - 1];
-              bevp = &bl->bevpoints[start];
-              for (i = start, a = 0; a < steps; i++, bevp++, a++) {
-                float fac = 1.0;
-                float *cur_data = data;
-
-                if (cu->taperobj == NULL) {
-                  fac = bevp->radius;
-                }
-                else {
-                  float len, taper_fac;
-
-                  if (cu->flag & CU_MAP_TAPER) {
-                    len = (steps - 3) + firstblend + lastblend;
-
-                    if (a == 0) {
-                      taper_fac = 0.0f;
-                    }
-                    else if (a == steps - 1) {
-                      taper_fac = 1.0f;
-                    }
-                    else {
-                      taper_fac = ((float)a - (1.0f - firstblend)) / len;
-                    }
-                  }
-                  else {
-                    len = bl->nr - 1;
-                    taper_fac = (float)i / len;
-
-                    if (a == 0) {
-                      taper_fac += (1.0f - firstblend) / len;
-                    }
-                    else if (a == steps - 1) {
-                      taper_fac -= (1.0f - lastblend) / len;
-                    }
-                  }
-
-                  fac = displist_calc_taper(depsgraph, scene, cu->taperobj, taper_fac);
-                }
+              BevelPiecesData pieces_data = {
+                  .depsgraph = depsgraph,
+                  .scene = scene,
+                  .cu = cu,
+                  .bl = bl,
+                  .dlb = dlb,
+                  .data = data,
+                  .widfac = widfac,
+                  .firstblend = firstblend,
+                  .lastblend = lastblend,
+                  .start = start,
+                  .steps = steps,
+              };
+              ParallelRangeSettings settings;
+              BLI_parallel_range_settings_defaults(&settings);
+              /* The taper object may lazily build its own display list. */
+              settings.use_threading = (cu->taperobj == NULL) &&
+                                       (steps * dlb->nr > BEVEL_PIECES_PARALLEL_THRESHOLD);
+              BLI_task_parallel_range(0, steps, &pieces_data, bevel_piece_cb, &settings);
 
+              bevp = &bl->bevpoints[start];
+              for (a = 0; a < steps; bevp++, a++) {
                 if (bevp->split_tag) {
                   BLI_BITMAP_ENABLE(dl->bevel_split, a);
                 }
 
-                /* rotate bevel piece and write in data */
-                if ((a == 0) && (bevp != bevp_last)) {
-                  rotateBevelPiece(cu, bevp, bevp + 1, dlb, 1.0f - firstblend, widfac, fac, &data);
-                }
-                else if ((a == steps - 1) && (bevp != bevp_first)) {
-                  rotateBevelPiece(cu, bevp, bevp - 1, dlb, 1.0f - lastblend, widfac, fac, &data);
-                }
-                else {
-                  rotateBevelPiece(cu, bevp, NULL, dlb, 0.0f, widfac, fac, &data);
-                }
-
                 if (cu->bevobj && (cu->flag & CU_FILL_CAPS) && !(nu->flagu & CU_NURB_CYCLIC)) {
+                  float *cur_data = data + (size_t)3 * dlb->nr * a;
                   if (a == 1) {
                     fillBevelCap(nu, dlb, cur_data - 3 * dlb->nr, &bottom_capbase);
                     negate_v3_v3(bottom_no, bevp->dir);
@@ -3309,9 +3309,29 @@ static void dynamic_paint_output_surface_image_wetmap_cb(
   ibuf->rect_float[pos + 3] = 1.0f;
 }
 
+typedef struct DynamicPaintSaveImageTask {
+  ImBuf *ibuf;
+  char filepath[FILE_MAX];
+} DynamicPaintSaveImageTask;
+
+static void dynamic_paint_save_image_task(TaskPool *__restrict UNUSED(pool),
+                                          void *taskdata,
+                                          int UNUSED(threadid))
+{
+  DynamicPaintSaveImageTask *task = taskdata;
+
+  IMB_saveiff(task->ibuf, task->filepath, IB_rectfloat);
+  IMB_freeImBuf(task->ibuf);
+}
+
+/**
+ * \param save_pool: When not NULL, encoding and writing the image is pushed to this pool
+ * so the caller can continue with the next frame, it takes ownership of the image buffer.
+ */
 void dynamicPaint_outputSurfaceImage(DynamicPaintSurface *surface,
                                      char *filename,
-                                     short output_layer)
+                                     short output_layer,
+                                     TaskPool *save_pool)
 {
   ImBuf *ibuf = NULL;
   PaintSurfaceData *sData = surface->data;
@@ -3437,8 +3457,16 @@ void dynamicPaint_outputSurfaceImage(DynamicPaintSurface *surface,
   }
 
   /* Save image */
-  IMB_saveiff(ibuf, output_file, IB_rectfloat);
-  IMB_freeImBuf(ibuf);
+  if (save_pool) {
+    DynamicPaintSaveImageTask *task = MEM_mallocN(sizeof(*task), __func__);
+    task->ibuf = ibuf;
+    BLI_strncpy(task->filepath, output_file, sizeof(task->filepath));
+    BLI_task_pool_push(save_pool, dynamic_paint_save_image_task, task, true, TASK_PRIORITY_LOW);
+  }
+  else {
+    IMB_saveiff(ibuf, output_file, IB_rectfloat);
+    IMB_freeImBuf(ibuf);
+  }
 }
 
 /** \} */
@@ -5219,6 +5247,11 @@ static void dynamic_paint_effect_spread_cb(void *__restrict userdata,
 
   const DynamicPaintSurface *surface = data->surface;
   const PaintSurfaceData *sData = surface->data;
+  PaintPoint *pPoint = &((PaintPoint *)sData->type_data)[index];
+  const PaintPoint *prevPoint = data->prevPoint;
+
+  /* The surface isn't a copy of prevPoint, every point has to be written. */
+  *pPoint = prevPoint[index];
 
   if (sData->adj_data->flags[index] & ADJ_BORDER_PIXEL) {
     return;
@@ -5226,8 +5259,6 @@ static void dynamic_paint_effect_spread_cb(void *__restrict userdata,
 
   const int numOfNeighs = sData->adj_data->n_num[index];
   BakeAdjPoint *bNeighs = sData->bData->bNeighs;
-  PaintPoint *pPoint = &((PaintPoint *)sData->type_data)[index];
-  const PaintPoint *prevPoint = data->prevPoint;
   const float eff_scale = data->eff_scale;
 
   const int *n_index = sData->adj_data->n_index;
@@ -5278,6 +5309,11 @@ static void dynamic_paint_effect_shrink_cb(void *__restrict userdata,
 
   const DynamicPaintSurface *surface = data->surface;
   const PaintSurfaceData *sData = surface->data;
+  PaintPoint *pPoint = &((PaintPoint *)sData->type_data)[index];
+  const PaintPoint *prevPoint = data->prevPoint;
+
+  /* The surface isn't a copy of prevPoint, every point has to be written. */
+  *pPoint = prevPoint[index];
 
   if (sData->adj_data->flags[index] & ADJ_BORDER_PIXEL) {
     return;
@@ -5285,8 +5321,6 @@ static void dynamic_paint_effect_shrink_cb(void *__restrict userdata,
 
   const int numOfNeighs = sData->adj_data->n_num[index];
   BakeAdjPoint *bNeighs = sData->bData->bNeighs;
-  PaintPoint *pPoint = &((PaintPoint *)sData->type_data)[index];
-  const PaintPoint *prevPoint = data->prevPoint;
   const float eff_scale = data->eff_scale;
   float totalAlpha = 0.0f;
 
@@ -5457,9 +5491,15 @@ static void dynamic_paint_effect_drip_cb(void *__restrict userdata,
   }
 }
 
+/**
+ * \param r_prevPoint: Buffer for the points of the previous step, spread and shrink
+ * swap it with the surface data instead of copying the points.
+ * \param point_locks: Cleared bitmap of one bit per point, used by the drip effect.
+ */
 static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
                                       float *force,
-                                      PaintPoint *prevPoint,
+                                      PaintPoint **r_prevPoint,
+                                      uint8_t *point_locks,
                                       float timescale,
                                       float steps)
 {
@@ -5479,12 +5519,14 @@ static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
     const float eff_scale = distance_scale * EFF_MOVEMENT_PER_FRAME * surface->spread_speed *
                             timescale;
 
-    /* Copy current surface to the previous points array to read unmodified values */
-    memcpy(prevPoint, sData->type_data, sData->total_points * sizeof(struct PaintPoint));
+    /* Read unmodified values from the current points, the new ones overwrite the old buffer */
+    PaintPoint *curPoint = sData->type_data;
+    sData->type_data = *r_prevPoint;
+    *r_prevPoint = curPoint;
 
     DynamicPaintEffectData data = {
         .surface = surface,
-        .prevPoint = prevPoint,
+        .prevPoint = *r_prevPoint,
         .eff_scale = eff_scale,
     };
     ParallelRangeSettings settings;
@@ -5501,12 +5543,14 @@ static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
     const float eff_scale = distance_scale * EFF_MOVEMENT_PER_FRAME * surface->shrink_speed *
                             timescale;
 
-    /* Copy current surface to the previous points array to read unmodified values */
-    memcpy(prevPoint, sData->type_data, sData->total_points * sizeof(struct PaintPoint));
+    /* Read unmodified values from the current points, the new ones overwrite the old buffer */
+    PaintPoint *curPoint = sData->type_data;
+    sData->type_data = *r_prevPoint;
+    *r_prevPoint = curPoint;
 
     DynamicPaintEffectData data = {
         .surface = surface,
-        .prevPoint = prevPoint,
+        .prevPoint = *r_prevPoint,
         .eff_scale = eff_scale,
     };
     ParallelRangeSettings settings;
@@ -5522,16 +5566,13 @@ static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
   if (surface->effect & MOD_DPAINT_EFFECT_DO_DRIP && force) {
     const float eff_scale = distance_scale * EFF_MOVEMENT_PER_FRAME * timescale / 2.0f;
 
-    /* Same as BLI_bitmask, but handled atomicaly as 'ePoint' locks. */
-    const size_t point_locks_size = (sData->total_points / 8) + 1;
-    uint8_t *point_locks = MEM_callocN(sizeof(*point_locks) * point_locks_size, __func__);
-
-    /* Copy current surface to the previous points array to read unmodified values */
-    memcpy(prevPoint, sData->type_data, sData->total_points * sizeof(struct PaintPoint));
+    /* Copy current surface to the previous points array to read unmodified values,
+     * dripping moves paint to other points so the surface has to start as a copy. */
+    memcpy(*r_prevPoint, sData->type_data, sData->total_points * sizeof(struct PaintPoint));
 
     DynamicPaintEffectData data = {
         .surface = surface,
-        .prevPoint = prevPoint,
+        .prevPoint = *r_prevPoint,
         .eff_scale = eff_scale,
         .force = force,
         .point_locks = point_locks,
@@ -5541,8 +5582,6 @@ static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
     settings.use_threading = (sData->total_points > 1000);
     BLI_task_parallel_range(
         0, sData->total_points, &data, dynamic_paint_effect_drip_cb, &settings);
-
-    MEM_freeN(point_locks);
   }
 }
 
@@ -5650,6 +5689,9 @@ static void dynamic_paint_wave_step_cb(void *__restrict userdata,
   float force = 0.0f, avg_dist = 0.0f, avg_height = 0.0f, avg_n_height = 0.0f;
   int numOfN = 0, numOfRN = 0;
 
+  /* The surface isn't a copy of prevPoint, every point has to be written. */
+  *wPoint = prevPoint[index];
+
   if (wPoint->state > 0) {
     return;
   }
@@ -5728,15 +5770,13 @@ static void dynamic_paint_wave_step_cb(void *__restrict userdata,
 static void dynamicPaint_doWaveStep(DynamicPaintSurface *surface, float timescale)
 {
   PaintSurfaceData *sData = surface->data;
-  BakeAdjPoint *bNeighs = sData->bData->bNeighs;
-  int index;
   int steps, ss;
   float dt, min_dist, damp_factor;
   const float wave_speed = surface->wave_speed;
   const float wave_max_slope = (surface->wave_smoothness >= 0.01f) ?
                                    (0.5f / surface->wave_smoothness) :
                                    0.0f;
-  double average_dist = 0.0f;
+  double average_dist;
   const float canvas_size = getSurfaceDimension(sData);
   const float wave_scale = CANVAS_REL_SIZE / canvas_size;
 
@@ -5746,16 +5786,8 @@ static void dynamicPaint_doWaveStep(DynamicPaintSurface *surface, float timescal
     return;
   }
 
-  /* calculate average neigh distance (single thread) */
-  for (index = 0; index < sData->total_points; index++) {
-    int i;
-    int numOfNeighs = sData->adj_data->n_num[index];
-
-    for (i = 0; i < numOfNeighs; i++) {
-      average_dist += (double)bNeighs[sData->adj_data->n_index[index] + i].dist;
-    }
-  }
-  average_dist *= (double)wave_scale / sData->adj_data->total_targets;
+  /* average neigh distance, already calculated in #dynamicPaint_prepareAdjacencyData */
+  average_dist = sData->bData->average_dist * (double)wave_scale;
 
   /* determine number of required steps */
   steps = (int)ceil((double)(WAVE_TIME_FAC * timescale * surface->wave_timescale) /
@@ -5769,8 +5801,10 @@ static void dynamicPaint_doWaveStep(DynamicPaintSurface *surface, float timescal
   damp_factor = pow((1.0f - surface->wave_damping), timescale * surface->wave_timescale);
 
   for (ss = 0; ss < steps; ss++) {
-    /* copy previous frame data */
-    memcpy(prevPoint, sData->type_data, sData->total_points * sizeof(PaintWavePoint));
+    /* Swap instead of copying previous step data, the new points overwrite the old buffer. */
+    PaintWavePoint *curPoint = sData->type_data;
+    sData->type_data = prevPoint;
+    prevPoint = curPoint;
 
     DynamicPaintEffectData data = {
         .surface = surface,
@@ -6335,6 +6369,7 @@ static int dynamicPaint_doStep(Depsgraph *depsgraph,
     if (surface->effect && surface->type == MOD_DPAINT_SURFACE_T_PAINT) {
       int steps = 1, s;
       PaintPoint *prevPoint;
+      uint8_t *point_locks = NULL;
       float *force = NULL;
 
       /* Allocate memory for surface previous points to read unchanged values from */
@@ -6346,14 +6381,25 @@ static int dynamicPaint_doStep(Depsgraph *depsgraph,
 
       /* Prepare effects and get number of required steps */
       steps = dynamicPaint_prepareEffectStep(depsgraph, surface, scene, ob, &force, timescale);
+
+      if (surface->effect & MOD_DPAINT_EFFECT_DO_DRIP && force) {
+        /* Same as BLI_bitmask, but handled atomicaly as 'ePoint' locks,
+         * every lock is released again by the end of each step. */
+        const size_t point_locks_size = (sData->total_points / 8) + 1;
+        point_locks = MEM_callocN(sizeof(*point_locks) * point_locks_size, __func__);
+      }
+
       for (s = 0; s < steps; s++) {
-        dynamicPaint_doEffectStep(surface, force, prevPoint, timescale, (float)steps);
+        dynamicPaint_doEffectStep(surface, force, &prevPoint, point_locks, timescale, (float)steps);
       }
 
       /* Free temporary effect data */
       if (prevPoint) {
         MEM_freeN(prevPoint);
       }
+      if (point_locks) {
+        MEM_freeN(point_locks);
+      }
       if (force) {
         MEM_freeN(force);
       }
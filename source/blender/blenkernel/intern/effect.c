@@ -156,16 +156,21 @@ void BKE_partdeflect_free(PartDeflect *pd)
 
 /******************** EFFECTOR RELATIONS ***********************/
 
-static void precalculate_effector(struct Depsgraph *depsgraph, EffectorCache *eff)
+static void effector_rng_seed(struct Depsgraph *depsgraph, PartDeflect *pd)
 {
   float ctime = DEG_get_ctime(depsgraph);
   uint cfra = (uint)(ctime >= 0 ? ctime : -ctime);
-  if (!eff->pd->rng) {
-    eff->pd->rng = BLI_rng_new(eff->pd->seed + cfra);
+  if (!pd->rng) {
+    pd->rng = BLI_rng_new(pd->seed + cfra);
   }
   else {
-    BLI_rng_srandom(eff->pd->rng, eff->pd->seed + cfra);
+    BLI_rng_srandom(pd->rng, pd->seed + cfra);
   }
+}
+
+static void precalculate_effector(struct Depsgraph *depsgraph, EffectorCache *eff)
+{
+  effector_rng_seed(depsgraph, eff->pd);
 
   if (eff->pd->forcefield == PFIELD_GUIDE && eff->ob->type == OB_CURVE) {
     Curve *cu = eff->ob->data;
@@ -190,7 +195,7 @@ static void precalculate_effector(struct Depsgraph *depsgraph, EffectorCache *ef
     }
   }
   else if (eff->psys) {
-    psys_update_particle_tree(eff->psys, ctime);
+    psys_update_particle_tree(eff->psys, DEG_get_ctime(depsgraph));
   }
 }
 
@@ -333,6 +338,32 @@ ListBase *BKE_effectors_create(Depsgraph *depsgraph,
   return effectors;
 }
 
+/**
+ * Effectors with noise draw from the random generator of the effector, so applying them isn't
+ * thread safe and the result depends on the order in which points are evaluated.
+ */
+bool BKE_effectors_use_noise(ListBase *effectors)
+{
+  if (effectors) {
+    for (EffectorCache *eff = effectors->first; eff; eff = eff->next) {
+      if (eff->pd->f_noise > 0.0f) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/* Restart the noise of all effectors, as if they were just created. */
+void BKE_effectors_reset_rng(struct Depsgraph *depsgraph, ListBase *effectors)
+{
+  if (effectors) {
+    for (EffectorCache *eff = effectors->first; eff; eff = eff->next) {
+      effector_rng_seed(depsgraph, eff->pd);
+    }
+  }
+}
+
 void BKE_effectors_free(ListBase *lb)
 {
   if (lb) {
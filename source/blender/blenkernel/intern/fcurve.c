@@ -2495,6 +2495,38 @@ static void berekeny(float f1, float f2, float f3, float f4, float *o, int b)
 
 /* -------------------------- */
 
+/**
+ * Find the keyframe segment containing \a evaltime (as #binarysearch_bezt_index_ex does).
+ *
+ * Playback mostly evaluates a curve at increasing times, so the segment found last time
+ * (or the one after it) is checked first. The guess is only used when no keyframe lies within
+ * the search threshold of \a evaltime, in which case the binary search gives the same result.
+ */
+static int fcurve_eval_keyframes_find_index(FCurve *fcu,
+                                            BezTriple *bezts,
+                                            float evaltime,
+                                            bool *r_exact)
+{
+  const float threshold = 0.0001f;
+  const int totvert = (int)fcu->totvert;
+  const int hint = fcu->last_eval_index;
+
+  for (int a = hint; a < hint + 2; a++) {
+    if ((a > 0) && (a < totvert) && (evaltime - bezts[a - 1].vec[1][0] > threshold) &&
+        (bezts[a].vec[1][0] - evaltime > threshold)) {
+      *r_exact = false;
+      if (a != hint) {
+        fcu->last_eval_index = a;
+      }
+      return a;
+    }
+  }
+
+  const int a = binarysearch_bezt_index_ex(bezts, evaltime, totvert, threshold, r_exact);
+  fcu->last_eval_index = a;
+  return a;
+}
+
 /* Calculate F-Curve value for 'evaltime' using BezTriple keyframes */
 static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
 {
@@ -2628,7 +2660,7 @@ static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime
      *   Weird errors, like selecting the wrong keyframe range (see T39207), occur.
      *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
      */
-    a = binarysearch_bezt_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+    a = (unsigned int)fcurve_eval_keyframes_find_index(fcu, bezts, evaltime, &exact);
 
     if (exact) {
       /* index returned must be interpreted differently when it sits on top of an existing keyframe
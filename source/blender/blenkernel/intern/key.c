@@ -30,6 +30,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_math_vector.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -773,6 +774,159 @@ static void cp_cu_key(Curve *cu,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Relative Coordinate Blending
+ *
+ * Fast path for #key_evaluate_relative on keys made of plain coordinates (meshes & lattices).
+ * Active key-blocks are gathered once, then blended in parallel over ranges of elements,
+ * each range applying all keys in order so results match the generic code exactly.
+ * \{ */
+
+/* Number of coordinates each task blends, small enough to stay in cache across keys. */
+#define KEY_BLEND_CHUNK_SIZE 1024
+/* Minimum (coordinates * keys) before blending is threaded. */
+#define KEY_BLEND_PARALLEL_THRESHOLD 10000
+
+typedef struct KeyBlendInput {
+  const float (*from)[3];
+  const float (*reffrom)[3];
+  const float *weights;
+  float icuval;
+} KeyBlendInput;
+
+typedef struct KeyBlendData {
+  float (*poin)[3];
+  const KeyBlendInput *inputs;
+  int inputs_len;
+  int start, end;
+} KeyBlendData;
+
+static void key_blend_coords_cb(void *__restrict userdata,
+                                const int chunk,
+                                const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const KeyBlendData *data = userdata;
+  const int b_start = data->start + chunk * KEY_BLEND_CHUNK_SIZE;
+  const int b_end = min_ii(b_start + KEY_BLEND_CHUNK_SIZE, data->end);
+
+  for (int i = 0; i < data->inputs_len; i++) {
+    const KeyBlendInput *input = &data->inputs[i];
+    const float(*from)[3] = input->from;
+    const float(*reffrom)[3] = input->reffrom;
+    float(*poin)[3] = data->poin;
+    const float icuval = input->icuval;
+
+    if (input->weights) {
+      const float *weights = input->weights;
+      for (int b = b_start; b < b_end; b++) {
+        const float weight = weights[b] * icuval;
+        if (weight != 0.0f) {
+          poin[b][0] -= weight * (reffrom[b][0] - from[b][0]);
+          poin[b][1] -= weight * (reffrom[b][1] - from[b][1]);
+          poin[b][2] -= weight * (reffrom[b][2] - from[b][2]);
+        }
+      }
+    }
+    else {
+      /* Flat loop over the floats of the range, simple for the compiler to vectorize. */
+      const float *fp_from = from[b_start];
+      const float *fp_reffrom = reffrom[b_start];
+      float *fp_poin = poin[b_start];
+      const int fp_len = (b_end - b_start) * 3;
+      for (int a = 0; a < fp_len; a++) {
+        fp_poin[a] -= icuval * (fp_reffrom[a] - fp_from[a]);
+      }
+    }
+  }
+}
+
+/**
+ * Blend relative keys into \a basispoin for elements [start, end),
+ * only valid when each element is a single #IPO_FLOAT coordinate.
+ */
+static void key_evaluate_relative_coords(const int start,
+                                         const int end,
+                                         const int tot,
+                                         char *basispoin,
+                                         Key *key,
+                                         KeyBlock *actkb,
+                                         float **per_keyblock_weights)
+{
+  KeyBlock *kb;
+  KeyBlendInput *inputs;
+  char **freedata;
+  int inputs_len = 0, freedata_len = 0, keyblock_index;
+  const int blocks_len = BLI_listbase_count(&key->block);
+
+  if (end <= start || blocks_len == 0) {
+    return;
+  }
+
+  inputs = MEM_malloc_arrayN((size_t)blocks_len, sizeof(*inputs), __func__);
+  freedata = MEM_malloc_arrayN((size_t)blocks_len * 2, sizeof(*freedata), __func__);
+
+  /* Gather on this thread: fetching edit-mesh data may allocate. */
+  for (kb = key->block.first, keyblock_index = 0; kb; kb = kb->next, keyblock_index++) {
+    KeyBlock *refb;
+    KeyBlendInput *input;
+    char *from, *reffrom, *freefrom = NULL, *freereffrom = NULL;
+
+    /* Cheap rejection of key-blocks without influence, before touching their data. */
+    if (kb == key->refkey || (kb->flag & KEYBLOCK_MUTE) || kb->curval == 0.0f ||
+        kb->totelem != tot) {
+      continue;
+    }
+    /* reference now can be any block */
+    refb = BLI_findlink(&key->block, kb->relative);
+    if (refb == NULL) {
+      continue;
+    }
+
+    from = key_block_get_data(key, actkb, kb, &freefrom);
+    reffrom = key_block_get_data(key, actkb, refb, &freereffrom);
+    if (freefrom) {
+      freedata[freedata_len++] = freefrom;
+    }
+    if (freereffrom) {
+      freedata[freedata_len++] = freereffrom;
+    }
+    /* A key relative to itself has no effect. */
+    if (from == reffrom) {
+      continue;
+    }
+
+    input = &inputs[inputs_len++];
+    input->from = (const float(*)[3])from;
+    input->reffrom = (const float(*)[3])reffrom;
+    input->weights = per_keyblock_weights ? per_keyblock_weights[keyblock_index] : NULL;
+    input->icuval = kb->curval;
+  }
+
+  if (inputs_len != 0) {
+    KeyBlendData data = {
+        .poin = (float(*)[3])basispoin,
+        .inputs = inputs,
+        .inputs_len = inputs_len,
+        .start = start,
+        .end = end,
+    };
+    const int chunks_len = (end - start + KEY_BLEND_CHUNK_SIZE - 1) / KEY_BLEND_CHUNK_SIZE;
+
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = ((end - start) * inputs_len) > KEY_BLEND_PARALLEL_THRESHOLD;
+    BLI_task_parallel_range(0, chunks_len, &data, key_blend_coords_cb, &settings);
+  }
+
+  for (int i = 0; i < freedata_len; i++) {
+    MEM_freeN(freedata[i]);
+  }
+  MEM_freeN(freedata);
+  MEM_freeN(inputs);
+}
+
+/** \} */
+
 static void key_evaluate_relative(const int start,
                                   int end,
                                   const int tot,
@@ -811,6 +965,13 @@ static void key_evaluate_relative(const int start,
 
   /* step 2: do it */
 
+  if (mode != KEY_MODE_BEZTRIPLE && step == 1 && key->elemstr[1] == IPO_FLOAT &&
+      key->elemstr[2] == 0 && poinsize == (int)sizeof(float[KEYELEM_FLOAT_LEN_COORD]) &&
+      key->elemsize == (int)sizeof(float[KEYELEM_FLOAT_LEN_COORD])) {
+    key_evaluate_relative_coords(start, end, tot, basispoin, key, actkb, per_keyblock_weights);
+    return;
+  }
+
   for (kb = key->block.first, keyblock_index = 0; kb; kb = kb->next, keyblock_index++) {
     if (kb != key->refkey) {
       float icuval = kb->curval;
@@ -37,6 +37,7 @@
 #include "BLI_memarena.h"
 #include "BLI_polyfill_2d.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 
 #include "BKE_bvhutils.h"
 #include "BKE_customdata.h"
@@ -493,6 +494,108 @@ typedef struct IslandResult {
 /* Will be enough in 99% of cases. */
 #define MREMAP_DEFAULT_BUFSIZE 32
 
+/* Minimum number of dest elements before BVH queries are done in parallel. */
+#define MREMAP_PARALLEL_THRESHOLD 1024
+
+/** Result of a BVH query for a single dest element, index is -1 when there is no hit. */
+typedef struct MeshRemapHit {
+  int index;
+  float hit_dist;
+  float co[3];
+} MeshRemapHit;
+
+typedef struct MeshRemapQueryData {
+  BVHTreeFromMesh *treedata;
+  const float (*cos)[3];
+  const float (*nos)[3];
+  float max_dist;
+  float max_dist_sq;
+  float ray_radius;
+  MeshRemapHit *hits;
+} MeshRemapQueryData;
+
+static void mesh_remap_query_nearest_cb(void *__restrict userdata,
+                                        const int i,
+                                        const ParallelRangeTLS *__restrict tls)
+{
+  const MeshRemapQueryData *data = userdata;
+  /* Per-thread, so the local proximity heuristic works within each chunk. */
+  BVHTreeNearest *nearest = tls->userdata_chunk;
+  MeshRemapHit *hit = &data->hits[i];
+
+  if (mesh_remap_bvhtree_query_nearest(
+          data->treedata, nearest, data->cos[i], data->max_dist_sq, &hit->hit_dist)) {
+    hit->index = nearest->index;
+    copy_v3_v3(hit->co, nearest->co);
+  }
+  else {
+    hit->index = -1;
+  }
+}
+
+static void mesh_remap_query_raycast_cb(void *__restrict userdata,
+                                        const int i,
+                                        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const MeshRemapQueryData *data = userdata;
+  MeshRemapHit *hit = &data->hits[i];
+  BVHTreeRayHit rayhit = {0};
+
+  if (mesh_remap_bvhtree_query_raycast(data->treedata,
+                                       &rayhit,
+                                       data->cos[i],
+                                       data->nos[i],
+                                       data->ray_radius,
+                                       data->max_dist,
+                                       &hit->hit_dist)) {
+    hit->index = rayhit.index;
+    copy_v3_v3(hit->co, rayhit.co);
+  }
+  else {
+    hit->index = -1;
+  }
+}
+
+/**
+ * Query \a treedata for all given points (in tree space), either for the nearest element,
+ * or by raycasting along \a nos when not NULL. Returned array must be freed by the caller.
+ */
+static MeshRemapHit *mesh_remap_bvhtree_query_batch(BVHTreeFromMesh *treedata,
+                                                    const float (*cos)[3],
+                                                    const float (*nos)[3],
+                                                    const int num,
+                                                    const float max_dist,
+                                                    const float ray_radius)
+{
+  MeshRemapHit *hits = MEM_malloc_arrayN((size_t)num, sizeof(*hits), __func__);
+  MeshRemapQueryData data = {
+      .treedata = treedata,
+      .cos = cos,
+      .nos = nos,
+      .max_dist = max_dist,
+      .max_dist_sq = max_dist * max_dist,
+      .ray_radius = ray_radius,
+      .hits = hits,
+  };
+
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (num > MREMAP_PARALLEL_THRESHOLD);
+
+  if (nos == NULL) {
+    BVHTreeNearest nearest = {0};
+    nearest.index = -1;
+    settings.userdata_chunk = &nearest;
+    settings.userdata_chunk_size = sizeof(nearest);
+    BLI_task_parallel_range(0, num, &data, mesh_remap_query_nearest_cb, &settings);
+  }
+  else {
+    BLI_task_parallel_range(0, num, &data, mesh_remap_query_raycast_cb, &settings);
+  }
+
+  return hits;
+}
+
 void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                          const SpaceTransform *space_transform,
                                          const float max_dist,
@@ -504,7 +607,6 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                          MeshPairRemap *r_map)
 {
   const float full_weight = 1.0f;
-  const float max_dist_sq = max_dist * max_dist;
   int i;
 
   BLI_assert(mode & MREMAP_MODE_VERT);
@@ -519,51 +621,49 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
   }
   else {
     BVHTreeFromMesh treedata = {NULL};
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
-    float hit_dist;
-    float tmp_co[3], tmp_no[3];
+    MeshRemapHit *hits;
+    float(*cos_dst)[3] = MEM_malloc_arrayN((size_t)numverts_dst, sizeof(*cos_dst), __func__);
+    float(*nos_dst)[3] = NULL;
+
+    for (i = 0; i < numverts_dst; i++) {
+      copy_v3_v3(cos_dst[i], verts_dst[i].co);
+
+      /* Convert the vertex to tree coordinates, if needed. */
+      if (space_transform) {
+        BLI_space_transform_apply(space_transform, cos_dst[i]);
+      }
+    }
 
     if (mode == MREMAP_MODE_VERT_NEAREST) {
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
-      nearest.index = -1;
+      hits = mesh_remap_bvhtree_query_batch(
+          &treedata, (const float(*)[3])cos_dst, NULL, numverts_dst, max_dist, ray_radius);
 
       for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, verts_dst[i].co);
-
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
-
-        if (mesh_remap_bvhtree_query_nearest(
-                &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest.index, &full_weight);
+        if (hits[i].index != -1) {
+          mesh_remap_item_define(r_map, i, hits[i].hit_dist, 0, 1, &hits[i].index, &full_weight);
         }
         else {
           /* No source for this dest vertex! */
           BKE_mesh_remap_item_define_invalid(r_map, i);
         }
       }
+
+      MEM_freeN(hits);
     }
     else if (ELEM(mode, MREMAP_MODE_VERT_EDGE_NEAREST, MREMAP_MODE_VERT_EDGEINTERP_NEAREST)) {
       MEdge *edges_src = me_src->medge;
       float(*vcos_src)[3] = BKE_mesh_vertexCos_get(me_src, NULL);
 
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
-      nearest.index = -1;
+      hits = mesh_remap_bvhtree_query_batch(
+          &treedata, (const float(*)[3])cos_dst, NULL, numverts_dst, max_dist, ray_radius);
 
       for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, verts_dst[i].co);
-
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+        const float *tmp_co = cos_dst[i];
 
-        if (mesh_remap_bvhtree_query_nearest(
-                &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-          MEdge *me = &edges_src[nearest.index];
+        if (hits[i].index != -1) {
+          MEdge *me = &edges_src[hits[i].index];
           const float *v1cos = vcos_src[me->v1];
           const float *v2cos = vcos_src[me->v2];
 
@@ -571,7 +671,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
             const float dist_v1 = len_squared_v3v3(tmp_co, v1cos);
             const float dist_v2 = len_squared_v3v3(tmp_co, v2cos);
             const int index = (int)((dist_v1 > dist_v2) ? me->v2 : me->v1);
-            mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &index, &full_weight);
+            mesh_remap_item_define(r_map, i, hits[i].hit_dist, 0, 1, &index, &full_weight);
           }
           else if (mode == MREMAP_MODE_VERT_EDGEINTERP_NEAREST) {
             int indices[2];
@@ -585,7 +685,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
             CLAMP(weights[0], 0.0f, 1.0f);
             weights[1] = 1.0f - weights[0];
 
-            mesh_remap_item_define(r_map, i, hit_dist, 0, 2, indices, weights);
+            mesh_remap_item_define(r_map, i, hits[i].hit_dist, 0, 2, indices, weights);
           }
         }
         else {
@@ -594,6 +694,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
         }
       }
 
+      MEM_freeN(hits);
       MEM_freeN(vcos_src);
     }
     else if (ELEM(mode,
@@ -612,24 +713,31 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_LOOPTRI, 2);
 
       if (mode == MREMAP_MODE_VERT_POLYINTERP_VNORPROJ) {
+        nos_dst = MEM_malloc_arrayN((size_t)numverts_dst, sizeof(*nos_dst), __func__);
         for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, verts_dst[i].co);
-          normal_short_to_float_v3(tmp_no, verts_dst[i].no);
+          normal_short_to_float_v3(nos_dst[i], verts_dst[i].no);
 
-          /* Convert the vertex to tree coordinates, if needed. */
+          /* Convert the normal to tree coordinates, if needed. */
           if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-            BLI_space_transform_apply_normal(space_transform, tmp_no);
+            BLI_space_transform_apply_normal(space_transform, nos_dst[i]);
           }
+        }
+
+        hits = mesh_remap_bvhtree_query_batch(&treedata,
+                                              (const float(*)[3])cos_dst,
+                                              (const float(*)[3])nos_dst,
+                                              numverts_dst,
+                                              max_dist,
+                                              ray_radius);
 
-          if (mesh_remap_bvhtree_query_raycast(
-                  &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist)) {
-            const MLoopTri *lt = &treedata.looptri[rayhit.index];
+        for (i = 0; i < numverts_dst; i++) {
+          if (hits[i].index != -1) {
+            const MLoopTri *lt = &treedata.looptri[hits[i].index];
             MPoly *mp_src = &polys_src[lt->poly];
             const int sources_num = mesh_remap_interp_poly_data_get(mp_src,
                                                                     loops_src,
                                                                     (const float(*)[3])vcos_src,
-                                                                    rayhit.co,
+                                                                    hits[i].co,
                                                                     &tmp_buff_size,
                                                                     &vcos,
                                                                     false,
@@ -638,28 +746,23 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                                                     true,
                                                                     NULL);
 
-            mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
+            mesh_remap_item_define(r_map, i, hits[i].hit_dist, 0, sources_num, indices, weights);
           }
           else {
             /* No source for this dest vertex! */
             BKE_mesh_remap_item_define_invalid(r_map, i);
           }
         }
+
+        MEM_freeN(hits);
       }
       else {
-        nearest.index = -1;
+        hits = mesh_remap_bvhtree_query_batch(
+            &treedata, (const float(*)[3])cos_dst, NULL, numverts_dst, max_dist, ray_radius);
 
         for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, verts_dst[i].co);
-
-          /* Convert the vertex to tree coordinates, if needed. */
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-          }
-
-          if (mesh_remap_bvhtree_query_nearest(
-                  &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-            const MLoopTri *lt = &treedata.looptri[nearest.index];
+          if (hits[i].index != -1) {
+            const MLoopTri *lt = &treedata.looptri[hits[i].index];
             MPoly *mp = &polys_src[lt->poly];
 
             if (mode == MREMAP_MODE_VERT_POLY_NEAREST) {
@@ -667,7 +770,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
               mesh_remap_interp_poly_data_get(mp,
                                               loops_src,
                                               (const float(*)[3])vcos_src,
-                                              nearest.co,
+                                              hits[i].co,
                                               &tmp_buff_size,
                                               &vcos,
                                               false,
@@ -676,13 +779,13 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                               false,
                                               &index);
 
-              mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &index, &full_weight);
+              mesh_remap_item_define(r_map, i, hits[i].hit_dist, 0, 1, &index, &full_weight);
             }
             else if (mode == MREMAP_MODE_VERT_POLYINTERP_NEAREST) {
               const int sources_num = mesh_remap_interp_poly_data_get(mp,
                                                                       loops_src,
                                                                       (const float(*)[3])vcos_src,
-                                                                      nearest.co,
+                                                                      hits[i].co,
                                                                       &tmp_buff_size,
                                                                       &vcos,
                                                                       false,
@@ -691,7 +794,8 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                                                       true,
                                                                       NULL);
 
-              mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
+              mesh_remap_item_define(
+                  r_map, i, hits[i].hit_dist, 0, sources_num, indices, weights);
             }
           }
           else {
@@ -699,6 +803,8 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
             BKE_mesh_remap_item_define_invalid(r_map, i);
           }
         }
+
+        MEM_freeN(hits);
       }
 
       MEM_freeN(vcos_src);
@@ -711,6 +817,11 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
       memset(r_map->items, 0, sizeof(*r_map->items) * (size_t)numverts_dst);
     }
 
+    MEM_freeN(cos_dst);
+    if (nos_dst) {
+      MEM_freeN(nos_dst);
+    }
+
     free_bvhtree_from_mesh(&treedata);
   }
 }
@@ -876,26 +987,36 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
       MEM_freeN(vert_to_edge_src_map_mem);
     }
     else if (mode == MREMAP_MODE_EDGE_NEAREST) {
+      float(*cos_dst)[3] = MEM_malloc_arrayN((size_t)numedges_dst, sizeof(*cos_dst), __func__);
+      MeshRemapHit *hits;
+
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
-      nearest.index = -1;
 
       for (i = 0; i < numedges_dst; i++) {
-        interp_v3_v3v3(tmp_co, verts_dst[edges_dst[i].v1].co, verts_dst[edges_dst[i].v2].co, 0.5f);
+        interp_v3_v3v3(
+            cos_dst[i], verts_dst[edges_dst[i].v1].co, verts_dst[edges_dst[i].v2].co, 0.5f);
 
         /* Convert the vertex to tree coordinates, if needed. */
         if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
+          BLI_space_transform_apply(space_transform, cos_dst[i]);
         }
+      }
 
-        if (mesh_remap_bvhtree_query_nearest(
-                &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest.index, &full_weight);
+      hits = mesh_remap_bvhtree_query_batch(
+          &treedata, (const float(*)[3])cos_dst, NULL, numedges_dst, max_dist, ray_radius);
+
+      for (i = 0; i < numedges_dst; i++) {
+        if (hits[i].index != -1) {
+          mesh_remap_item_define(r_map, i, hits[i].hit_dist, 0, 1, &hits[i].index, &full_weight);
         }
         else {
           /* No source for this dest edge! */
           BKE_mesh_remap_item_define_invalid(r_map, i);
         }
       }
+
+      MEM_freeN(hits);
+      MEM_freeN(cos_dst);
     }
     else if (mode == MREMAP_MODE_EDGE_POLY_NEAREST) {
       MEdge *edges_src = me_src->medge;
@@ -2205,7 +2326,6 @@ void BKE_mesh_remap_calc_polys_from_mesh(const int mode,
                                          MeshPairRemap *r_map)
 {
   const float full_weight = 1.0f;
-  const float max_dist_sq = max_dist * max_dist;
   float(*poly_nors_dst)[3] = NULL;
   float tmp_co[3], tmp_no[3];
   int i;
@@ -2242,64 +2362,62 @@ void BKE_mesh_remap_calc_polys_from_mesh(const int mode,
   }
   else {
     BVHTreeFromMesh treedata = {NULL};
-    BVHTreeNearest nearest = {0};
     BVHTreeRayHit rayhit = {0};
     float hit_dist;
 
     BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_LOOPTRI, 2);
 
-    if (mode == MREMAP_MODE_POLY_NEAREST) {
-      nearest.index = -1;
-
-      for (i = 0; i < numpolys_dst; i++) {
-        MPoly *mp = &polys_dst[i];
+    if (ELEM(mode, MREMAP_MODE_POLY_NEAREST, MREMAP_MODE_POLY_NOR)) {
+      float(*cos_dst)[3] = MEM_malloc_arrayN((size_t)numpolys_dst, sizeof(*cos_dst), __func__);
+      float(*nos_dst)[3] = NULL;
+      MeshRemapHit *hits;
 
-        BKE_mesh_calc_poly_center(mp, &loops_dst[mp->loopstart], verts_dst, tmp_co);
-
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
-
-        if (mesh_remap_bvhtree_query_nearest(
-                &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-          const MLoopTri *lt = &treedata.looptri[nearest.index];
-          const int poly_index = (int)lt->poly;
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &poly_index, &full_weight);
-        }
-        else {
-          /* No source for this dest poly! */
-          BKE_mesh_remap_item_define_invalid(r_map, i);
-        }
+      if (mode == MREMAP_MODE_POLY_NOR) {
+        BLI_assert(poly_nors_dst);
+        nos_dst = MEM_malloc_arrayN((size_t)numpolys_dst, sizeof(*nos_dst), __func__);
       }
-    }
-    else if (mode == MREMAP_MODE_POLY_NOR) {
-      BLI_assert(poly_nors_dst);
 
       for (i = 0; i < numpolys_dst; i++) {
         MPoly *mp = &polys_dst[i];
 
-        BKE_mesh_calc_poly_center(mp, &loops_dst[mp->loopstart], verts_dst, tmp_co);
-        copy_v3_v3(tmp_no, poly_nors_dst[i]);
+        BKE_mesh_calc_poly_center(mp, &loops_dst[mp->loopstart], verts_dst, cos_dst[i]);
+        if (nos_dst) {
+          copy_v3_v3(nos_dst[i], poly_nors_dst[i]);
+        }
 
         /* Convert the vertex to tree coordinates, if needed. */
         if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-          BLI_space_transform_apply_normal(space_transform, tmp_no);
+          BLI_space_transform_apply(space_transform, cos_dst[i]);
+          if (nos_dst) {
+            BLI_space_transform_apply_normal(space_transform, nos_dst[i]);
+          }
         }
+      }
 
-        if (mesh_remap_bvhtree_query_raycast(
-                &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist)) {
-          const MLoopTri *lt = &treedata.looptri[rayhit.index];
-          const int poly_index = (int)lt->poly;
+      hits = mesh_remap_bvhtree_query_batch(&treedata,
+                                            (const float(*)[3])cos_dst,
+                                            (const float(*)[3])nos_dst,
+                                            numpolys_dst,
+                                            max_dist,
+                                            ray_radius);
 
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &poly_index, &full_weight);
+      for (i = 0; i < numpolys_dst; i++) {
+        if (hits[i].index != -1) {
+          const MLoopTri *lt = &treedata.looptri[hits[i].index];
+          const int poly_index = (int)lt->poly;
+          mesh_remap_item_define(r_map, i, hits[i].hit_dist, 0, 1, &poly_index, &full_weight);
         }
         else {
           /* No source for this dest poly! */
           BKE_mesh_remap_item_define_invalid(r_map, i);
         }
       }
+
+      MEM_freeN(hits);
+      MEM_freeN(cos_dst);
+      if (nos_dst) {
+        MEM_freeN(nos_dst);
+      }
     }
     else if (mode == MREMAP_MODE_POLY_POLYINTERP_PNORPROJ) {
       /* We cast our rays randomly, with a pseudo-even distribution
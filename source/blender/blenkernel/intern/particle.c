@@ -2284,6 +2284,108 @@ void psys_find_parents(ParticleSimulationData *sim, const bool use_render_params
   BLI_kdtree_3d_free(tree);
 }
 
+/* Face index of the emitter used for simple children of the given parent. */
+static int psys_child_simple_num(const ParticleThreadContext *ctx, const ParticleData *pa)
+{
+  /*
+   * NOTE: Should in theory be the same as:
+   * cpa_num = psys_particle_dm_face_lookup(
+   *        ctx->sim.psmd->dm_final,
+   *        ctx->sim.psmd->dm_deformed,
+   *        pa->num, pa->fuv,
+   *        NULL);
+   */
+  int cpa_num = (ELEM(pa->num_dmcache, DMCACHE_ISCHILD, DMCACHE_NOTFOUND)) ? pa->num :
+                                                                             pa->num_dmcache;
+
+  /* XXX hack to avoid messed up particle num and subsequent crash (#40733) */
+  if (cpa_num > ctx->sim.psmd->mesh_final->totface) {
+    cpa_num = 0;
+  }
+  return cpa_num;
+}
+
+/* Emitter data of a parent, shared by all of its children.
+ * Read from the per parent arrays when those were filled in. */
+static void psys_parent_hairmat(const ParticleThreadContext *ctx, int p, float r_hairmat[4][4])
+{
+  ParticleSystem *psys = ctx->sim.psys;
+
+  if (ctx->parent_hairmat) {
+    copy_m4_m4(r_hairmat, ctx->parent_hairmat[p]);
+    return;
+  }
+  psys_mat_hair_to_global(
+      ctx->sim.ob, ctx->sim.psmd->mesh_final, psys->part->from, &psys->particles[p], r_hairmat);
+}
+
+static void psys_parent_orco(const ParticleThreadContext *ctx, int p, float r_orco[3])
+{
+  ParticleSystem *psys = ctx->sim.psys;
+  ParticleData *pa = &psys->particles[p];
+  float co[3];
+
+  if (ctx->parent_orco) {
+    copy_v3_v3(r_orco, ctx->parent_orco[p]);
+    return;
+  }
+  psys_particle_on_emitter(ctx->sim.psmd,
+                           psys->part->from,
+                           pa->num,
+                           pa->num_dmcache,
+                           pa->fuv,
+                           pa->foffset,
+                           co,
+                           NULL,
+                           NULL,
+                           NULL,
+                           r_orco);
+}
+
+static void psys_parent_simple_orco(const ParticleThreadContext *ctx, int p, float r_orco[3])
+{
+  ParticleSystem *psys = ctx->sim.psys;
+  ParticleData *pa = &psys->particles[p];
+  float co[3];
+
+  if (ctx->simple_orco) {
+    copy_v3_v3(r_orco, ctx->simple_orco[p]);
+    return;
+  }
+  psys_particle_on_emitter(ctx->sim.psmd,
+                           psys->part->from,
+                           psys_child_simple_num(ctx, pa),
+                           DMCACHE_ISCHILD,
+                           pa->fuv,
+                           pa->foffset,
+                           co,
+                           NULL,
+                           NULL,
+                           NULL,
+                           r_orco);
+}
+
+typedef struct ParentDataCacheData {
+  const ParticleThreadContext *ctx;
+  float (*hairmat)[4][4];
+  float (*orco)[3];
+  float (*simple_orco)[3];
+} ParentDataCacheData;
+
+static void psys_cache_parent_data_cb(void *__restrict userdata,
+                                      const int p,
+                                      const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  ParentDataCacheData *data = userdata;
+
+  /* The context arrays are only set once filled in, so these evaluate the parent. */
+  psys_parent_hairmat(data->ctx, p, data->hairmat[p]);
+  psys_parent_orco(data->ctx, p, data->orco[p]);
+  if (data->simple_orco) {
+    psys_parent_simple_orco(data->ctx, p, data->simple_orco[p]);
+  }
+}
+
 static bool psys_thread_context_init_path(ParticleThreadContext *ctx,
                                           ParticleSimulationData *sim,
                                           Scene *scene,
@@ -2349,6 +2451,33 @@ static bool psys_thread_context_init_path(ParticleThreadContext *ctx,
   ctx->cfra = cfra;
   ctx->editupdate = editupdate;
 
+  {
+    PTCacheEdit *edit = psys_orig_edit_get(psys);
+    ctx->pcache = psys_in_edit_mode(sim->depsgraph, psys) && edit ? edit->pathcache :
+                                                                      psys->pathcache;
+  }
+
+  /* Every parent is shared by many children, evaluate its emitter data only once.
+   * Edit updates only recalculate children of edited parents, those evaluate it on demand. */
+  if (ctx->pcache && psys->totpart && !editupdate) {
+    ParentDataCacheData data = {
+        .ctx = ctx,
+        .hairmat = MEM_mallocN(sizeof(*data.hairmat) * psys->totpart, __func__),
+        .orco = MEM_mallocN(sizeof(*data.orco) * psys->totpart, __func__),
+        .simple_orco = between ? NULL :
+                                 MEM_mallocN(sizeof(*data.simple_orco) * psys->totpart, __func__),
+    };
+
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (psys->totpart > 1000);
+    BLI_task_parallel_range(0, psys->totpart, &data, psys_cache_parent_data_cb, &settings);
+
+    ctx->parent_hairmat = data.hairmat;
+    ctx->parent_orco = data.orco;
+    ctx->simple_orco = data.simple_orco;
+  }
+
   psys->lattice_deform_data = psys_create_lattice_deform_data(&ctx->sim);
 
   /* cache all relevant vertex groups if they exist */
@@ -2409,9 +2538,7 @@ static void psys_thread_create_path(ParticleTask *task,
   ParticleSettings *part = psys->part;
   ParticleCacheKey **cache = psys->childcache;
   PTCacheEdit *edit = psys_orig_edit_get(psys);
-  ParticleCacheKey **pcache = psys_in_edit_mode(ctx->sim.depsgraph, psys) && edit ?
-                                  edit->pathcache :
-                                  psys->pathcache;
+  ParticleCacheKey **pcache = ctx->pcache;
   ParticleCacheKey *child, *key[4];
   ParticleTexture ptex;
   float *cpa_fuv = 0, *par_rot = 0, rot[4];
@@ -2425,7 +2552,6 @@ static void psys_thread_create_path(ParticleTask *task,
   }
 
   if (ctx->between) {
-    ParticleData *pa = psys->particles + cpa->pa[0];
     int w, needupdate;
     float foffset, wsum = 0.f;
     float co[3];
@@ -2528,11 +2654,10 @@ static void psys_thread_create_path(ParticleTask *task,
       sub_v3_v3v3(off1[w], co, key[w]->co);
     }
 
-    psys_mat_hair_to_global(ob, ctx->sim.psmd->mesh_final, psys->part->from, pa, hairmat);
+    psys_parent_hairmat(ctx, cpa->pa[0], hairmat);
   }
   else {
     ParticleData *pa = psys->particles + cpa->parent;
-    float co[3];
     if (ctx->editupdate) {
       if (!(edit->points[cpa->parent].flag & PEP_EDIT_RECALC)) {
         return;
@@ -2546,37 +2671,11 @@ static void psys_thread_create_path(ParticleTask *task,
 
     /* get the original coordinates (orco) for texture usage */
     cpa_from = part->from;
-
-    /*
-     * NOTE: Should in theory be the same as:
-     * cpa_num = psys_particle_dm_face_lookup(
-     *        ctx->sim.psmd->dm_final,
-     *        ctx->sim.psmd->dm_deformed,
-     *        pa->num, pa->fuv,
-     *        NULL);
-     */
-    cpa_num = (ELEM(pa->num_dmcache, DMCACHE_ISCHILD, DMCACHE_NOTFOUND)) ? pa->num :
-                                                                           pa->num_dmcache;
-
-    /* XXX hack to avoid messed up particle num and subsequent crash (#40733) */
-    if (cpa_num > ctx->sim.psmd->mesh_final->totface) {
-      cpa_num = 0;
-    }
+    cpa_num = psys_child_simple_num(ctx, pa);
     cpa_fuv = pa->fuv;
 
-    psys_particle_on_emitter(ctx->sim.psmd,
-                             cpa_from,
-                             cpa_num,
-                             DMCACHE_ISCHILD,
-                             cpa_fuv,
-                             pa->foffset,
-                             co,
-                             0,
-                             0,
-                             0,
-                             orco);
-
-    psys_mat_hair_to_global(ob, ctx->sim.psmd->mesh_final, psys->part->from, pa, hairmat);
+    psys_parent_simple_orco(ctx, cpa->parent, orco);
+    psys_parent_hairmat(ctx, cpa->parent, hairmat);
   }
 
   child_keys->segments = ctx->segments;
@@ -2672,7 +2771,6 @@ static void psys_thread_create_path(ParticleTask *task,
   {
     ParticleData *pa = NULL;
     ParticleCacheKey *par = NULL;
-    float par_co[3];
     float par_orco[3];
 
     if (ctx->totparent) {
@@ -2705,17 +2803,7 @@ static void psys_thread_create_path(ParticleTask *task,
       ListBase modifiers;
       BLI_listbase_clear(&modifiers);
 
-      psys_particle_on_emitter(ctx->sim.psmd,
-                               part->from,
-                               pa->num,
-                               pa->num_dmcache,
-                               pa->fuv,
-                               pa->foffset,
-                               par_co,
-                               NULL,
-                               NULL,
-                               NULL,
-                               par_orco);
+      psys_parent_orco(ctx, pa - psys->particles, par_orco);
 
       psys_apply_child_modifiers(
           ctx, &modifiers, cpa, &ptex, orco, hairmat, child_keys, par, par_orco);
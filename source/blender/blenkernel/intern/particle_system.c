@@ -47,6 +47,7 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_edgehash.h"
+#include "BLI_hash.h"
 #include "BLI_rand.h"
 #include "BLI_math.h"
 #include "BLI_blenlib.h"
@@ -545,6 +546,15 @@ void psys_thread_context_free(ParticleThreadContext *ctx)
   if (ctx->vg_twist) {
     MEM_freeN(ctx->vg_twist);
   }
+  if (ctx->parent_hairmat) {
+    MEM_freeN(ctx->parent_hairmat);
+  }
+  if (ctx->parent_orco) {
+    MEM_freeN(ctx->parent_orco);
+  }
+  if (ctx->simple_orco) {
+    MEM_freeN(ctx->simple_orco);
+  }
 
   if (ctx->sim.psys->lattice_deform_data) {
     end_latt_deform(ctx->sim.psys->lattice_deform_data);
@@ -3688,9 +3698,115 @@ typedef struct DynamicStepSolverTaskData {
   float timestep;
   float dtime;
 
+  /* Boids only, brain data of every particle. */
+  const BoidBrainData *bbd_init;
+  BoidBrainData *bbd;
+
+  /* Random seed of the step, see #dynamics_step_particle_rng. */
+  unsigned int seed;
+
   SpinLock spin;
 } DynamicStepSolverTaskData;
 
+typedef struct DynamicStepTLSData {
+  RNG *rng;
+} DynamicStepTLSData;
+
+/* Reseed the thread's random generator for the particle, so random numbers don't
+ * depend on which thread evaluates which particle. */
+static RNG *dynamics_step_particle_rng(const DynamicStepSolverTaskData *data,
+                                       DynamicStepTLSData *tls_data,
+                                       const int p,
+                                       const unsigned int pass)
+{
+  if (tls_data->rng == NULL) {
+    tls_data->rng = BLI_rng_new(0);
+  }
+  BLI_rng_srandom(tls_data->rng, BLI_hash_int_2d((unsigned int)p, data->seed + pass));
+  return tls_data->rng;
+}
+
+static void dynamics_step_tls_finalize(void *__restrict UNUSED(userdata),
+                                       void *__restrict userdata_chunk)
+{
+  DynamicStepTLSData *tls_data = userdata_chunk;
+
+  if (tls_data->rng) {
+    BLI_rng_free(tls_data->rng);
+  }
+}
+
+static void dynamics_step_newton_task_cb_ex(void *__restrict userdata,
+                                            const int p,
+                                            const ParallelRangeTLS *__restrict tls)
+{
+  DynamicStepSolverTaskData *data = userdata;
+  /* Local copy for the thread's random generator. */
+  ParticleSimulationData sim = *data->sim;
+  ParticleData *pa = sim.psys->particles + p;
+
+  if (pa->state.time <= 0.0f) {
+    return;
+  }
+
+  sim.rng = dynamics_step_particle_rng(data, tls->userdata_chunk, p, 0);
+
+  /* do global forces & effectors */
+  basic_integrate(&sim, p, pa->state.time, data->cfra);
+
+  /* deflection */
+  if (sim.colliders) {
+    collision_check(&sim, p, pa->state.time, data->cfra);
+  }
+
+  /* rotations */
+  basic_rotate(sim.psys->part, pa, pa->state.time, data->timestep);
+}
+
+static void dynamics_step_boids_brain_task_cb_ex(void *__restrict userdata,
+                                                 const int p,
+                                                 const ParallelRangeTLS *__restrict tls)
+{
+  DynamicStepSolverTaskData *data = userdata;
+  ParticleData *pa = data->sim->psys->particles + p;
+  BoidBrainData *bbd = &data->bbd[p];
+
+  if (pa->state.time <= 0.0f) {
+    return;
+  }
+
+  *bbd = *data->bbd_init;
+  bbd->rng = dynamics_step_particle_rng(data, tls->userdata_chunk, p, 0);
+
+  boid_brain(bbd, p, pa);
+}
+
+static void dynamics_step_boids_body_task_cb_ex(void *__restrict userdata,
+                                                const int p,
+                                                const ParallelRangeTLS *__restrict tls)
+{
+  DynamicStepSolverTaskData *data = userdata;
+  /* Local copy for the thread's random generator. */
+  ParticleSimulationData sim = *data->sim;
+  ParticleData *pa = sim.psys->particles + p;
+  BoidBrainData *bbd = &data->bbd[p];
+
+  if (pa->state.time <= 0.0f || pa->alive == PARS_DYING) {
+    return;
+  }
+
+  sim.rng = dynamics_step_particle_rng(data, tls->userdata_chunk, p, 1);
+  bbd->sim = &sim;
+  bbd->rng = sim.rng;
+
+  boid_body(bbd, pa);
+
+  /* deflection */
+  if (sim.colliders) {
+    collision_check(&sim, p, pa->state.time, data->cfra);
+  }
+}
+
 static void dynamics_step_sph_ddr_task_cb_ex(void *__restrict userdata,
                                              const int p,
                                              const ParallelRangeTLS *__restrict tls)
@@ -3798,7 +3914,7 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 {
   ParticleSystem *psys = sim->psys;
   ParticleSettings *part = psys->part;
-  BoidBrainData bbd;
+  BoidBrainData bbd = {NULL};
   ParticleTexture ptex;
   PARTICLE_P;
   float timestep;
@@ -3844,7 +3960,6 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
       bbd.cfra = cfra;
       bbd.dfra = dfra;
       bbd.timestep = timestep;
-      bbd.rng = sim->rng;
 
       psys_update_particle_tree(psys, cfra);
 
@@ -3921,37 +4036,60 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 
   switch (part->phystype) {
     case PART_PHYS_NEWTON: {
-      LOOP_DYNAMIC_PARTICLES
-      {
-        /* do global forces & effectors */
-        basic_integrate(sim, p, pa->state.time, cfra);
-
-        /* deflection */
-        if (sim->colliders) {
-          collision_check(sim, p, pa->state.time, cfra);
-        }
-
-        /* rotations */
-        basic_rotate(part, pa, pa->state.time, timestep);
-      }
+      DynamicStepSolverTaskData task_data = {
+          .sim = sim,
+          .cfra = cfra,
+          .timestep = timestep,
+          .dtime = dtime,
+          .seed = 31415926 + (int)cfra + psys->seed,
+      };
+      DynamicStepTLSData tls_data = {NULL};
+
+      ParallelRangeSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      /* Effector noise is drawn from a generator shared by all particles. */
+      settings.use_threading = (psys->totpart > 100) && !BKE_effectors_use_noise(psys->effectors);
+      settings.userdata_chunk = &tls_data;
+      settings.userdata_chunk_size = sizeof(tls_data);
+      settings.func_finalize = dynamics_step_tls_finalize;
+      BLI_task_parallel_range(
+          0, psys->totpart, &task_data, dynamics_step_newton_task_cb_ex, &settings);
       break;
     }
     case PART_PHYS_BOIDS: {
-      LOOP_DYNAMIC_PARTICLES
-      {
-        bbd.goal_ob = NULL;
+      /* All brains are evaluated before any boid moves,
+       * so boids only see the state of other boids from the previous step. */
+      DynamicStepSolverTaskData task_data = {
+          .sim = sim,
+          .cfra = cfra,
+          .timestep = timestep,
+          .dtime = dtime,
+          .bbd_init = &bbd,
+          .bbd = MEM_mallocN(sizeof(BoidBrainData) * psys->totpart, "BoidBrainData"),
+          .seed = 31415926 + (int)cfra + psys->seed,
+      };
+      DynamicStepTLSData tls_data = {NULL};
 
-        boid_brain(&bbd, p, pa);
+      ParallelRangeSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      /* Effector noise is drawn from a generator shared by all particles. */
+      settings.use_threading = (psys->totpart > 100) && !BKE_effectors_use_noise(psys->effectors);
+      settings.userdata_chunk = &tls_data;
+      settings.userdata_chunk_size = sizeof(tls_data);
+      settings.func_finalize = dynamics_step_tls_finalize;
 
-        if (pa->alive != PARS_DYING) {
-          boid_body(&bbd, pa);
+      BLI_task_parallel_range(
+          0, psys->totpart, &task_data, dynamics_step_boids_brain_task_cb_ex, &settings);
 
-          /* deflection */
-          if (sim->colliders) {
-            collision_check(sim, p, pa->state.time, cfra);
-          }
-        }
+      LOOP_DYNAMIC_PARTICLES
+      {
+        boid_apply_damage(&task_data.bbd[p]);
       }
+
+      BLI_task_parallel_range(
+          0, psys->totpart, &task_data, dynamics_step_boids_body_task_cb_ex, &settings);
+
+      MEM_freeN(task_data.bbd);
       break;
     }
     case PART_PHYS_FLUID: {
@@ -43,8 +43,11 @@
 #include "DNA_smoke_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -142,8 +145,10 @@ static int ptcache_extra_datasize[] = {
 
 /* forward declarations */
 static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len);
-static int ptcache_file_compressed_write(
-    PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode);
+static int ptcache_file_compressed_write(PTCacheFile *pf,
+                                         unsigned char *in,
+                                         unsigned int in_len,
+                                         int mode);
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size);
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size);
 
@@ -166,11 +171,11 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
 static int ptcache_basic_header_write(PTCacheFile *pf)
 {
   /* Custom functions should write these basic elements too! */
-  if (!fwrite(&pf->totpoint, sizeof(unsigned int), 1, pf->fp)) {
+  if (!ptcache_file_write(pf, &pf->totpoint, 1, sizeof(unsigned int))) {
     return 0;
   }
 
-  if (!fwrite(&pf->data_types, sizeof(unsigned int), 1, pf->fp)) {
+  if (!ptcache_file_write(pf, &pf->data_types, 1, sizeof(unsigned int))) {
     return 0;
   }
 
@@ -629,8 +634,6 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
     float dt, dx, *dens, *react, *fuel, *flame, *heat, *heatold, *vx, *vy, *vz, *r, *g, *b;
     unsigned char *obstacles;
     unsigned int in_len = sizeof(float) * (unsigned int)res;
-    unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                      "pointcache_lzo_buffer");
     // int mode = res >= 1000000 ? 2 : 1;
     int mode = 1;  // light
     if (sds->cache_comp == SM_CACHE_HEAVY) {
@@ -654,26 +657,26 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
                  &b,
                  &obstacles);
 
-    ptcache_file_compressed_write(pf, (unsigned char *)sds->shadow, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len, out, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)sds->shadow, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len, mode);
     if (fluid_fields & SM_ACTIVE_HEAT) {
-      ptcache_file_compressed_write(pf, (unsigned char *)heat, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)heatold, in_len, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)heat, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)heatold, in_len, mode);
     }
     if (fluid_fields & SM_ACTIVE_FIRE) {
-      ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)react, in_len, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)react, in_len, mode);
     }
     if (fluid_fields & SM_ACTIVE_COLORS) {
-      ptcache_file_compressed_write(pf, (unsigned char *)r, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)g, in_len, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)b, in_len, out, mode);
-    }
-    ptcache_file_compressed_write(pf, (unsigned char *)vx, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)vy, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)vz, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)obstacles, (unsigned int)res, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)r, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)g, in_len, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)b, in_len, mode);
+    }
+    ptcache_file_compressed_write(pf, (unsigned char *)vx, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)vy, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)vz, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)obstacles, (unsigned int)res, mode);
     ptcache_file_write(pf, &dt, 1, sizeof(float));
     ptcache_file_write(pf, &dx, 1, sizeof(float));
     ptcache_file_write(pf, &sds->p0, 3, sizeof(float));
@@ -687,8 +690,6 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
     ptcache_file_write(pf, &sds->res_max, 3, sizeof(int));
     ptcache_file_write(pf, &sds->active_color, 3, sizeof(float));
 
-    MEM_freeN(out);
-
     ret = 1;
   }
 
@@ -699,7 +700,6 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
     float *dens, *react, *fuel, *flame, *tcu, *tcv, *tcw, *r, *g, *b;
     unsigned int in_len = sizeof(float) * (unsigned int)res;
     unsigned int in_len_big;
-    unsigned char *out;
     int mode;
 
     smoke_turbulence_get_res(sds->wt, res_big_array);
@@ -714,25 +714,20 @@ static int ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 
     smoke_turbulence_export(sds->wt, &dens, &react, &flame, &fuel, &r, &g, &b, &tcu, &tcv, &tcw);
 
-    out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len_big), "pointcache_lzo_buffer");
-    ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len_big, out, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len_big, mode);
     if (fluid_fields & SM_ACTIVE_FIRE) {
-      ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len_big, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len_big, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)react, in_len_big, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len_big, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len_big, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)react, in_len_big, mode);
     }
     if (fluid_fields & SM_ACTIVE_COLORS) {
-      ptcache_file_compressed_write(pf, (unsigned char *)r, in_len_big, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)g, in_len_big, out, mode);
-      ptcache_file_compressed_write(pf, (unsigned char *)b, in_len_big, out, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)r, in_len_big, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)g, in_len_big, mode);
+      ptcache_file_compressed_write(pf, (unsigned char *)b, in_len_big, mode);
     }
-    MEM_freeN(out);
-
-    out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len), "pointcache_lzo_buffer");
-    ptcache_file_compressed_write(pf, (unsigned char *)tcu, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)tcv, in_len, out, mode);
-    ptcache_file_compressed_write(pf, (unsigned char *)tcw, in_len, out, mode);
-    MEM_freeN(out);
+    ptcache_file_compressed_write(pf, (unsigned char *)tcu, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)tcv, in_len, mode);
+    ptcache_file_compressed_write(pf, (unsigned char *)tcw, in_len, mode);
 
     ret = 1;
   }
@@ -1021,6 +1016,121 @@ static void compute_fluid_matrices(SmokeDomainSettings *sds)
   }
 }
 
+/* Fields are converted to sparse grids in parallel, only the density grids used as
+ * clipping mask by the other fields are exported before pushing the tasks. */
+typedef struct SmokeOpenVDBExportTask {
+  const char *name;
+  /* Only the first channel is used for scalar grids. */
+  float *data[3];
+  unsigned char *data_ch;
+  const int *res;
+  float (*matrix)[4];
+  float clipping;
+  short vec_type;
+  bool is_color;
+  struct OpenVDBFloatGrid *mask;
+} SmokeOpenVDBExportTask;
+
+static void ptcache_smoke_openvdb_export_task(TaskPool *__restrict pool,
+                                              void *taskdata,
+                                              int UNUSED(threadid))
+{
+  struct OpenVDBWriter *writer = BLI_task_pool_userdata(pool);
+  SmokeOpenVDBExportTask *task = taskdata;
+
+  if (task->data_ch) {
+    OpenVDB_export_grid_ch(
+        writer, task->name, task->data_ch, task->res, task->matrix, task->clipping, task->mask);
+  }
+  else if (task->data[1]) {
+    OpenVDB_export_grid_vec(writer,
+                            task->name,
+                            task->data[0],
+                            task->data[1],
+                            task->data[2],
+                            task->res,
+                            task->matrix,
+                            task->vec_type,
+                            task->clipping,
+                            task->is_color,
+                            task->mask);
+  }
+  else {
+    OpenVDB_export_grid_fl(
+        writer, task->name, task->data[0], task->res, task->matrix, task->clipping, task->mask);
+  }
+}
+
+static void ptcache_smoke_openvdb_push(TaskPool *pool, const SmokeOpenVDBExportTask *task_init)
+{
+  SmokeOpenVDBExportTask *task = MEM_mallocN(sizeof(*task), __func__);
+  *task = *task_init;
+  BLI_task_pool_push(pool, ptcache_smoke_openvdb_export_task, task, true, TASK_PRIORITY_HIGH);
+}
+
+static void ptcache_smoke_openvdb_push_fl(TaskPool *pool,
+                                          const char *name,
+                                          float *data,
+                                          const int res[3],
+                                          float matrix[4][4],
+                                          const float clipping,
+                                          struct OpenVDBFloatGrid *mask)
+{
+  SmokeOpenVDBExportTask task = {
+      .name = name,
+      .data = {data, NULL, NULL},
+      .res = res,
+      .matrix = matrix,
+      .clipping = clipping,
+      .mask = mask,
+  };
+  ptcache_smoke_openvdb_push(pool, &task);
+}
+
+static void ptcache_smoke_openvdb_push_ch(TaskPool *pool,
+                                          const char *name,
+                                          unsigned char *data,
+                                          const int res[3],
+                                          float matrix[4][4],
+                                          const float clipping,
+                                          struct OpenVDBFloatGrid *mask)
+{
+  SmokeOpenVDBExportTask task = {
+      .name = name,
+      .data_ch = data,
+      .res = res,
+      .matrix = matrix,
+      .clipping = clipping,
+      .mask = mask,
+  };
+  ptcache_smoke_openvdb_push(pool, &task);
+}
+
+static void ptcache_smoke_openvdb_push_vec(TaskPool *pool,
+                                           const char *name,
+                                           float *data_x,
+                                           float *data_y,
+                                           float *data_z,
+                                           const int res[3],
+                                           float matrix[4][4],
+                                           short vec_type,
+                                           const float clipping,
+                                           const bool is_color,
+                                           struct OpenVDBFloatGrid *mask)
+{
+  SmokeOpenVDBExportTask task = {
+      .name = name,
+      .data = {data_x, data_y, data_z},
+      .res = res,
+      .matrix = matrix,
+      .clipping = clipping,
+      .vec_type = vec_type,
+      .is_color = is_color,
+      .mask = mask,
+  };
+  ptcache_smoke_openvdb_push(pool, &task);
+}
+
 static int ptcache_smoke_openvdb_write(struct OpenVDBWriter *writer, void *smoke_v)
 {
   SmokeModifierData *smd = (SmokeModifierData *)smoke_v;
@@ -1045,6 +1155,8 @@ static int ptcache_smoke_openvdb_write(struct OpenVDBWriter *writer, void *smoke
 
   struct OpenVDBFloatGrid *clip_grid = NULL;
 
+  TaskPool *pool = BLI_task_pool_create(BLI_task_scheduler_get(), writer);
+
   compute_fluid_matrices(sds);
 
   OpenVDBWriter_add_meta_int(writer, "blender/smoke/fluid_fields", fluid_fields);
@@ -1060,39 +1172,39 @@ static int ptcache_smoke_openvdb_write(struct OpenVDBWriter *writer, void *smoke
     clip_grid = wt_density_grid;
 
     if (fluid_fields & SM_ACTIVE_FIRE) {
-      OpenVDB_export_grid_fl(
-          writer, "flame", flame, sds->res_wt, sds->fluidmat_wt, sds->clipping, wt_density_grid);
-      OpenVDB_export_grid_fl(
-          writer, "fuel", fuel, sds->res_wt, sds->fluidmat_wt, sds->clipping, wt_density_grid);
-      OpenVDB_export_grid_fl(
-          writer, "react", react, sds->res_wt, sds->fluidmat_wt, sds->clipping, wt_density_grid);
+      ptcache_smoke_openvdb_push_fl(
+          pool, "flame", flame, sds->res_wt, sds->fluidmat_wt, sds->clipping, wt_density_grid);
+      ptcache_smoke_openvdb_push_fl(
+          pool, "fuel", fuel, sds->res_wt, sds->fluidmat_wt, sds->clipping, wt_density_grid);
+      ptcache_smoke_openvdb_push_fl(
+          pool, "react", react, sds->res_wt, sds->fluidmat_wt, sds->clipping, wt_density_grid);
     }
 
     if (fluid_fields & SM_ACTIVE_COLORS) {
-      OpenVDB_export_grid_vec(writer,
-                              "color",
-                              r,
-                              g,
-                              b,
-                              sds->res_wt,
-                              sds->fluidmat_wt,
-                              VEC_INVARIANT,
-                              true,
-                              sds->clipping,
-                              wt_density_grid);
-    }
-
-    OpenVDB_export_grid_vec(writer,
-                            "texture coordinates",
-                            tcu,
-                            tcv,
-                            tcw,
-                            sds->res,
-                            sds->fluidmat,
-                            VEC_INVARIANT,
-                            false,
-                            sds->clipping,
-                            wt_density_grid);
+      ptcache_smoke_openvdb_push_vec(pool,
+                                     "color",
+                                     r,
+                                     g,
+                                     b,
+                                     sds->res_wt,
+                                     sds->fluidmat_wt,
+                                     VEC_INVARIANT,
+                                     sds->clipping,
+                                     true,
+                                     wt_density_grid);
+    }
+
+    ptcache_smoke_openvdb_push_vec(pool,
+                                   "texture coordinates",
+                                   tcu,
+                                   tcv,
+                                   tcw,
+                                   sds->res,
+                                   sds->fluidmat,
+                                   VEC_INVARIANT,
+                                   sds->clipping,
+                                   false,
+                                   wt_density_grid);
   }
 
   if (sds->fluid) {
@@ -1125,57 +1237,60 @@ static int ptcache_smoke_openvdb_write(struct OpenVDBWriter *writer, void *smoke
         writer, name, dens, sds->res, sds->fluidmat, sds->clipping, NULL);
     clip_grid = sds->wt ? clip_grid : density_grid;
 
-    OpenVDB_export_grid_fl(
-        writer, "shadow", sds->shadow, sds->res, sds->fluidmat, sds->clipping, NULL);
+    ptcache_smoke_openvdb_push_fl(
+        pool, "shadow", sds->shadow, sds->res, sds->fluidmat, sds->clipping, NULL);
 
     if (fluid_fields & SM_ACTIVE_HEAT) {
-      OpenVDB_export_grid_fl(
-          writer, "heat", heat, sds->res, sds->fluidmat, sds->clipping, clip_grid);
-      OpenVDB_export_grid_fl(
-          writer, "heat_old", heatold, sds->res, sds->fluidmat, sds->clipping, clip_grid);
+      ptcache_smoke_openvdb_push_fl(
+          pool, "heat", heat, sds->res, sds->fluidmat, sds->clipping, clip_grid);
+      ptcache_smoke_openvdb_push_fl(
+          pool, "heat_old", heatold, sds->res, sds->fluidmat, sds->clipping, clip_grid);
     }
 
     if (fluid_fields & SM_ACTIVE_FIRE) {
       name = (!sds->wt) ? "flame" : "flame_low";
-      OpenVDB_export_grid_fl(
-          writer, name, flame, sds->res, sds->fluidmat, sds->clipping, density_grid);
+      ptcache_smoke_openvdb_push_fl(
+          pool, name, flame, sds->res, sds->fluidmat, sds->clipping, density_grid);
       name = (!sds->wt) ? "fuel" : "fuel_low";
-      OpenVDB_export_grid_fl(
-          writer, name, fuel, sds->res, sds->fluidmat, sds->clipping, density_grid);
+      ptcache_smoke_openvdb_push_fl(
+          pool, name, fuel, sds->res, sds->fluidmat, sds->clipping, density_grid);
       name = (!sds->wt) ? "react" : "react_low";
-      OpenVDB_export_grid_fl(
-          writer, name, react, sds->res, sds->fluidmat, sds->clipping, density_grid);
+      ptcache_smoke_openvdb_push_fl(
+          pool, name, react, sds->res, sds->fluidmat, sds->clipping, density_grid);
     }
 
     if (fluid_fields & SM_ACTIVE_COLORS) {
       name = (!sds->wt) ? "color" : "color_low";
-      OpenVDB_export_grid_vec(writer,
-                              name,
-                              r,
-                              g,
-                              b,
-                              sds->res,
-                              sds->fluidmat,
-                              VEC_INVARIANT,
-                              true,
-                              sds->clipping,
-                              density_grid);
-    }
-
-    OpenVDB_export_grid_vec(writer,
-                            "velocity",
-                            vx,
-                            vy,
-                            vz,
-                            sds->res,
-                            sds->fluidmat,
-                            VEC_CONTRAVARIANT_RELATIVE,
-                            false,
-                            sds->clipping,
-                            clip_grid);
-    OpenVDB_export_grid_ch(
-        writer, "obstacles", obstacles, sds->res, sds->fluidmat, sds->clipping, NULL);
-  }
+      ptcache_smoke_openvdb_push_vec(pool,
+                                     name,
+                                     r,
+                                     g,
+                                     b,
+                                     sds->res,
+                                     sds->fluidmat,
+                                     VEC_INVARIANT,
+                                     sds->clipping,
+                                     true,
+                                     density_grid);
+    }
+
+    ptcache_smoke_openvdb_push_vec(pool,
+                                   "velocity",
+                                   vx,
+                                   vy,
+                                   vz,
+                                   sds->res,
+                                   sds->fluidmat,
+                                   VEC_CONTRAVARIANT_RELATIVE,
+                                   sds->clipping,
+                                   false,
+                                   clip_grid);
+    ptcache_smoke_openvdb_push_ch(
+        pool, "obstacles", obstacles, sds->res, sds->fluidmat, sds->clipping, NULL);
+  }
+
+  BLI_task_pool_work_and_wait(pool);
+  BLI_task_pool_free(pool);
 
   return 1;
 }
@@ -1378,7 +1493,6 @@ static int ptcache_dynamicpaint_write(PTCacheFile *pf, void *dp_v)
   if (surface->format != MOD_DPAINT_SURFACE_F_IMAGESEQ && surface->data) {
     int total_points = surface->data->total_points;
     unsigned int in_len;
-    unsigned char *out;
 
     /* cache type */
     ptcache_file_write(pf, &surface->type, 1, sizeof(int));
@@ -1397,11 +1511,8 @@ static int ptcache_dynamicpaint_write(PTCacheFile *pf, void *dp_v)
       return 0;
     }
 
-    out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len), "pointcache_lzo_buffer");
-
     ptcache_file_compressed_write(
-        pf, (unsigned char *)surface->data->type_data, in_len, out, cache_compress);
-    MEM_freeN(out);
+        pf, (unsigned char *)surface->data->type_data, in_len, cache_compress);
   }
   return 1;
 }
@@ -2155,12 +2266,365 @@ static int ptcache_filename(PTCacheID *pid, char *filename, int cfra, short do_p
   return len; /* make sure the above string is always 16 chars */
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Asynchronous Disk Cache Writing
+ *
+ * Files opened for writing are serialized into memory on the simulating thread,
+ * closing them hands the data over to a few writer threads which do the compression
+ * and the actual disk I/O. This way independent frames are compressed in parallel
+ * and the simulation doesn't stall on the disk.
+ *
+ * Code reading, checking or removing cache files has to wait for the pending writes
+ * of those files first, see #ptcache_write_wait and #BKE_ptcache_write_flush.
+ * \{ */
+
+/* Maximum number of writer threads. */
+#define PTCACHE_WRITE_THREADS_MAX 4
+/* Bytes waiting to be written before the simulation blocks, limits memory usage. */
+#define PTCACHE_WRITE_QUEUE_MAX_BYTES ((size_t)512 * 1024 * 1024)
+
+typedef struct PTCacheWriteBlock {
+  struct PTCacheWriteBlock *next, *prev;
+  unsigned char *data;
+  unsigned int len, alloc_len;
+  /* Compression mode, 0 for data which is written as is. */
+  int compression;
+} PTCacheWriteBlock;
+
+typedef struct PTCacheWriteJob {
+  char filename[MAX_PTCACHE_FILE];
+  ListBase blocks;
+  /* Memory held by the blocks, counted against #PTCACHE_WRITE_QUEUE_MAX_BYTES. */
+  size_t size;
+} PTCacheWriteJob;
+
+static ThreadMutex ptcache_write_mutex = BLI_MUTEX_INITIALIZER;
+static ThreadCondition ptcache_write_cond;
+static ThreadQueue *ptcache_write_queue = NULL;
+static ListBase ptcache_write_threads = {NULL, NULL};
+/* Filenames of the jobs which are queued or being written. */
+static GSet *ptcache_write_pending = NULL;
+static size_t ptcache_write_pending_size = 0;
+/* Number of writes that failed, lets callers detect failures, see #ptcache_write_error_count. */
+static int ptcache_write_errors = 0;
+
+static unsigned char ptcache_compress(unsigned char *in,
+                                      unsigned int in_len,
+                                      unsigned char *out,
+                                      size_t *r_out_len,
+                                      unsigned char *props,
+                                      size_t *r_props_len,
+                                      int mode)
+{
+  unsigned char compressed = 0;
+  size_t out_len = 0;
+  size_t sizeOfIt = 5;
+
+  (void)in;
+  (void)in_len;
+  (void)out;
+  (void)props;
+  (void)mode; /* unused when building w/o compression */
+
+#ifdef WITH_LZO
+  out_len = LZO_OUT_LEN(in_len);
+  if (mode == 1) {
+    LZO_HEAP_ALLOC(wrkmem, LZO1X_MEM_COMPRESS);
+
+    int r = lzo1x_1_compress(in, (lzo_uint)in_len, out, (lzo_uint *)&out_len, wrkmem);
+    if (!(r == LZO_E_OK) || (out_len >= in_len)) {
+      compressed = 0;
+    }
+    else {
+      compressed = 1;
+    }
+  }
+#endif
+#ifdef WITH_LZMA
+  if (mode == 2) {
+
+    int r = LzmaCompress(out,
+                         &out_len,
+                         in,
+                         in_len,  // assume sizeof(char)==1....
+                         props,
+                         &sizeOfIt,
+                         5,
+                         1 << 24,
+                         3,
+                         0,
+                         2,
+                         32,
+                         2);
+
+    if (!(r == SZ_OK) || (out_len >= in_len)) {
+      compressed = 0;
+    }
+    else {
+      compressed = 2;
+    }
+  }
+#endif
+
+  *r_out_len = out_len;
+  *r_props_len = sizeOfIt;
+
+  return compressed;
+}
+
+static bool ptcache_write_block(FILE *fp, PTCacheWriteBlock *block)
+{
+  unsigned char compressed;
+  unsigned char *out;
+  unsigned char props[16];
+  size_t out_len, props_len;
+  bool ok = true;
+
+  if (block->compression == 0) {
+    return fwrite(block->data, 1, block->len, fp) == block->len;
+  }
+
+  out = MEM_mallocN(LZO_OUT_LEN(block->len), "pointcache_lzo_buffer");
+  compressed = ptcache_compress(
+      block->data, block->len, out, &out_len, props, &props_len, block->compression);
+
+  ok &= fwrite(&compressed, sizeof(unsigned char), 1, fp) == 1;
+  if (compressed) {
+    unsigned int size = out_len;
+    ok &= fwrite(&size, sizeof(unsigned int), 1, fp) == 1;
+    ok &= fwrite(out, 1, out_len, fp) == out_len;
+  }
+  else {
+    ok &= fwrite(block->data, 1, block->len, fp) == block->len;
+  }
+
+  if (compressed == 2) {
+    unsigned int size = props_len;
+    ok &= fwrite(&size, sizeof(unsigned int), 1, fp) == 1;
+    ok &= fwrite(props, 1, props_len, fp) == props_len;
+  }
+
+  MEM_freeN(out);
+
+  return ok;
+}
+
+/* Returns false when the file could not be written. */
+static bool ptcache_write_job_exec(PTCacheWriteJob *job)
+{
+  FILE *fp = BLI_fopen(job->filename, "wb");
+  PTCacheWriteBlock *block;
+  bool ok = true;
+
+  if (fp == NULL) {
+    CLOG_ERROR(&LOG, "Could not open disk cache file for writing: %s", job->filename);
+    return false;
+  }
+
+  for (block = job->blocks.first; block && ok; block = block->next) {
+    ok = ptcache_write_block(fp, block);
+  }
+
+  if (fclose(fp) != 0) {
+    ok = false;
+  }
+
+  if (!ok) {
+    CLOG_ERROR(&LOG, "Error writing to disk cache file: %s", job->filename);
+  }
+
+  return ok;
+}
+
+static void ptcache_write_job_free(PTCacheWriteJob *job)
+{
+  PTCacheWriteBlock *block, *block_next;
+
+  for (block = job->blocks.first; block; block = block_next) {
+    block_next = block->next;
+    MEM_freeN(block->data);
+    MEM_freeN(block);
+  }
+  MEM_freeN(job);
+}
+
+static void *ptcache_write_thread(void *UNUSED(data))
+{
+  PTCacheWriteJob *job;
+
+  /* Returns NULL once the queue is emptied at exit. */
+  while ((job = BLI_thread_queue_pop(ptcache_write_queue))) {
+    const bool ok = ptcache_write_job_exec(job);
+
+    BLI_mutex_lock(&ptcache_write_mutex);
+    if (!ok) {
+      ptcache_write_errors++;
+    }
+    ptcache_write_pending_size -= job->size;
+    BLI_gset_remove(ptcache_write_pending, job->filename, NULL);
+    BLI_condition_notify_all(&ptcache_write_cond);
+    BLI_mutex_unlock(&ptcache_write_mutex);
+
+    ptcache_write_job_free(job);
+  }
+
+  return NULL;
+}
+
+static void ptcache_write_job_push(PTCacheWriteJob *job)
+{
+  PTCacheWriteBlock *block;
+
+  job->size = 0;
+  for (block = job->blocks.first; block; block = block->next) {
+    job->size += block->alloc_len;
+  }
+
+  BLI_mutex_lock(&ptcache_write_mutex);
+
+  if (ptcache_write_queue == NULL) {
+    const int tot = min_ii(BLI_system_thread_count(), PTCACHE_WRITE_THREADS_MAX);
+
+    BLI_condition_init(&ptcache_write_cond);
+    ptcache_write_queue = BLI_thread_queue_init();
+    ptcache_write_pending = BLI_gset_str_new(__func__);
+
+    BLI_threadpool_init(&ptcache_write_threads, ptcache_write_thread, tot);
+    for (int i = 0; i < tot; i++) {
+      BLI_threadpool_insert(&ptcache_write_threads, NULL);
+    }
+  }
+
+  /* Never have two writes of the same file in flight. A job larger than the whole
+   * budget is still queued once nothing else is pending. */
+  while (BLI_gset_haskey(ptcache_write_pending, job->filename) ||
+         (ptcache_write_pending_size != 0 &&
+          ptcache_write_pending_size + job->size > PTCACHE_WRITE_QUEUE_MAX_BYTES)) {
+    BLI_condition_wait(&ptcache_write_cond, &ptcache_write_mutex);
+  }
+
+  ptcache_write_pending_size += job->size;
+  BLI_gset_insert(ptcache_write_pending, job->filename);
+  BLI_thread_queue_push(ptcache_write_queue, job);
+
+  BLI_mutex_unlock(&ptcache_write_mutex);
+}
+
+/* Returns true when the file is queued or being written. */
+static bool ptcache_write_is_pending(const char *filename)
+{
+  bool pending = false;
+
+  BLI_mutex_lock(&ptcache_write_mutex);
+  if (ptcache_write_pending) {
+    pending = BLI_gset_haskey(ptcache_write_pending, filename);
+  }
+  BLI_mutex_unlock(&ptcache_write_mutex);
+
+  return pending;
+}
+
+/* Wait until a pending write of the file has finished. */
+static void ptcache_write_wait(const char *filename)
+{
+  BLI_mutex_lock(&ptcache_write_mutex);
+  if (ptcache_write_pending) {
+    while (BLI_gset_haskey(ptcache_write_pending, filename)) {
+      BLI_condition_wait(&ptcache_write_cond, &ptcache_write_mutex);
+    }
+  }
+  BLI_mutex_unlock(&ptcache_write_mutex);
+}
+
+/**
+ * Wait until all pending disk cache writes have finished,
+ * needed before looking at the cache directory as a whole.
+ */
+void BKE_ptcache_write_flush(void)
+{
+  BLI_mutex_lock(&ptcache_write_mutex);
+  if (ptcache_write_pending) {
+    while (BLI_gset_len(ptcache_write_pending) != 0) {
+      BLI_condition_wait(&ptcache_write_cond, &ptcache_write_mutex);
+    }
+  }
+  BLI_mutex_unlock(&ptcache_write_mutex);
+}
+
+/**
+ * Number of disk cache writes that failed so far. Compare the values from before
+ * queuing writes and after #BKE_ptcache_write_flush to find out whether they all
+ * made it to disk.
+ */
+static int ptcache_write_error_count(void)
+{
+  int errors;
+
+  BLI_mutex_lock(&ptcache_write_mutex);
+  errors = ptcache_write_errors;
+  BLI_mutex_unlock(&ptcache_write_mutex);
+
+  return errors;
+}
+
+/* Finish pending writes and stop the writer threads. */
+void BKE_ptcache_write_exit(void)
+{
+  if (ptcache_write_queue == NULL) {
+    return;
+  }
+
+  BKE_ptcache_write_flush();
+
+  BLI_thread_queue_nowait(ptcache_write_queue);
+  BLI_threadpool_end(&ptcache_write_threads);
+  BLI_thread_queue_free(ptcache_write_queue);
+  BLI_gset_free(ptcache_write_pending, NULL);
+  BLI_condition_end(&ptcache_write_cond);
+
+  ptcache_write_queue = NULL;
+  ptcache_write_pending = NULL;
+}
+
+static PTCacheWriteBlock *ptcache_write_block_add(PTCacheWriteJob *job,
+                                                  unsigned int alloc_len,
+                                                  int compression)
+{
+  PTCacheWriteBlock *block = MEM_callocN(sizeof(PTCacheWriteBlock), "PTCacheWriteBlock");
+
+  block->data = MEM_mallocN(MAX2(alloc_len, 1), "PTCacheWriteBlock data");
+  block->alloc_len = alloc_len;
+  block->compression = compression;
+  BLI_addtail(&job->blocks, block);
+
+  return block;
+}
+
+static void ptcache_write_job_append(PTCacheWriteJob *job, const void *data, unsigned int len)
+{
+  PTCacheWriteBlock *block = job->blocks.last;
+
+  if (block == NULL || block->compression != 0) {
+    block = ptcache_write_block_add(job, MAX2(len, 4096), 0);
+  }
+  else if (block->len + len > block->alloc_len) {
+    block->alloc_len = MAX2(block->alloc_len * 2, block->len + len);
+    block->data = MEM_reallocN(block->data, block->alloc_len);
+  }
+
+  memcpy(block->data + block->len, data, len);
+  block->len += len;
+}
+
+/** \} */
+
 /* youll need to close yourself after! */
 static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 {
   PTCacheFile *pf;
   FILE *fp = NULL;
-  char filename[FILE_MAX * 2];
+  PTCacheWriteJob *job = NULL;
+  char filename[MAX_PTCACHE_FILE];
 
 #ifndef DURIAN_POINTCACHE_LIB_OK
   /* don't allow writing for linked objects */
@@ -2175,24 +2639,37 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
   ptcache_filename(pid, filename, cfra, 1, 1);
 
   if (mode == PTCACHE_FILE_READ) {
+    ptcache_write_wait(filename);
     fp = BLI_fopen(filename, "rb");
   }
   else if (mode == PTCACHE_FILE_WRITE) {
-    BLI_make_existing_file(
-        filename); /* will create the dir if needs be, same as //textures is created */
+    /* will create the dir if needs be, same as //textures is created */
+    BLI_make_existing_file(filename);
+
+    /* The data is written on close, see #ptcache_write_job_push. Create the file
+     * here already, so errors like missing permissions are reported to the caller. */
+    ptcache_write_wait(filename);
     fp = BLI_fopen(filename, "wb");
+    if (fp) {
+      fclose(fp);
+      fp = NULL;
+      job = MEM_callocN(sizeof(PTCacheWriteJob), "PTCacheWriteJob");
+      BLI_strncpy(job->filename, filename, sizeof(job->filename));
+    }
   }
   else if (mode == PTCACHE_FILE_UPDATE) {
+    ptcache_write_wait(filename);
     BLI_make_existing_file(filename);
     fp = BLI_fopen(filename, "rb+");
   }
 
-  if (!fp) {
+  if (!fp && !job) {
     return NULL;
   }
 
   pf = MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
   pf->fp = fp;
+  pf->write_job = job;
   pf->old_format = 0;
   pf->frame = cfra;
 
@@ -2201,7 +2678,12 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 static void ptcache_file_close(PTCacheFile *pf)
 {
   if (pf) {
-    fclose(pf->fp);
+    if (pf->write_job) {
+      ptcache_write_job_push(pf->write_job);
+    }
+    else {
+      fclose(pf->fp);
+    }
     MEM_freeN(pf);
   }
 }
@@ -2255,76 +2737,29 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result,
 
   return r;
 }
-static int ptcache_file_compressed_write(
-    PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode)
+static int ptcache_file_compressed_write(PTCacheFile *pf,
+                                         unsigned char *in,
+                                         unsigned int in_len,
+                                         int mode)
 {
-  int r = 0;
-  unsigned char compressed = 0;
-  size_t out_len = 0;
-  unsigned char *props = MEM_callocN(16 * sizeof(char), "tmp");
-  size_t sizeOfIt = 5;
-
-  (void)mode; /* unused when building w/o compression */
-
-#ifdef WITH_LZO
-  out_len = LZO_OUT_LEN(in_len);
-  if (mode == 1) {
-    LZO_HEAP_ALLOC(wrkmem, LZO1X_MEM_COMPRESS);
-
-    r = lzo1x_1_compress(in, (lzo_uint)in_len, out, (lzo_uint *)&out_len, wrkmem);
-    if (!(r == LZO_E_OK) || (out_len >= in_len)) {
-      compressed = 0;
-    }
-    else {
-      compressed = 1;
-    }
-  }
-#endif
-#ifdef WITH_LZMA
-  if (mode == 2) {
-
-    r = LzmaCompress(out,
-                     &out_len,
-                     in,
-                     in_len,  // assume sizeof(char)==1....
-                     props,
-                     &sizeOfIt,
-                     5,
-                     1 << 24,
-                     3,
-                     0,
-                     2,
-                     32,
-                     2);
-
-    if (!(r == SZ_OK) || (out_len >= in_len)) {
-      compressed = 0;
-    }
-    else {
-      compressed = 2;
-    }
-  }
-#endif
-
-  ptcache_file_write(pf, &compressed, 1, sizeof(unsigned char));
-  if (compressed) {
-    unsigned int size = out_len;
-    ptcache_file_write(pf, &size, 1, sizeof(unsigned int));
-    ptcache_file_write(pf, out, out_len, sizeof(unsigned char));
+  if (pf->write_job) {
+    /* Compressed when the file is written, see #ptcache_write_block. */
+    PTCacheWriteBlock *block = ptcache_write_block_add(pf->write_job, in_len, mode);
+    memcpy(block->data, in, in_len);
+    block->len = in_len;
   }
   else {
-    ptcache_file_write(pf, in, in_len, sizeof(unsigned char));
-  }
+    PTCacheWriteBlock block = {NULL};
 
-  if (compressed == 2) {
-    unsigned int size = sizeOfIt;
-    ptcache_file_write(pf, &sizeOfIt, 1, sizeof(unsigned int));
-    ptcache_file_write(pf, props, size, sizeof(unsigned char));
+    block.data = in;
+    block.len = in_len;
+    block.compression = mode;
+    if (!ptcache_write_block(pf->fp, &block)) {
+      return 0;
+    }
   }
 
-  MEM_freeN(props);
-
-  return r;
+  return 1;
 }
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size)
 {
@@ -2332,6 +2767,10 @@ static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigne
 }
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size)
 {
+  if (pf->write_job) {
+    ptcache_write_job_append(pf->write_job, f, tot * size);
+    return 1;
+  }
   return (fwrite(f, size, tot, pf->fp) == tot);
 }
 static int ptcache_file_data_read(PTCacheFile *pf)
@@ -2395,11 +2834,11 @@ static int ptcache_file_header_begin_write(PTCacheFile *pf)
   const char *bphysics = "BPHYSICS";
   unsigned int typeflag = pf->type + pf->flag;
 
-  if (fwrite(bphysics, sizeof(char), 8, pf->fp) != 8) {
+  if (!ptcache_file_write(pf, bphysics, 8, sizeof(char))) {
     return 0;
   }
 
-  if (!fwrite(&typeflag, sizeof(unsigned int), 1, pf->fp)) {
+  if (!ptcache_file_write(pf, &typeflag, 1, sizeof(unsigned int))) {
     return 0;
   }
 
@@ -2755,11 +3194,8 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
       for (i = 0; i < BPHYS_TOT_DATA; i++) {
         if (pm->data[i]) {
           unsigned int in_len = pm->totpoint * ptcache_data_size[i];
-          unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                            "pointcache_lzo_buffer");
           ptcache_file_compressed_write(
-              pf, (unsigned char *)(pm->data[i]), in_len, out, pid->cache->compression);
-          MEM_freeN(out);
+              pf, (unsigned char *)(pm->data[i]), in_len, pid->cache->compression);
         }
       }
     }
@@ -2791,11 +3227,8 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 
       if (pid->cache->compression) {
         unsigned int in_len = extra->totdata * ptcache_extra_datasize[extra->type];
-        unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                          "pointcache_lzo_buffer");
         ptcache_file_compressed_write(
-            pf, (unsigned char *)(extra->data), in_len, out, pid->cache->compression);
-        MEM_freeN(out);
+            pf, (unsigned char *)(extra->data), in_len, pid->cache->compression);
       }
       else {
         ptcache_file_write(pf, extra->data, extra->totdata, ptcache_extra_datasize[extra->type]);
@@ -3389,6 +3822,8 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
       if (pid->cache->flag & PTCACHE_DISK_CACHE) {
         ptcache_path(pid, path);
 
+        BKE_ptcache_write_flush();
+
         dir = opendir(path);
         if (dir == NULL) {
           return;
@@ -3479,6 +3914,7 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
       if (pid->cache->flag & PTCACHE_DISK_CACHE) {
         if (BKE_ptcache_id_exist(pid, cfra)) {
           ptcache_filename(pid, filename, cfra, 1, 1); /* no path */
+          ptcache_write_wait(filename);
           BLI_delete(filename, false, false);
         }
       }
@@ -3521,7 +3957,7 @@ int BKE_ptcache_id_exist(PTCacheID *pid, int cfra)
 
     ptcache_filename(pid, filename, cfra, 1, 1);
 
-    return BLI_exists(filename);
+    return ptcache_write_is_pending(filename) || BLI_exists(filename);
   }
   else {
     PTCacheMem *pm = pid->cache->mem_cache.first;
@@ -3599,6 +4035,8 @@ void BKE_ptcache_id_time(
 
       len = ptcache_filename(pid, filename, (int)cfra, 0, 0); /* no path */
 
+      BKE_ptcache_write_flush();
+
       dir = opendir(path);
       if (dir == NULL) {
         return;
@@ -3783,6 +4221,8 @@ void BKE_ptcache_remove(void)
 
   ptcache_path(NULL, path);
 
+  BKE_ptcache_write_flush();
+
   if (BLI_exists(path)) {
     /* The pointcache dir exists? - remove all pointcache */
 
@@ -3982,6 +4422,8 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
   int startframe = MAXFRAME, endframe = baker->anim_init ? scene->r.sfra : CFRA;
   int bake = baker->bake;
   int render = baker->render;
+  const int write_errors = ptcache_write_error_count();
+  bool write_failed;
 
   G.is_break = false;
 
@@ -4139,6 +4581,15 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
     CFRA += 1;
   }
 
+  /* Include writing the last frames to disk in the bake time. */
+  BKE_ptcache_write_flush();
+
+  /* Frames that didn't make it to disk are missing from the cache, don't mark it baked. */
+  write_failed = (ptcache_write_error_count() != write_errors);
+  if (write_failed) {
+    CLOG_ERROR(&LOG, "Could not write all baked frames to the disk cache");
+  }
+
   if (use_timer) {
     /* start with newline because of \r above */
     ptcache_dt_to_str(run, PIL_check_seconds_timer() - stime);
@@ -4152,7 +4603,7 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
   if (pid) {
     cache->flag &= ~(PTCACHE_BAKING | PTCACHE_REDO_NEEDED);
     cache->flag |= PTCACHE_SIMULATION_VALID;
-    if (bake) {
+    if (bake && !write_failed) {
       cache->flag |= PTCACHE_BAKED;
       /* write info file */
       if (cache->flag & PTCACHE_DISK_CACHE) {
@@ -4182,7 +4633,7 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
 
         cache->flag |= PTCACHE_SIMULATION_VALID;
 
-        if (bake) {
+        if (bake && !write_failed) {
           cache->flag |= PTCACHE_BAKED;
           if (cache->flag & PTCACHE_DISK_CACHE) {
             BKE_ptcache_write(pid, 0);
@@ -4232,6 +4683,7 @@ void BKE_ptcache_mem_to_disk(PTCacheID *pid)
   PointCache *cache = pid->cache;
   PTCacheMem *pm = cache->mem_cache.first;
   int baked = cache->flag & PTCACHE_BAKED;
+  const int write_errors = ptcache_write_error_count();
 
   /* Remove possible bake flag to allow clear */
   cache->flag &= ~PTCACHE_BAKED;
@@ -4249,6 +4701,12 @@ void BKE_ptcache_mem_to_disk(PTCacheID *pid)
     }
   }
 
+  /* The memory cache is freed by the caller, make sure the frames are on disk first. */
+  BKE_ptcache_write_flush();
+  if (ptcache_write_error_count() != write_errors) {
+    cache->flag &= ~PTCACHE_DISK_CACHE;
+  }
+
   /* write info file */
   if (cache->flag & PTCACHE_BAKED) {
     BKE_ptcache_write(pid, 0);
@@ -4320,6 +4778,9 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
   len = ptcache_filename(pid, old_filename, 0, 0, 0); /* no path */
 
   ptcache_path(pid, path);
+
+  BKE_ptcache_write_flush();
+
   dir = opendir(path);
   if (dir == NULL) {
     BLI_strncpy(pid->cache->name, old_name, sizeof(pid->cache->name));
@@ -4376,6 +4837,8 @@ void BKE_ptcache_load_external(PTCacheID *pid)
 
   len = ptcache_filename(pid, filename, 1, 0, 0); /* no path */
 
+  BKE_ptcache_write_flush();
+
   dir = opendir(path);
   if (dir == NULL) {
     return;
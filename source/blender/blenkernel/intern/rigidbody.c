@@ -34,6 +34,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #ifdef WITH_BULLET
 #  include "RBI_api.h"
@@ -1405,8 +1406,127 @@ static void rigidbody_update_sim_world(Scene *scene, RigidBodyWorld *rbw)
   rigidbody_update_ob_array(rbw);
 }
 
-static void rigidbody_update_sim_ob(
-    Depsgraph *depsgraph, Scene *scene, RigidBodyWorld *rbw, Object *ob, RigidBodyOb *rbo)
+/* Evaluate effector forces on more rigid bodies than this in parallel. */
+#define RB_EFFECTORS_PARALLEL_THRESHOLD 256
+
+typedef struct RigidbodyEffectorsData {
+  Depsgraph *depsgraph;
+  Scene *scene;
+  ListBase *effectors;
+  /* Effector noise is restarted for every body, so bodies are evaluated serially. */
+  bool use_noise;
+  EffectorWeights *effector_weights;
+  Object **objects;
+  float (*forces)[3];
+} RigidbodyEffectorsData;
+
+static void rigidbody_effectors_force_cb(void *__restrict userdata,
+                                         const int i,
+                                         const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  RigidbodyEffectorsData *data = userdata;
+  RigidBodyOb *rbo = data->objects[i]->rigidbody_object;
+  EffectedPoint epoint;
+  float eff_loc[3], eff_vel[3];
+
+  /* create dummy 'point' which represents last known position of object as result of sim */
+  /* XXX: this can create some inaccuracies with sim position,
+   * but is probably better than using unsimulated vals? */
+  RB_body_get_position(rbo->shared->physics_object, eff_loc);
+  RB_body_get_linear_velocity(rbo->shared->physics_object, eff_vel);
+
+  pd_point_from_loc(data->scene, eff_loc, eff_vel, 0, &epoint);
+
+  if (data->use_noise) {
+    BKE_effectors_reset_rng(data->depsgraph, data->effectors);
+  }
+
+  /* Calculate net force of effectors, and apply to sim object:
+   * - we use 'central force' since apply force requires a "relative position"
+   *   which we don't have... */
+  zero_v3(data->forces[i]);
+  BKE_effectors_apply(
+      data->effectors, NULL, data->effector_weights, &epoint, data->forces[i], NULL);
+}
+
+/**
+ * Apply the influence of effectors to the given dynamic bodies.
+ *
+ * The effectors are the same for all bodies (rigid bodies affected by effectors aren't effectors
+ * themselves), so they're only created once, and the forces are evaluated in parallel.
+ * Bullet bodies are only modified afterwards, from this thread.
+ *
+ * Effectors with noise share one random generator, which every body used to get freshly seeded.
+ * In that case the generator is reset per body and the bodies are evaluated in order.
+ */
+static void rigidbody_update_sim_effectors(Depsgraph *depsgraph,
+                                           Scene *scene,
+                                           RigidBodyWorld *rbw,
+                                           Object **objects,
+                                           const int objects_len)
+{
+  EffectorWeights *effector_weights = rbw->effector_weights;
+  ListBase *effectors;
+
+  if (objects_len == 0) {
+    return;
+  }
+
+  /* get effectors present in the group specified by effector_weights */
+  effectors = BKE_effectors_create(depsgraph, NULL, NULL, effector_weights);
+  if (effectors == NULL) {
+    if (G.f & G_DEBUG) {
+      for (int i = 0; i < objects_len; i++) {
+        printf("\tno forces to apply to '%s'\n", objects[i]->id.name + 2);
+      }
+    }
+    return;
+  }
+
+  RigidbodyEffectorsData data = {
+      .depsgraph = depsgraph,
+      .scene = scene,
+      .effectors = effectors,
+      .use_noise = BKE_effectors_use_noise(effectors),
+      .effector_weights = effector_weights,
+      .objects = objects,
+      .forces = MEM_mallocN(sizeof(*data.forces) * objects_len, __func__),
+  };
+
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (objects_len > RB_EFFECTORS_PARALLEL_THRESHOLD) && !data.use_noise;
+  BLI_task_parallel_range(0, objects_len, &data, rigidbody_effectors_force_cb, &settings);
+
+  for (int i = 0; i < objects_len; i++) {
+    RigidBodyOb *rbo = objects[i]->rigidbody_object;
+    const float *eff_force = data.forces[i];
+
+    if (G.f & G_DEBUG) {
+      printf("\tapplying force (%f,%f,%f) to '%s'\n",
+             eff_force[0],
+             eff_force[1],
+             eff_force[2],
+             objects[i]->id.name + 2);
+    }
+    /* activate object in case it is deactivated */
+    if (!is_zero_v3(eff_force)) {
+      RB_body_activate(rbo->shared->physics_object);
+    }
+    RB_body_apply_central_force(rbo->shared->physics_object, eff_force);
+  }
+
+  MEM_freeN(data.forces);
+
+  /* cleanup */
+  BKE_effectors_free(effectors);
+}
+
+/**
+ * \return true when the body is affected by effectors,
+ * see #rigidbody_update_sim_effectors.
+ */
+static bool rigidbody_update_sim_ob(Depsgraph *depsgraph, Object *ob, RigidBodyOb *rbo)
 {
   float loc[3];
   float rot[4];
@@ -1414,7 +1534,7 @@ static void rigidbody_update_sim_ob(
 
   /* only update if rigid body exists */
   if (rbo->shared->physics_object == NULL) {
-    return;
+    return false;
   }
 
   ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
@@ -1463,53 +1583,14 @@ static void rigidbody_update_sim_ob(
   /* only dynamic bodies need effector update */
   else if (rbo->type == RBO_TYPE_ACTIVE &&
            ((ob->pd == NULL) || (ob->pd->forcefield == PFIELD_NULL))) {
-    EffectorWeights *effector_weights = rbw->effector_weights;
-    EffectedPoint epoint;
-    ListBase *effectors;
-
-    /* get effectors present in the group specified by effector_weights */
-    effectors = BKE_effectors_create(depsgraph, ob, NULL, effector_weights);
-    if (effectors) {
-      float eff_force[3] = {0.0f, 0.0f, 0.0f};
-      float eff_loc[3], eff_vel[3];
-
-      /* create dummy 'point' which represents last known position of object as result of sim */
-      /* XXX: this can create some inaccuracies with sim position,
-       * but is probably better than using unsimulated vals? */
-      RB_body_get_position(rbo->shared->physics_object, eff_loc);
-      RB_body_get_linear_velocity(rbo->shared->physics_object, eff_vel);
-
-      pd_point_from_loc(scene, eff_loc, eff_vel, 0, &epoint);
-
-      /* Calculate net force of effectors, and apply to sim object:
-       * - we use 'central force' since apply force requires a "relative position"
-       *   which we don't have... */
-      BKE_effectors_apply(effectors, NULL, effector_weights, &epoint, eff_force, NULL);
-      if (G.f & G_DEBUG) {
-        printf("\tapplying force (%f,%f,%f) to '%s'\n",
-               eff_force[0],
-               eff_force[1],
-               eff_force[2],
-               ob->id.name + 2);
-      }
-      /* activate object in case it is deactivated */
-      if (!is_zero_v3(eff_force)) {
-        RB_body_activate(rbo->shared->physics_object);
-      }
-      RB_body_apply_central_force(rbo->shared->physics_object, eff_force);
-    }
-    else if (G.f & G_DEBUG) {
-      printf("\tno forces to apply to '%s'\n", ob->id.name + 2);
-    }
-
-    /* cleanup */
-    BKE_effectors_free(effectors);
+    return true;
   }
   /* NOTE: passive objects don't need to be updated since they don't move */
 
   /* NOTE: no other settings need to be explicitly updated here,
    * since RNA setters take care of the rest :)
    */
+  return false;
 }
 
 /**
@@ -1548,6 +1629,10 @@ static void rigidbody_update_simulation(Depsgraph *depsgraph,
     FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
   }
 
+  /* dynamic bodies affected by effectors, these are updated after all objects */
+  Object **effector_obs = MEM_mallocN(sizeof(*effector_obs) * rbw->numbodies, __func__);
+  int effector_obs_len = 0;
+
   /* update objects */
   FOREACH_COLLECTION_OBJECT_RECURSIVE_BEGIN (rbw->group, ob) {
     if (ob->type == OB_MESH) {
@@ -1598,11 +1683,17 @@ static void rigidbody_update_simulation(Depsgraph *depsgraph,
       rbo->flag &= ~(RBO_FLAG_NEEDS_VALIDATE | RBO_FLAG_NEEDS_RESHAPE);
 
       /* update simulation object... */
-      rigidbody_update_sim_ob(depsgraph, scene, rbw, ob, rbo);
+      if (rigidbody_update_sim_ob(depsgraph, ob, rbo)) {
+        BLI_assert(effector_obs_len < rbw->numbodies);
+        effector_obs[effector_obs_len++] = ob;
+      }
     }
   }
   FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
 
+  rigidbody_update_sim_effectors(depsgraph, scene, rbw, effector_obs, effector_obs_len);
+  MEM_freeN(effector_obs);
+
   /* update constraints */
   if (rbw->constraints == NULL) { /* no constraints, move on */
     return;
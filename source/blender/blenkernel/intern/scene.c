@@ -77,6 +77,7 @@
 #include "BKE_node.h"
 #include "BKE_object.h"
 #include "BKE_paint.h"
+#include "BKE_pointcache.h"
 #include "BKE_rigidbody.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -1596,6 +1597,191 @@ void BKE_scene_view_layer_graph_evaluated_ensure(Main *bmain, Scene *scene, View
   BKE_scene_graph_update_tagged(depsgraph, bmain);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Multi-Frame Evaluation
+ *
+ * Evaluate a list of frames using several independent dependency graphs, each one
+ * stepping through its own share of the frames on a dedicated thread. Results are
+ * handed to the caller on the calling thread, strictly in the requested frame order.
+ *
+ * Every graph owns its own copy-on-write copies of the data, so this is only valid
+ * when evaluation of a frame does not depend on the previous one (no point caches or
+ * rigid body world). Such scenes are rejected, callers keep stepping their own graph.
+ * \{ */
+
+typedef struct FrameEvalState {
+  Main *bmain;
+  const float *frames;
+  int frames_len;
+  int num_graphs;
+
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  /* Number of frames which have been handed to the caller. */
+  int frames_delivered;
+} FrameEvalState;
+
+typedef struct FrameEvalGraph {
+  FrameEvalState *state;
+  Depsgraph *depsgraph;
+  /* First frame index evaluated by this graph, the following ones are strided by the
+   * number of graphs. */
+  int first_frame;
+  /* Index of the frame stored in the graph, -1 when nothing is evaluated yet. */
+  int frame_evaluated;
+} FrameEvalGraph;
+
+/* Check whether evaluation of a frame depends on the evaluation of the previous ones. */
+bool BKE_scene_has_simulation_history(Scene *scene, ViewLayer *view_layer)
+{
+  if (scene->rigidbody_world != NULL) {
+    return true;
+  }
+  FOREACH_OBJECT_BEGIN (view_layer, ob) {
+    if (BKE_ptcache_object_has(scene, ob, 0)) {
+      return true;
+    }
+  }
+  FOREACH_OBJECT_END;
+  return false;
+}
+
+static void *scene_frame_eval_thread(void *data_v)
+{
+  FrameEvalGraph *data = data_v;
+  FrameEvalState *state = data->state;
+
+  for (int frame = data->first_frame; frame < state->frames_len; frame += state->num_graphs) {
+    /* Wait for the caller to be done with the previous frame stored in this graph. */
+    BLI_mutex_lock(&state->mutex);
+    while (state->frames_delivered <= frame - state->num_graphs) {
+      BLI_condition_wait(&state->cond, &state->mutex);
+    }
+    BLI_mutex_unlock(&state->mutex);
+
+    DEG_evaluate_on_framechange(state->bmain, data->depsgraph, state->frames[frame]);
+    DEG_ids_clear_recalc(state->bmain, data->depsgraph);
+
+    BLI_mutex_lock(&state->mutex);
+    data->frame_evaluated = frame;
+    BLI_condition_notify_all(&state->cond);
+    BLI_mutex_unlock(&state->mutex);
+  }
+
+  return NULL;
+}
+
+static Depsgraph *scene_frame_eval_graph_new(
+    Main *bmain, Scene *scene, ViewLayer *view_layer, const bool for_render, const int index)
+{
+  Depsgraph *depsgraph = DEG_graph_new(
+      scene, view_layer, for_render ? DAG_EVAL_RENDER : DAG_EVAL_VIEWPORT);
+  char name[1024];
+  BLI_snprintf(name, sizeof(name), "%s :: frames %d", scene->id.name, index);
+  DEG_debug_name_set(depsgraph, name);
+  DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+  return depsgraph;
+}
+
+/**
+ * Evaluate \a frames using up to \a num_graphs dependency graphs in parallel
+ * (zero or negative means one per system thread), calling \a frame_fn for each
+ * frame in order from the calling thread.
+ *
+ * \note The graphs are private to this call and never active, so original data-blocks
+ * are not modified.
+ *
+ * \return false without evaluating anything when the scene has simulation history.
+ */
+bool BKE_scene_graph_evaluate_frames(Main *bmain,
+                                     Scene *scene,
+                                     ViewLayer *view_layer,
+                                     const bool for_render,
+                                     const float *frames,
+                                     const int frames_len,
+                                     int num_graphs,
+                                     SceneFrameEvaluatedFn frame_fn,
+                                     void *userdata)
+{
+  if (BKE_scene_has_simulation_history(scene, view_layer)) {
+    return false;
+  }
+  if (frames_len <= 0) {
+    return true;
+  }
+  if (num_graphs <= 0) {
+    num_graphs = BLI_system_thread_count();
+  }
+  num_graphs = min_iii(num_graphs, frames_len, BLENDER_MAX_THREADS);
+
+  if (num_graphs == 1) {
+    Depsgraph *depsgraph = scene_frame_eval_graph_new(bmain, scene, view_layer, for_render, 0);
+    for (int frame = 0; frame < frames_len; frame++) {
+      DEG_evaluate_on_framechange(bmain, depsgraph, frames[frame]);
+      DEG_ids_clear_recalc(bmain, depsgraph);
+      frame_fn(depsgraph, frames[frame], userdata);
+    }
+    DEG_graph_free(depsgraph);
+    return true;
+  }
+
+  FrameEvalState state = {
+      .bmain = bmain,
+      .frames = frames,
+      .frames_len = frames_len,
+      .num_graphs = num_graphs,
+      .frames_delivered = 0,
+  };
+  BLI_mutex_init(&state.mutex);
+  BLI_condition_init(&state.cond);
+
+  /* Building touches main database, so it is done upfront from this thread. */
+  FrameEvalGraph *graphs = MEM_callocN(sizeof(*graphs) * num_graphs, __func__);
+  for (int i = 0; i < num_graphs; i++) {
+    graphs[i].state = &state;
+    graphs[i].depsgraph = scene_frame_eval_graph_new(bmain, scene, view_layer, for_render, i);
+    graphs[i].first_frame = i;
+    graphs[i].frame_evaluated = -1;
+  }
+
+  ListBase threads;
+  BLI_threadpool_init(&threads, scene_frame_eval_thread, num_graphs);
+  for (int i = 0; i < num_graphs; i++) {
+    BLI_threadpool_insert(&threads, &graphs[i]);
+  }
+
+  for (int frame = 0; frame < frames_len; frame++) {
+    FrameEvalGraph *data = &graphs[frame % num_graphs];
+
+    BLI_mutex_lock(&state.mutex);
+    while (data->frame_evaluated != frame) {
+      BLI_condition_wait(&state.cond, &state.mutex);
+    }
+    BLI_mutex_unlock(&state.mutex);
+
+    frame_fn(data->depsgraph, frames[frame], userdata);
+
+    BLI_mutex_lock(&state.mutex);
+    state.frames_delivered = frame + 1;
+    BLI_condition_notify_all(&state.cond);
+    BLI_mutex_unlock(&state.mutex);
+  }
+
+  BLI_threadpool_end(&threads);
+
+  for (int i = 0; i < num_graphs; i++) {
+    DEG_graph_free(graphs[i].depsgraph);
+  }
+  MEM_freeN(graphs);
+
+  BLI_condition_end(&state.cond);
+  BLI_mutex_end(&state.mutex);
+
+  return true;
+}
+
+/** \} */
+
 /* return default view */
 SceneRenderView *BKE_scene_add_render_view(Scene *sce, const char *name)
 {
@@ -21,20 +21,36 @@
  */
 
 #include <stddef.h>
+#include <stdlib.h>
 #include <memory.h>
+#include <zlib.h>
+
+#ifdef WIN32
+#  include "BLI_winstuff.h"
+#endif
 
 #include "MEM_guardedalloc.h"
 
+#include "DNA_color_types.h"
 #include "DNA_sequence_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+#include "DNA_vfont_types.h"
 
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_colormanagement.h"
 
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_threads.h"
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
 
 #include "BKE_sequencer.h"
 #include "BKE_scene.h"
@@ -67,6 +83,21 @@
  * entries one by one in reverse order to their creation.
  *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
+ *
+ * Disk cache:
+ * Images of the types the user stores are also written to U.sequencer_disk_cache_dir, one
+ * compressed file per entry, so they survive restarts and aren't limited by memory:
+ *   <blend file name>_seq_cache/<scene>/<strip>/<render hash>-<strip hash>-<type>-<frame>.dcf
+ * The render hash is the part of seq_hash_render_data() which doesn't depend on pointers, the
+ * strip hash covers the settings of all strips the image depends on and the source files it is
+ * read from. On a memory cache miss the file is read back into memory. Invalidating a strip
+ * removes its directory. Scene, movie clip and mask strips depend on other datablocks and are
+ * never stored. When the directory grows over its limit, least recently used files go first.
+ *
+ * Prefetching:
+ * Frames ahead of the playhead are rendered from a copy of the scene on a background thread,
+ * see seqprefetch.c. Its keys refer to the original scene and strips, so its images are found
+ * by the main thread, and its temporary entries are freed separately (creator_id).
  */
 
 typedef struct SeqCache {
@@ -109,13 +140,13 @@ static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
           (a->scene->r.views_format != b->scene->r.views_format) || (a->view_id != b->view_id));
 }
 
-static unsigned int seq_hash_render_data(const SeqRenderData *a)
+/* Part of the render data hash which doesn't depend on pointers, stays the same between sessions,
+ * so it's used to key the disk cache. */
+static unsigned int seq_hash_render_settings(const SeqRenderData *a)
 {
   unsigned int rval = a->rectx + a->recty;
 
   rval ^= a->preview_render_size;
-  rval ^= ((intptr_t)a->bmain) << 6;
-  rval ^= ((intptr_t)a->scene) << 6;
   rval ^= (int)(a->motion_blur_shutter * 100.0f) << 10;
   rval ^= a->motion_blur_samples << 16;
   rval ^= ((a->scene->r.views_format * 2) + a->view_id) << 24;
@@ -123,6 +154,16 @@ static unsigned int seq_hash_render_data(const SeqRenderData *a)
   return rval;
 }
 
+static unsigned int seq_hash_render_data(const SeqRenderData *a)
+{
+  unsigned int rval = seq_hash_render_settings(a);
+
+  rval ^= ((intptr_t)a->bmain) << 6;
+  rval ^= ((intptr_t)a->scene) << 6;
+
+  return rval;
+}
+
 static unsigned int seq_cache_hashhash(const void *key_)
 {
   const SeqCacheKey *key = key_;
@@ -144,6 +185,38 @@ static bool seq_cache_hashcmp(const void *a_, const void *b_)
           seq_cmp_render_data(&a->context, &b->context));
 }
 
+/* The prefetch thread renders a copy of the scene, its cache keys refer to the original scene
+ * and strips. Returns NULL when the strip has no original. */
+static Sequence *seq_cache_original_context(const SeqRenderData *context,
+                                             Sequence *seq,
+                                             SeqRenderData *r_context)
+{
+  *r_context = *context;
+
+  if (!context->is_prefetch_render) {
+    return seq;
+  }
+
+  r_context->scene = BKE_sequencer_prefetch_get_original_scene(context);
+  r_context->is_prefetch_render = false;
+  return BKE_sequencer_prefetch_get_original_sequence(seq, r_context->scene);
+}
+
+static int seq_cache_flag_get(Scene *scene, Sequence *seq)
+{
+  int flag;
+
+  if (seq->cache_flag & SEQ_CACHE_OVERRIDE) {
+    flag = seq->cache_flag;
+    flag |= scene->ed->cache_flag & SEQ_CACHE_STORE_FINAL_OUT;
+  }
+  else {
+    flag = scene->ed->cache_flag;
+  }
+
+  return flag;
+}
+
 static SeqCache *seq_cache_get_from_scene(Scene *scene)
 {
   if (scene && scene->ed && scene->ed->cache) {
@@ -282,20 +355,33 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
   }
 }
 
-static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
+static int seq_cache_key_cfra_cmp(const void *a_, const void *b_)
+{
+  const SeqCacheKey *a = *(const SeqCacheKey **)a_;
+  const SeqCacheKey *b = *(const SeqCacheKey **)b_;
+
+  if (a->cfra < b->cfra) {
+    return -1;
+  }
+  if (a->cfra > b->cfra) {
+    return 1;
+  }
+  return 0;
+}
+
+/* Find all "base" keys which may be recycled, sorted by frame.
+ * Returns number of keys, *r_keys must be freed by the caller.
+ */
+static int seq_cache_get_items_for_removal(Scene *scene, SeqCacheKey ***r_keys)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
-  SeqCacheKey *finalkey = NULL;
-  /*leftmost key*/
-  SeqCacheKey *lkey = NULL;
-  /*rightmost key*/
-  SeqCacheKey *rkey = NULL;
+  SeqCacheKey **keys = MEM_malloc_arrayN(
+      BLI_ghash_len(cache->hash), sizeof(*keys), "seq_cache_removal_keys");
   SeqCacheKey *key = NULL;
+  int keys_len = 0;
 
   GHashIterator gh_iter;
   BLI_ghashIterator_init(&gh_iter, cache->hash);
-  int total_count = 0;
-  int cheap_count = 0;
 
   while (!BLI_ghashIterator_done(&gh_iter)) {
     key = BLI_ghashIterator_getKey(&gh_iter);
@@ -307,6 +393,7 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
       seq_cache_recycle_linked(scene, key);
       /* can not continue iterating after linked remove */
       BLI_ghashIterator_init(&gh_iter, cache->hash);
+      keys_len = 0;
       continue;
     }
 
@@ -314,35 +401,22 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
       continue;
     }
 
-    total_count++;
-
     if (key->cost <= scene->ed->recycle_max_cost) {
-      cheap_count++;
-      if (lkey) {
-        if (key->cfra < lkey->cfra) {
-          lkey = key;
-        }
-      }
-      else {
-        lkey = key;
-      }
-      if (rkey) {
-        if (key->cfra > rkey->cfra) {
-          rkey = key;
-        }
-      }
-      else {
-        rkey = key;
-      }
+      keys[keys_len++] = key;
     }
   }
 
-  finalkey = seq_cache_choose_key(scene, lkey, rkey);
-  return finalkey;
+  qsort(keys, (size_t)keys_len, sizeof(*keys), seq_cache_key_cfra_cmp);
+
+  *r_keys = keys;
+  return keys_len;
 }
 
 /* Find only "base" keys
  * Sources(other types) for a frame must be freed all at once
+ *
+ * Recycling a frame does not change which other frames may be recycled, so candidates
+ * are gathered once and removed from both ends, farthest from current frame first.
  */
 static bool seq_cache_recycle_item(Scene *scene)
 {
@@ -354,13 +428,25 @@ static bool seq_cache_recycle_item(Scene *scene)
 
   seq_cache_lock(scene);
 
-  while (cache->memory_used > memory_total) {
-    SeqCacheKey *finalkey = seq_cache_get_item_for_removal(scene);
+  if (cache->memory_used > memory_total) {
+    SeqCacheKey **keys;
+    const int keys_len = seq_cache_get_items_for_removal(scene, &keys);
+    int lindex = 0, rindex = keys_len - 1;
+
+    while (cache->memory_used > memory_total && lindex <= rindex) {
+      SeqCacheKey *finalkey = seq_cache_choose_key(scene, keys[lindex], keys[rindex]);
 
-    if (finalkey) {
+      if (finalkey == keys[lindex]) {
+        lindex++;
+      }
+      else {
+        rindex--;
+      }
       seq_cache_recycle_linked(scene, finalkey);
     }
-    else {
+    MEM_freeN(keys);
+
+    if (cache->memory_used > memory_total) {
       seq_cache_unlock(scene);
       return false;
     }
@@ -408,6 +494,654 @@ static void BKE_sequencer_cache_create(Scene *scene)
   BLI_mutex_unlock(&cache_create_lock);
 }
 
+/* ***************************** Disk cache ****************************** */
+
+#define DCACHE_FILE_VERSION 1
+/* MAX_COLORSPACE_NAME */
+#define DCACHE_COLORSPACE_NAME 64
+
+/* Flags that change the image of a strip. */
+#define DCACHE_SEQ_FLAG_MASK \
+  (SEQ_FILTERY | SEQ_MUTE | SEQ_REVERSE_FRAMES | SEQ_IPO_FRAME_LOCKED | SEQ_FLIPX | SEQ_FLIPY | \
+   SEQ_MAKE_FLOAT | SEQ_USE_PROXY | SEQ_USE_TRANSFORM | SEQ_USE_CROP | \
+   SEQ_USE_EFFECT_DEFAULT_FADE | SEQ_USE_LINEAR_MODIFIERS | SEQ_USE_VIEWS)
+
+enum {
+  DCACHE_HAS_RECT = (1 << 0),
+  DCACHE_HAS_RECT_FLOAT = (1 << 1),
+};
+
+/* Start of every file, followed by the pixels. A file is only used when everything up to the
+ * image size matches the key that is looked up, hash collisions can't return a wrong image. */
+typedef struct SeqDiskCacheHeader {
+  char magic[4];
+  int version;
+  unsigned int render_hash;
+  unsigned int strip_hash;
+  int type;
+  float nfra;
+  int rectx, recty;
+  int preview_render_size;
+  int motion_blur_samples;
+  float motion_blur_shutter;
+  int views_format;
+  int view_id;
+
+  /* Image. */
+  int x, y;
+  int planes, channels;
+  int flag;
+  char rect_colorspace[DCACHE_COLORSPACE_NAME];
+  char float_colorspace[DCACHE_COLORSPACE_NAME];
+} SeqDiskCacheHeader;
+
+typedef struct SeqDiskCacheFile {
+  char *path;
+  int64_t mtime;
+  size_t size;
+} SeqDiskCacheFile;
+
+/* Size of the cache directory, counted once per session and updated by every write. */
+static struct {
+  ThreadMutex lock;
+  char dir[FILE_MAX];
+  size_t size_total;
+  bool is_counted;
+} seq_disk_cache = {BLI_MUTEX_INITIALIZER};
+
+static bool seq_disk_cache_is_enabled(const char *blendfile_path)
+{
+  return (U.sequencer_disk_cache_dir[0] != '\0' && blendfile_path[0] != '\0');
+}
+
+static void seq_disk_cache_get_dir(const char *blendfile_path, char *r_dir)
+{
+  BLI_strncpy(r_dir, U.sequencer_disk_cache_dir, FILE_MAX);
+  BLI_path_abs(r_dir, blendfile_path);
+}
+
+static void seq_disk_cache_get_strip_dir(const char *blendfile_path,
+                                         Scene *scene,
+                                         Sequence *seq,
+                                         char *r_dir)
+{
+  char dir[FILE_MAX], project[FILE_MAXFILE];
+  char scene_name[MAX_ID_NAME], seq_name[SEQ_NAME_MAXSTR];
+
+  seq_disk_cache_get_dir(blendfile_path, dir);
+  BLI_split_file_part(blendfile_path, project, sizeof(project));
+  BLI_path_extension_replace(project, sizeof(project), "_seq_cache");
+  BLI_strncpy(scene_name, scene->id.name + 2, sizeof(scene_name));
+  BLI_filename_make_safe(scene_name);
+  BLI_strncpy(seq_name, seq->name + 2, sizeof(seq_name));
+  BLI_filename_make_safe(seq_name);
+
+  BLI_path_join(r_dir, FILE_MAX, dir, project, scene_name, seq_name, NULL);
+}
+
+static void seq_disk_cache_hash_string(BLI_HashMurmur2A *mm2, const char *str)
+{
+  BLI_hash_mm2a_add(mm2, (const unsigned char *)str, strlen(str));
+}
+
+/* Source files may change between sessions, so their time stamp and size are hashed too. */
+static void seq_disk_cache_hash_file(BLI_HashMurmur2A *mm2,
+                                     const char *blendfile_path,
+                                     const char *dir,
+                                     const char *name)
+{
+  char path[FILE_MAX];
+  BLI_stat_t st;
+
+  BLI_join_dirfile(path, sizeof(path), dir, name);
+  BLI_path_abs(path, blendfile_path);
+
+  if (BLI_stat(path, &st) != -1) {
+    const int64_t mtime = (int64_t)st.st_mtime;
+    const int64_t size = (int64_t)st.st_size;
+    BLI_hash_mm2a_add(mm2, (const unsigned char *)&mtime, sizeof(mtime));
+    BLI_hash_mm2a_add(mm2, (const unsigned char *)&size, sizeof(size));
+  }
+}
+
+static void seq_disk_cache_hash_curve_mapping(BLI_HashMurmur2A *mm2, const CurveMapping *cumap)
+{
+  BLI_hash_mm2a_add_int(mm2, cumap->flag);
+  BLI_hash_mm2a_add_int(mm2, cumap->tone);
+  BLI_hash_mm2a_add(mm2, (const unsigned char *)cumap->black, sizeof(cumap->black));
+  BLI_hash_mm2a_add(mm2, (const unsigned char *)cumap->white, sizeof(cumap->white));
+
+  for (int i = 0; i < CM_TOT; i++) {
+    const CurveMap *cuma = &cumap->cm[i];
+
+    BLI_hash_mm2a_add_int(mm2, cuma->flag);
+    BLI_hash_mm2a_add_int(mm2, cuma->totpoint);
+    BLI_hash_mm2a_add(mm2, (const unsigned char *)cuma->ext_in, sizeof(cuma->ext_in));
+    BLI_hash_mm2a_add(mm2, (const unsigned char *)cuma->ext_out, sizeof(cuma->ext_out));
+    if (cuma->curve) {
+      BLI_hash_mm2a_add(
+          mm2, (const unsigned char *)cuma->curve, sizeof(*cuma->curve) * cuma->totpoint);
+    }
+  }
+}
+
+/* Effect settings, without pointers and runtime data. */
+static void seq_disk_cache_hash_effect(BLI_HashMurmur2A *mm2, Sequence *seq)
+{
+  if (seq->effectdata == NULL) {
+    return;
+  }
+
+  switch (seq->type) {
+    case SEQ_TYPE_TEXT: {
+      TextVars data;
+      memcpy(&data, seq->effectdata, sizeof(data));
+      if (data.text_font) {
+        seq_disk_cache_hash_string(mm2, data.text_font->name);
+      }
+      data.text_font = NULL;
+      data.text_blf_id = 0;
+      BLI_hash_mm2a_add(mm2, (const unsigned char *)&data, sizeof(data));
+      break;
+    }
+    case SEQ_TYPE_SPEED: {
+      SpeedControlVars data;
+      memcpy(&data, seq->effectdata, sizeof(data));
+      data.frameMap = NULL;
+      data.length = 0;
+      data.lastValidFrame = 0;
+      BLI_hash_mm2a_add(mm2, (const unsigned char *)&data, sizeof(data));
+      break;
+    }
+    default:
+      BLI_hash_mm2a_add(
+          mm2, (const unsigned char *)seq->effectdata, MEM_allocN_len(seq->effectdata));
+      break;
+  }
+}
+
+/* Hash everything the image of a strip depends on. Returns false for strips which depend on
+ * other datablocks, their images are never stored on disk. */
+static bool seq_disk_cache_hash_strip(BLI_HashMurmur2A *mm2,
+                                      const char *blendfile_path,
+                                      Sequence *seq,
+                                      float cfra)
+{
+  if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_MASK)) {
+    return false;
+  }
+
+  seq_disk_cache_hash_string(mm2, seq->name);
+  BLI_hash_mm2a_add_int(mm2, seq->type);
+  BLI_hash_mm2a_add_int(mm2, seq->flag & DCACHE_SEQ_FLAG_MASK);
+  BLI_hash_mm2a_add_int(mm2, seq->len);
+  BLI_hash_mm2a_add_int(mm2, seq->start);
+  BLI_hash_mm2a_add_int(mm2, seq->startofs);
+  BLI_hash_mm2a_add_int(mm2, seq->endofs);
+  BLI_hash_mm2a_add_int(mm2, seq->startstill);
+  BLI_hash_mm2a_add_int(mm2, seq->endstill);
+  BLI_hash_mm2a_add_int(mm2, seq->anim_startofs);
+  BLI_hash_mm2a_add_int(mm2, seq->anim_endofs);
+  BLI_hash_mm2a_add_int(mm2, seq->machine);
+  BLI_hash_mm2a_add_int(mm2, seq->streamindex);
+  BLI_hash_mm2a_add_int(mm2, seq->multicam_source);
+  BLI_hash_mm2a_add_int(mm2, seq->blend_mode);
+  BLI_hash_mm2a_add_int(mm2, seq->alpha_mode);
+  BLI_hash_mm2a_add_int(mm2, seq->views_format);
+  BLI_hash_mm2a_add(mm2, (const unsigned char *)&seq->sat, sizeof(seq->sat));
+  BLI_hash_mm2a_add(mm2, (const unsigned char *)&seq->mul, sizeof(seq->mul));
+  BLI_hash_mm2a_add(mm2, (const unsigned char *)&seq->strobe, sizeof(seq->strobe));
+  BLI_hash_mm2a_add(mm2, (const unsigned char *)&seq->effect_fader, sizeof(seq->effect_fader));
+  BLI_hash_mm2a_add(mm2, (const unsigned char *)&seq->speed_fader, sizeof(seq->speed_fader));
+  BLI_hash_mm2a_add(
+      mm2, (const unsigned char *)&seq->blend_opacity, sizeof(seq->blend_opacity));
+  if (seq->stereo3d_format) {
+    BLI_hash_mm2a_add(
+        mm2, (const unsigned char *)seq->stereo3d_format, sizeof(*seq->stereo3d_format));
+  }
+
+  Strip *strip = seq->strip;
+  if (strip) {
+    seq_disk_cache_hash_string(mm2, strip->dir);
+    seq_disk_cache_hash_string(mm2, strip->colorspace_settings.name);
+    if ((seq->flag & SEQ_USE_CROP) && strip->crop) {
+      BLI_hash_mm2a_add(mm2, (const unsigned char *)strip->crop, sizeof(*strip->crop));
+    }
+    if ((seq->flag & SEQ_USE_TRANSFORM) && strip->transform) {
+      BLI_hash_mm2a_add(
+          mm2, (const unsigned char *)strip->transform, sizeof(*strip->transform));
+    }
+    if ((seq->flag & SEQ_USE_PROXY) && strip->proxy) {
+      seq_disk_cache_hash_string(mm2, strip->proxy->dir);
+      seq_disk_cache_hash_string(mm2, strip->proxy->file);
+      BLI_hash_mm2a_add_int(mm2, strip->proxy->tc);
+      BLI_hash_mm2a_add_int(mm2, strip->proxy->build_size_flags);
+      BLI_hash_mm2a_add_int(mm2, strip->proxy->storage);
+    }
+
+    if (strip->stripdata && seq->type == SEQ_TYPE_IMAGE) {
+      const int elems_len = MEM_allocN_len(strip->stripdata) / sizeof(StripElem);
+      for (int i = 0; i < elems_len; i++) {
+        seq_disk_cache_hash_string(mm2, strip->stripdata[i].name);
+      }
+
+      StripElem *se = BKE_sequencer_give_stripelem(seq, cfra);
+      if (se) {
+        seq_disk_cache_hash_file(mm2, blendfile_path, strip->dir, se->name);
+      }
+    }
+    else if (strip->stripdata && seq->type == SEQ_TYPE_MOVIE) {
+      seq_disk_cache_hash_string(mm2, strip->stripdata->name);
+      seq_disk_cache_hash_file(mm2, blendfile_path, strip->dir, strip->stripdata->name);
+    }
+  }
+
+  seq_disk_cache_hash_effect(mm2, seq);
+
+  for (SequenceModifierData *smd = seq->modifiers.first; smd; smd = smd->next) {
+    if (smd->mask_input_type == SEQUENCE_MASK_INPUT_ID && smd->mask_id) {
+      return false;
+    }
+
+    BLI_hash_mm2a_add_int(mm2, smd->type);
+    BLI_hash_mm2a_add_int(mm2, smd->flag & SEQUENCE_MODIFIER_MUTE);
+    BLI_hash_mm2a_add_int(mm2, smd->mask_input_type);
+    BLI_hash_mm2a_add_int(mm2, smd->mask_time);
+    if (smd->mask_sequence &&
+        !seq_disk_cache_hash_strip(mm2, blendfile_path, smd->mask_sequence, cfra)) {
+      return false;
+    }
+
+    if (ELEM(smd->type, seqModifierType_Curves, seqModifierType_HueCorrect)) {
+      /* Same layout for both. */
+      seq_disk_cache_hash_curve_mapping(mm2, &((CurvesModifierData *)smd)->curve_mapping);
+    }
+    else {
+      const SequenceModifierTypeInfo *smti = BKE_sequence_modifier_type_info_get(smd->type);
+      if (smti && smti->struct_size > sizeof(*smd)) {
+        BLI_hash_mm2a_add(mm2,
+                          (const unsigned char *)(smd + 1),
+                          (size_t)smti->struct_size - sizeof(*smd));
+      }
+    }
+  }
+
+  Sequence *inputs[3] = {seq->seq1, seq->seq2, seq->seq3};
+  for (int i = 0; i < ARRAY_SIZE(inputs); i++) {
+    if (inputs[i] && !seq_disk_cache_hash_strip(mm2, blendfile_path, inputs[i], cfra)) {
+      return false;
+    }
+  }
+
+  for (Sequence *seq_child = seq->seqbase.first; seq_child; seq_child = seq_child->next) {
+    if (!seq_disk_cache_hash_strip(mm2, blendfile_path, seq_child, cfra)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Fill in the key part of the header, returns false when the image can't be stored on disk. */
+static bool seq_disk_cache_header_init(const SeqRenderData *context,
+                                       Sequence *seq,
+                                       float cfra,
+                                       int type,
+                                       SeqDiskCacheHeader *r_header)
+{
+  Scene *scene = context->scene;
+  const char *blendfile_path = BKE_main_blendfile_path(context->bmain);
+  BLI_HashMurmur2A mm2;
+
+  BLI_hash_mm2a_init(&mm2, 0);
+  seq_disk_cache_hash_string(&mm2, scene->sequencer_colorspace_settings.name);
+  seq_disk_cache_hash_string(&mm2, scene->display_settings.display_device);
+
+  if (!seq_disk_cache_hash_strip(&mm2, blendfile_path, seq, cfra)) {
+    return false;
+  }
+
+  /* Composited images also depend on the strips below. */
+  if (ELEM(type, SEQ_CACHE_STORE_COMPOSITE, SEQ_CACHE_STORE_FINAL_OUT)) {
+    ListBase *seqbase = BKE_sequence_seqbase(&scene->ed->seqbase, seq);
+
+    if (seqbase == NULL) {
+      return false;
+    }
+
+    for (Sequence *seq_iter = seqbase->first; seq_iter; seq_iter = seq_iter->next) {
+      if (seq_iter->machine < seq->machine && seq_iter->startdisp <= cfra &&
+          seq_iter->enddisp > cfra) {
+        if (!seq_disk_cache_hash_strip(&mm2, blendfile_path, seq_iter, cfra)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  memset(r_header, 0, sizeof(*r_header));
+  memcpy(r_header->magic, "BSDC", sizeof(r_header->magic));
+  r_header->version = DCACHE_FILE_VERSION;
+  r_header->render_hash = seq_hash_render_settings(context);
+  r_header->strip_hash = BLI_hash_mm2a_end(&mm2);
+  r_header->type = type;
+  r_header->nfra = cfra - seq->start;
+  r_header->rectx = context->rectx;
+  r_header->recty = context->recty;
+  r_header->preview_render_size = context->preview_render_size;
+  r_header->motion_blur_samples = context->motion_blur_samples;
+  r_header->motion_blur_shutter = context->motion_blur_shutter;
+  r_header->views_format = scene->r.views_format;
+  r_header->view_id = context->view_id;
+
+  return true;
+}
+
+static void seq_disk_cache_get_file_path(const SeqRenderData *context,
+                                         Sequence *seq,
+                                         const SeqDiskCacheHeader *header,
+                                         char *r_path)
+{
+  char dir[FILE_MAX], name[FILE_MAXFILE];
+
+  seq_disk_cache_get_strip_dir(BKE_main_blendfile_path(context->bmain), context->scene, seq, dir);
+  BLI_snprintf(name,
+               sizeof(name),
+               "%08x-%08x-%d-%g.dcf",
+               header->render_hash,
+               header->strip_hash,
+               header->type,
+               header->nfra);
+  BLI_join_dirfile(r_path, FILE_MAX, dir, name);
+}
+
+static void seq_disk_cache_files_gather(const char *dir,
+                                        SeqDiskCacheFile **files,
+                                        int *files_len,
+                                        int *files_alloc)
+{
+  struct direntry *entries;
+  const unsigned int entries_len = BLI_filelist_dir_contents(dir, &entries);
+
+  for (unsigned int i = 0; i < entries_len; i++) {
+    struct direntry *entry = &entries[i];
+
+    if (FILENAME_IS_CURRPAR(entry->relname)) {
+      continue;
+    }
+
+    if (S_ISDIR(entry->type)) {
+      seq_disk_cache_files_gather(entry->path, files, files_len, files_alloc);
+    }
+    else if (BLI_path_extension_check(entry->relname, ".dcf")) {
+      if (*files_len == *files_alloc) {
+        *files_alloc = max_ii(*files_alloc * 2, 256);
+        *files = MEM_reallocN(*files, sizeof(**files) * (*files_alloc));
+      }
+
+      SeqDiskCacheFile *file = &(*files)[(*files_len)++];
+      file->path = BLI_strdup(entry->path);
+      file->mtime = (int64_t)entry->s.st_mtime;
+      file->size = (size_t)entry->s.st_size;
+    }
+  }
+
+  BLI_filelist_free(entries, entries_len);
+}
+
+static int seq_disk_cache_file_mtime_cmp(const void *a_, const void *b_)
+{
+  const SeqDiskCacheFile *a = a_;
+  const SeqDiskCacheFile *b = b_;
+
+  if (a->mtime < b->mtime) {
+    return -1;
+  }
+  if (a->mtime > b->mtime) {
+    return 1;
+  }
+  return 0;
+}
+
+/* Count the files of the cache directory, removing least recently used ones while the directory
+ * is over its size limit. Must be called with seq_disk_cache.lock held. */
+static void seq_disk_cache_enforce_limit(const char *dir)
+{
+  const size_t size_limit = ((size_t)U.sequencer_disk_cache_size_limit) * 1024 * 1024 * 1024;
+  SeqDiskCacheFile *files = MEM_mallocN(sizeof(*files) * 256, __func__);
+  int files_len = 0, files_alloc = 256;
+
+  seq_disk_cache_files_gather(dir, &files, &files_len, &files_alloc);
+
+  size_t size_total = 0;
+  for (int i = 0; i < files_len; i++) {
+    size_total += files[i].size;
+  }
+
+  if (size_total > size_limit) {
+    qsort(files, (size_t)files_len, sizeof(*files), seq_disk_cache_file_mtime_cmp);
+
+    for (int i = 0; i < files_len && size_total > size_limit; i++) {
+      if (BLI_delete(files[i].path, false, false) == 0) {
+        size_total -= files[i].size;
+      }
+    }
+  }
+
+  for (int i = 0; i < files_len; i++) {
+    MEM_freeN(files[i].path);
+  }
+  MEM_freeN(files);
+
+  BLI_strncpy(seq_disk_cache.dir, dir, sizeof(seq_disk_cache.dir));
+  seq_disk_cache.size_total = size_total;
+  seq_disk_cache.is_counted = true;
+}
+
+static void seq_disk_cache_size_add(const char *dir, size_t size)
+{
+  const size_t size_limit = ((size_t)U.sequencer_disk_cache_size_limit) * 1024 * 1024 * 1024;
+
+  if (!seq_disk_cache.is_counted || !STREQ(seq_disk_cache.dir, dir)) {
+    seq_disk_cache_enforce_limit(dir);
+    return;
+  }
+
+  seq_disk_cache.size_total += size;
+  if (seq_disk_cache.size_total > size_limit) {
+    seq_disk_cache_enforce_limit(dir);
+  }
+}
+
+static ImBuf *seq_disk_cache_read(const SeqRenderData *context,
+                                  Sequence *seq,
+                                  float cfra,
+                                  int type)
+{
+  SeqDiskCacheHeader header, header_file;
+  char path[FILE_MAX];
+
+  if (!seq_disk_cache_header_init(context, seq, cfra, type, &header)) {
+    return NULL;
+  }
+  seq_disk_cache_get_file_path(context, seq, &header, path);
+
+  gzFile file = BLI_gzopen(path, "rb");
+  if (file == NULL) {
+    return NULL;
+  }
+
+  ImBuf *ibuf = NULL;
+
+  if (gzread(file, &header_file, sizeof(header_file)) == sizeof(header_file) &&
+      memcmp(&header, &header_file, offsetof(SeqDiskCacheHeader, x)) == 0 && header_file.x > 0 &&
+      header_file.y > 0 && header_file.channels > 0 && header_file.channels <= 4 &&
+      (header_file.flag & (DCACHE_HAS_RECT | DCACHE_HAS_RECT_FLOAT))) {
+    const size_t pixels_len = (size_t)header_file.x * (size_t)header_file.y;
+    bool ok = true;
+
+    ibuf = IMB_allocImBuf(header_file.x, header_file.y, header_file.planes, 0);
+    ibuf->channels = header_file.channels;
+
+    if (header_file.flag & DCACHE_HAS_RECT) {
+      const size_t size = pixels_len * 4;
+      ok = ok && imb_addrectImBuf(ibuf) &&
+           gzread(file, ibuf->rect, (unsigned int)size) == (int)size;
+    }
+    if (header_file.flag & DCACHE_HAS_RECT_FLOAT) {
+      const size_t size = pixels_len * (size_t)ibuf->channels * sizeof(float);
+      ok = ok && imb_addrectfloatImBuf(ibuf) &&
+           gzread(file, ibuf->rect_float, (unsigned int)size) == (int)size;
+    }
+
+    if (ok) {
+      if (header_file.rect_colorspace[0] != '\0') {
+        IMB_colormanagement_assign_rect_colorspace(ibuf, header_file.rect_colorspace);
+      }
+      if (header_file.float_colorspace[0] != '\0') {
+        IMB_colormanagement_assign_float_colorspace(ibuf, header_file.float_colorspace);
+      }
+    }
+    else {
+      IMB_freeImBuf(ibuf);
+      ibuf = NULL;
+    }
+  }
+
+  gzclose(file);
+
+  if (ibuf) {
+    /* Least recently used files are removed first. */
+    BLI_file_touch(path);
+  }
+
+  return ibuf;
+}
+
+static void seq_disk_cache_write(const SeqRenderData *context,
+                                 Sequence *seq,
+                                 float cfra,
+                                 int type,
+                                 ImBuf *ibuf)
+{
+  const char *blendfile_path = BKE_main_blendfile_path(context->bmain);
+  SeqDiskCacheHeader header;
+  char dir[FILE_MAX], path[FILE_MAX], path_temp[FILE_MAX];
+
+  if ((ibuf->rect == NULL && ibuf->rect_float == NULL) ||
+      !seq_disk_cache_header_init(context, seq, cfra, type, &header)) {
+    return;
+  }
+
+  header.x = ibuf->x;
+  header.y = ibuf->y;
+  header.planes = ibuf->planes;
+  header.channels = ibuf->channels;
+  if (ibuf->rect) {
+    header.flag |= DCACHE_HAS_RECT;
+    if (ibuf->rect_colorspace) {
+      BLI_strncpy(header.rect_colorspace,
+                  IMB_colormanagement_get_rect_colorspace(ibuf),
+                  sizeof(header.rect_colorspace));
+    }
+  }
+  if (ibuf->rect_float) {
+    header.flag |= DCACHE_HAS_RECT_FLOAT;
+    if (ibuf->float_colorspace) {
+      BLI_strncpy(header.float_colorspace,
+                  IMB_colormanagement_get_float_colorspace(ibuf),
+                  sizeof(header.float_colorspace));
+    }
+  }
+
+  seq_disk_cache_get_strip_dir(blendfile_path, context->scene, seq, dir);
+  seq_disk_cache_get_file_path(context, seq, &header, path);
+  BLI_snprintf(path_temp, sizeof(path_temp), "%s.tmp", path);
+
+  const int level = (U.sequencer_disk_cache_compression == USER_SEQ_DISK_CACHE_COMPRESSION_HIGH) ?
+                        9 :
+                        (U.sequencer_disk_cache_compression ==
+                         USER_SEQ_DISK_CACHE_COMPRESSION_LOW) ?
+                        1 :
+                        0;
+  char mode[4];
+  BLI_snprintf(mode, sizeof(mode), "wb%d", level);
+
+  BLI_mutex_lock(&seq_disk_cache.lock);
+
+  gzFile file = NULL;
+  if (BLI_dir_create_recursive(dir)) {
+    file = BLI_gzopen(path_temp, mode);
+  }
+
+  if (file) {
+    const size_t pixels_len = (size_t)ibuf->x * (size_t)ibuf->y;
+    bool ok = gzwrite(file, &header, sizeof(header)) == sizeof(header);
+
+    if (ibuf->rect) {
+      const size_t size = pixels_len * 4;
+      ok = ok && gzwrite(file, ibuf->rect, (unsigned int)size) == (int)size;
+    }
+    if (ibuf->rect_float) {
+      const size_t size = pixels_len * (size_t)ibuf->channels * sizeof(float);
+      ok = ok && gzwrite(file, ibuf->rect_float, (unsigned int)size) == (int)size;
+    }
+    ok = (gzclose(file) == Z_OK) && ok;
+
+    /* Readers only ever see complete files. */
+    if (ok && BLI_exists(path)) {
+      BLI_delete(path, false, false);
+    }
+    if (ok && BLI_rename(path_temp, path) == 0) {
+      char cache_dir[FILE_MAX];
+      seq_disk_cache_get_dir(blendfile_path, cache_dir);
+      seq_disk_cache_size_add(cache_dir, BLI_file_size(path));
+    }
+    else {
+      BLI_delete(path_temp, false, false);
+    }
+  }
+
+  BLI_mutex_unlock(&seq_disk_cache.lock);
+}
+
+/* Store the image on disk if the user stores this type of image, context and seq are the ones
+ * that were rendered, seq_orig the original strip. */
+static void seq_disk_cache_put(const SeqRenderData *context,
+                               Sequence *seq,
+                               Scene *scene_orig,
+                               Sequence *seq_orig,
+                               float cfra,
+                               int type,
+                               ImBuf *ibuf)
+{
+  if (!seq_disk_cache_is_enabled(BKE_main_blendfile_path(context->bmain)) ||
+      (seq_cache_flag_get(scene_orig, seq_orig) & type) == 0) {
+    return;
+  }
+
+  seq_disk_cache_write(context, seq, cfra, type, ibuf);
+}
+
+static void seq_disk_cache_delete_strip(Scene *scene, Sequence *seq)
+{
+  const char *blendfile_path = BKE_main_blendfile_path_from_global();
+  char dir[FILE_MAX];
+
+  if (!seq_disk_cache_is_enabled(blendfile_path)) {
+    return;
+  }
+
+  seq_disk_cache_get_strip_dir(blendfile_path, scene, seq, dir);
+
+  BLI_mutex_lock(&seq_disk_cache.lock);
+  if (BLI_exists(dir)) {
+    BLI_delete(dir, true, true);
+    seq_disk_cache.is_counted = false;
+  }
+  BLI_mutex_unlock(&seq_disk_cache.lock);
+}
+
 /* ***************************** API ****************************** */
 
 void BKE_sequencer_cache_free_temp_cache(Scene *scene, short id, int cfra)
@@ -455,6 +1189,8 @@ void BKE_sequencer_cache_cleanup_all(Main *bmain)
 }
 void BKE_sequencer_cache_cleanup(Scene *scene)
 {
+  BKE_sequencer_prefetch_stop(scene);
+
   SeqCache *cache = seq_cache_get_from_scene(scene);
   if (!cache) {
     return;
@@ -476,6 +1212,11 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
 
 void BKE_sequencer_cache_cleanup_sequence(Scene *scene, Sequence *seq)
 {
+  BKE_sequencer_prefetch_stop(scene);
+
+  /* Hashed strip state catches most edits, but not everything images depend on. */
+  seq_disk_cache_delete_strip(scene, seq);
+
   SeqCache *cache = seq_cache_get_from_scene(scene);
   if (!cache) {
     return;
@@ -502,70 +1243,19 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene, Sequence *seq)
   seq_cache_unlock(scene);
 }
 
-struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context,
-                                      Sequence *seq,
-                                      float cfra,
-                                      int type)
+/* Insert the image under the original scene and strip, returns true when it was added.
+ * Images loaded from disk are not part of a rendered stack, so they are not linked. */
+static bool seq_cache_put_ex(const SeqRenderData *context,
+                             Sequence *seq,
+                             float cfra,
+                             int type,
+                             ImBuf *i,
+                             float cost,
+                             short creator_id,
+                             bool is_linked)
 {
   Scene *scene = context->scene;
 
-  if (!scene->ed->cache) {
-    BKE_sequencer_cache_create(scene);
-    return NULL;
-  }
-
-  seq_cache_lock(scene);
-  SeqCache *cache = seq_cache_get_from_scene(scene);
-  ImBuf *ibuf = NULL;
-
-  if (cache && seq) {
-    SeqCacheKey key;
-
-    key.seq = seq;
-    key.context = *context;
-    key.nfra = cfra - seq->start;
-    key.type = type;
-
-    ibuf = seq_cache_get(cache, &key);
-  }
-  seq_cache_unlock(scene);
-
-  return ibuf;
-}
-
-bool BKE_sequencer_cache_put_if_possible(
-    const SeqRenderData *context, Sequence *seq, float cfra, int type, ImBuf *ibuf, float cost)
-{
-  Scene *scene = context->scene;
-
-  if (seq_cache_recycle_item(scene)) {
-    BKE_sequencer_cache_put(context, seq, cfra, type, ibuf, cost);
-    return true;
-  }
-  else {
-    seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-    scene->ed->cache->last_key = NULL;
-    return false;
-  }
-}
-
-void BKE_sequencer_cache_put(
-    const SeqRenderData *context, Sequence *seq, float cfra, int type, ImBuf *i, float cost)
-{
-  Scene *scene = context->scene;
-  short creator_id = 0;
-
-  if (i == NULL || context->skip_cache || context->is_proxy_render || !seq) {
-    return;
-  }
-
-  /* Prevent reinserting, it breaks cache key linking */
-  ImBuf *test = BKE_sequencer_cache_get(context, seq, cfra, type);
-  if (test) {
-    IMB_freeImBuf(test);
-    return;
-  }
-
   if (!scene->ed->cache) {
     BKE_sequencer_cache_create(scene);
   }
@@ -573,14 +1263,22 @@ void BKE_sequencer_cache_put(
   seq_cache_lock(scene);
 
   SeqCache *cache = seq_cache_get_from_scene(scene);
-  int flag;
-
-  if (seq->cache_flag & SEQ_CACHE_OVERRIDE) {
-    flag = seq->cache_flag;
-    flag |= scene->ed->cache_flag & SEQ_CACHE_STORE_FINAL_OUT;
-  }
-  else {
-    flag = scene->ed->cache_flag;
+  int flag = seq_cache_flag_get(scene, seq);
+
+  /* Prevent reinserting, it breaks cache key linking.
+   * Checked under the same lock as the insertion, so no other thread can add it meanwhile. */
+  {
+    SeqCacheKey test_key;
+    test_key.seq = seq;
+    test_key.context = *context;
+    test_key.nfra = cfra - seq->start;
+    test_key.type = type;
+
+    SeqCacheItem *test_item = BLI_ghash_lookup(cache->hash, &test_key);
+    if (test_item && test_item->ibuf) {
+      seq_cache_unlock(scene);
+      return false;
+    }
   }
 
   if (cost > SEQ_CACHE_COST_MAX) {
@@ -605,12 +1303,20 @@ void BKE_sequencer_cache_put(
   /* Item stored for later use */
   if (flag & type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    if (is_linked) {
+      key->link_prev = cache->last_key;
+    }
   }
 
   SeqCacheKey *temp_last_key = cache->last_key;
   seq_cache_put(cache, key, i);
 
+  if (!is_linked) {
+    cache->last_key = temp_last_key;
+    seq_cache_unlock(scene);
+    return true;
+  }
+
   /* Restore pointer to previous item as this one will be freed when stack is rendered */
   if (key->is_temp_cache) {
     cache->last_key = temp_last_key;
@@ -629,6 +1335,135 @@ void BKE_sequencer_cache_put(
   }
 
   seq_cache_unlock(scene);
+  return true;
+}
+
+struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context,
+                                      Sequence *seq,
+                                      float cfra,
+                                      int type)
+{
+  SeqRenderData context_orig;
+  Sequence *seq_orig;
+
+  if (!seq) {
+    return NULL;
+  }
+
+  seq_orig = seq_cache_original_context(context, seq, &context_orig);
+  if (!seq_orig) {
+    return NULL;
+  }
+
+  Scene *scene = context_orig.scene;
+
+  if (!scene->ed->cache) {
+    BKE_sequencer_cache_create(scene);
+  }
+
+  seq_cache_lock(scene);
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  ImBuf *ibuf = NULL;
+
+  if (cache) {
+    SeqCacheKey key;
+
+    key.seq = seq_orig;
+    key.context = context_orig;
+    key.nfra = cfra - seq_orig->start;
+    key.type = type;
+
+    ibuf = seq_cache_get(cache, &key);
+  }
+  seq_cache_unlock(scene);
+
+  if (ibuf || context->skip_cache || context->is_proxy_render ||
+      !seq_disk_cache_is_enabled(BKE_main_blendfile_path(context->bmain)) ||
+      (seq_cache_flag_get(scene, seq_orig) & type) == 0) {
+    return ibuf;
+  }
+
+  /* Not in memory, try disk. The file is keyed by the data that was rendered. */
+  ibuf = seq_disk_cache_read(context, seq, cfra, type);
+
+  if (ibuf && seq_cache_recycle_item(scene)) {
+    seq_cache_put_ex(&context_orig,
+                     seq_orig,
+                     cfra,
+                     type,
+                     ibuf,
+                     0.0f,
+                     context->is_prefetch_render ? SEQ_CACHE_CREATOR_PREFETCH :
+                                                   SEQ_CACHE_CREATOR_MAIN,
+                     false);
+  }
+
+  return ibuf;
+}
+
+bool BKE_sequencer_cache_put_if_possible(
+    const SeqRenderData *context, Sequence *seq, float cfra, int type, ImBuf *ibuf, float cost)
+{
+  Scene *scene = BKE_sequencer_prefetch_get_original_scene(context);
+
+  if (seq_cache_recycle_item(scene)) {
+    BKE_sequencer_cache_put(context, seq, cfra, type, ibuf, cost);
+    return true;
+  }
+  else {
+    seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
+    scene->ed->cache->last_key = NULL;
+
+    /* Frames that don't fit in memory are still kept on disk. */
+    if (ibuf && seq && !context->skip_cache && !context->is_proxy_render) {
+      SeqRenderData context_orig;
+      Sequence *seq_orig = seq_cache_original_context(context, seq, &context_orig);
+      if (seq_orig) {
+        seq_disk_cache_put(context, seq, scene, seq_orig, cfra, type, ibuf);
+      }
+    }
+    return false;
+  }
+}
+
+void BKE_sequencer_cache_put(
+    const SeqRenderData *context, Sequence *seq, float cfra, int type, ImBuf *i, float cost)
+{
+  SeqRenderData context_orig;
+  Sequence *seq_orig;
+
+  if (i == NULL || context->skip_cache || context->is_proxy_render || !seq) {
+    return;
+  }
+
+  seq_orig = seq_cache_original_context(context, seq, &context_orig);
+  if (!seq_orig) {
+    return;
+  }
+
+  if (seq_cache_put_ex(&context_orig,
+                       seq_orig,
+                       cfra,
+                       type,
+                       i,
+                       cost,
+                       context->is_prefetch_render ? SEQ_CACHE_CREATOR_PREFETCH :
+                                                     SEQ_CACHE_CREATOR_MAIN,
+                       true)) {
+    seq_disk_cache_put(context, seq, context_orig.scene, seq_orig, cfra, type, i);
+  }
+}
+
+bool BKE_sequencer_cache_is_full(Scene *scene)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  size_t memory_limit = ((size_t)U.memcachelimit) * 1024 * 1024;
+
+  if (!cache) {
+    return false;
+  }
+
+  return (cache->memory_used > memory_limit);
 }
 
 void BKE_sequencer_cache_iterate(
@@ -0,0 +1,358 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <stddef.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_sequence_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#include "BKE_global.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_sequencer.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+#include "DEG_depsgraph_query.h"
+
+/* ***************************** Sequencer prefetching ******************************
+ *
+ * Frames ahead of the playhead are rendered on a background thread, so playback mostly reads
+ * images from the cache.
+ *
+ * The thread doesn't render the original scene, which is edited on the main thread meanwhile.
+ * It has a private depsgraph, the evaluated scene of which is a copy of the original with its
+ * own strips. The graph is evaluated on the main thread first, text effects load fonts which
+ * can only be done there, frame changes on the thread only evaluate animation.
+ * Editing the original doesn't update the copy, the graph isn't known to the rest of Blender.
+ * Instead, invalidating the cache stops prefetching and the next start builds a new graph.
+ *
+ * The copied strips share names with the originals, cache keys are built from the originals
+ * found by name (see BKE_sequencer_prefetch_get_original_sequence()), so prefetched images are
+ * found by the main thread.
+ *
+ * Scenes with scene, movie clip or mask strips are not prefetched, they depend on other
+ * datablocks the copy doesn't own and scene strips render through the render pipeline.
+ */
+
+typedef struct PrefetchJob {
+  Main *bmain;
+  /* Original scene, cache keys and frame range. */
+  Scene *scene;
+  /* Private graph and its copy of the scene. */
+  Depsgraph *depsgraph;
+  Scene *scene_eval;
+
+  SeqRenderData context;
+  SeqRenderData context_cpy;
+  int chanshown;
+  int efra;
+
+  /* Original strips by name, built on the main thread. */
+  GHash *seq_map;
+
+  ListBase threads;
+  ThreadMutex prefetch_mutex;
+  ThreadCondition prefetch_cond;
+
+  /* Protected by prefetch_mutex. */
+  int cfra;
+  int next_frame;
+  bool stop;
+  bool cache_full;
+
+  bool running;
+} PrefetchJob;
+
+static PrefetchJob *seq_prefetch_job_get(Scene *scene)
+{
+  if (scene && scene->ed) {
+    return scene->ed->prefetch_job;
+  }
+  return NULL;
+}
+
+static bool seq_prefetch_is_supported(Scene *scene)
+{
+  Sequence *seq;
+  bool supported = true;
+
+  SEQ_BEGIN (scene->ed, seq) {
+    if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_MASK)) {
+      supported = false;
+    }
+  }
+  SEQ_END;
+
+  return supported;
+}
+
+static bool seq_prefetch_context_changed(const PrefetchJob *pfjob,
+                                         const SeqRenderData *context,
+                                         int chanshown)
+{
+  return ((pfjob->context.bmain != context->bmain) ||
+          (pfjob->context.rectx != context->rectx) || (pfjob->context.recty != context->recty) ||
+          (pfjob->context.preview_render_size != context->preview_render_size) ||
+          (pfjob->context.for_render != context->for_render) ||
+          (pfjob->context.motion_blur_samples != context->motion_blur_samples) ||
+          (pfjob->context.motion_blur_shutter != context->motion_blur_shutter) ||
+          (pfjob->chanshown != chanshown));
+}
+
+static int seq_prefetch_efra_get(Scene *scene)
+{
+  return PEFRA;
+}
+
+static void *seq_prefetch_frames(void *job)
+{
+  PrefetchJob *pfjob = job;
+
+  BLI_mutex_lock(&pfjob->prefetch_mutex);
+
+  while (!pfjob->stop) {
+    if (pfjob->cache_full || pfjob->next_frame > pfjob->cfra + U.prefetchframes ||
+        pfjob->next_frame > pfjob->efra) {
+      BLI_condition_wait(&pfjob->prefetch_cond, &pfjob->prefetch_mutex);
+      continue;
+    }
+
+    const int frame = pfjob->next_frame;
+    BLI_mutex_unlock(&pfjob->prefetch_mutex);
+
+    DEG_evaluate_on_framechange(pfjob->bmain, pfjob->depsgraph, frame);
+    ImBuf *ibuf = BKE_sequencer_give_ibuf(&pfjob->context_cpy, frame, pfjob->chanshown);
+    if (ibuf) {
+      IMB_freeImBuf(ibuf);
+    }
+
+    BLI_mutex_lock(&pfjob->prefetch_mutex);
+
+    /* The playhead may have jumped meanwhile. */
+    if (pfjob->next_frame == frame) {
+      pfjob->next_frame++;
+    }
+    if (BKE_sequencer_cache_is_full(pfjob->scene)) {
+      pfjob->cache_full = true;
+    }
+  }
+
+  BLI_mutex_unlock(&pfjob->prefetch_mutex);
+
+  return NULL;
+}
+
+static PrefetchJob *seq_prefetch_job_create(Scene *scene)
+{
+  PrefetchJob *pfjob = MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
+
+  pfjob->scene = scene;
+  BLI_mutex_init(&pfjob->prefetch_mutex);
+  BLI_condition_init(&pfjob->prefetch_cond);
+  scene->ed->prefetch_job = pfjob;
+
+  return pfjob;
+}
+
+static void seq_prefetch_init_data(PrefetchJob *pfjob,
+                                   const SeqRenderData *context,
+                                   float cfra,
+                                   int chanshown)
+{
+  Main *bmain = context->bmain;
+  Scene *scene = context->scene;
+  ViewLayer *view_layer = context->depsgraph ? DEG_get_input_view_layer(context->depsgraph) :
+                                               BKE_view_layer_default_render(scene);
+  Sequence *seq;
+
+  pfjob->bmain = bmain;
+  pfjob->context = *context;
+  pfjob->chanshown = chanshown;
+  pfjob->efra = seq_prefetch_efra_get(scene);
+
+  pfjob->depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_VIEWPORT);
+  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  DEG_graph_build_from_view_layer(pfjob->depsgraph, bmain, scene, view_layer);
+  DEG_evaluate_on_framechange(bmain, pfjob->depsgraph, cfra);
+  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
+
+  BKE_sequencer_new_render_data(bmain,
+                                pfjob->depsgraph,
+                                pfjob->scene_eval,
+                                context->rectx,
+                                context->recty,
+                                context->preview_render_size,
+                                context->for_render,
+                                &pfjob->context_cpy);
+  pfjob->context_cpy.motion_blur_samples = context->motion_blur_samples;
+  pfjob->context_cpy.motion_blur_shutter = context->motion_blur_shutter;
+  pfjob->context_cpy.is_prefetch_render = true;
+
+  pfjob->seq_map = BLI_ghash_str_new(__func__);
+  SEQ_BEGIN (scene->ed, seq) {
+    BLI_ghash_insert(pfjob->seq_map, seq->name, seq);
+  }
+  SEQ_END;
+}
+
+static void seq_prefetch_free_data(PrefetchJob *pfjob)
+{
+  if (pfjob->seq_map) {
+    BLI_ghash_free(pfjob->seq_map, NULL, NULL);
+    pfjob->seq_map = NULL;
+  }
+  if (pfjob->depsgraph) {
+    DEG_graph_free(pfjob->depsgraph);
+    pfjob->depsgraph = NULL;
+    pfjob->scene_eval = NULL;
+  }
+}
+
+void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, int chanshown)
+{
+  Scene *scene = context->scene;
+  PrefetchJob *pfjob;
+
+  BLI_assert(BLI_thread_is_main());
+
+  if (context->is_prefetch_render || context->view_id != 0 || scene->ed == NULL) {
+    return;
+  }
+
+  if (U.prefetchframes <= 0 || G.is_rendering || !seq_prefetch_is_supported(scene)) {
+    BKE_sequencer_prefetch_stop(scene);
+    return;
+  }
+
+  pfjob = seq_prefetch_job_get(scene);
+  if (pfjob == NULL) {
+    pfjob = seq_prefetch_job_create(scene);
+  }
+  else if (pfjob->running && seq_prefetch_context_changed(pfjob, context, chanshown)) {
+    BKE_sequencer_prefetch_stop(scene);
+  }
+
+  if (!pfjob->running) {
+    seq_prefetch_init_data(pfjob, context, cfra, chanshown);
+
+    pfjob->cfra = (int)cfra;
+    pfjob->next_frame = (int)cfra + 1;
+    pfjob->stop = false;
+    pfjob->cache_full = BKE_sequencer_cache_is_full(scene);
+    pfjob->running = true;
+
+    BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+    BLI_threadpool_insert(&pfjob->threads, pfjob);
+    return;
+  }
+
+  BLI_mutex_lock(&pfjob->prefetch_mutex);
+
+  pfjob->efra = seq_prefetch_efra_get(scene);
+  if (pfjob->cfra != (int)cfra) {
+    pfjob->cfra = (int)cfra;
+    /* Continue where prefetching got to, unless the playhead jumped outside the range. */
+    if (pfjob->next_frame <= pfjob->cfra || pfjob->next_frame > pfjob->cfra + U.prefetchframes) {
+      pfjob->next_frame = pfjob->cfra + 1;
+    }
+  }
+  /* Playback recycles frames behind the playhead, try again. */
+  pfjob->cache_full = false;
+  BLI_condition_notify_one(&pfjob->prefetch_cond);
+
+  BLI_mutex_unlock(&pfjob->prefetch_mutex);
+}
+
+void BKE_sequencer_prefetch_stop(Scene *scene)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (pfjob == NULL || !pfjob->running || !BLI_thread_is_main()) {
+    return;
+  }
+
+  BLI_mutex_lock(&pfjob->prefetch_mutex);
+  pfjob->stop = true;
+  BLI_condition_notify_one(&pfjob->prefetch_cond);
+  BLI_mutex_unlock(&pfjob->prefetch_mutex);
+
+  /* Waits for the frame being rendered. */
+  BLI_threadpool_end(&pfjob->threads);
+  pfjob->running = false;
+
+  seq_prefetch_free_data(pfjob);
+  BKE_sequencer_cache_free_temp_cache(scene, SEQ_CACHE_CREATOR_PREFETCH, MINAFRAME - 1);
+}
+
+void BKE_sequencer_prefetch_free(Scene *scene)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (pfjob == NULL) {
+    return;
+  }
+
+  BKE_sequencer_prefetch_stop(scene);
+  BLI_mutex_end(&pfjob->prefetch_mutex);
+  BLI_condition_end(&pfjob->prefetch_cond);
+  MEM_freeN(pfjob);
+  scene->ed->prefetch_job = NULL;
+}
+
+bool BKE_sequencer_prefetch_is_running(Scene *scene)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  return (pfjob && pfjob->running);
+}
+
+Scene *BKE_sequencer_prefetch_get_original_scene(const SeqRenderData *context)
+{
+  Scene *scene = context->scene;
+
+  if (context->is_prefetch_render && scene->id.orig_id) {
+    return (Scene *)scene->id.orig_id;
+  }
+  return scene;
+}
+
+Sequence *BKE_sequencer_prefetch_get_original_sequence(Sequence *seq, Scene *scene)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (pfjob == NULL || pfjob->seq_map == NULL) {
+    return NULL;
+  }
+
+  return BLI_ghash_lookup(pfjob->seq_map, seq->name);
+}
@@ -3031,6 +3031,9 @@ static void step(Depsgraph *depsgraph,
 
   // printf("totalSubsteps: %d, maxVelMag: %f, dt: %f\n", totalSubsteps, maxVelMag, dt);
 
+  /* Respect the thread count set by the user (-t or render settings). */
+  smoke_set_thread_count(BLI_system_thread_count());
+
   for (substep = 0; substep < totalSubsteps; substep++) {
     // calc animated obstacle velocities
     update_flowsfluids(depsgraph, scene, ob, sds, dtSubdiv);
@@ -3318,6 +3321,7 @@ static void smokeModifier_process(
     smoke_calc_transparency(sds, DEG_get_evaluated_view_layer(depsgraph));
 
     if (sds->wt && sds->total_cells > 1) {
+      smoke_set_thread_count(BLI_system_thread_count());
       smoke_turbulence_step(sds->wt, sds->fluid);
     }
 
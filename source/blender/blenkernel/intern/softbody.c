@@ -59,7 +59,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
-#include "BLI_threads.h"
+#include "BLI_task.h"
 
 #include "BKE_collection.h"
 #include "BKE_collision.h"
@@ -123,20 +123,9 @@ typedef struct SBScratch {
   ReferenceState Ref;
 } SBScratch;
 
-typedef struct SB_thread_context {
-  Scene *scene;
-  Object *ob;
-  float forcetime;
-  float timenow;
-  int ifirst;
-  int ilast;
-  ListBase *effectors;
-  int do_deflector;
-  float fieldfactor;
-  float windfactor;
-  int nr;
-  int tot;
-} SB_thread_context;
+/* Only spread springs, points and faces over threads when there are more of them than this,
+ * to prevent pretty pointless threading overhead. */
+#define SB_PARALLEL_THRESHOLD 100
 
 #define MID_PRESERVE 1
 
@@ -1254,63 +1243,107 @@ static int sb_detect_face_collisionCached(float face_v1[3],
   return deflected;
 }
 
+typedef struct SBFaceForcesData {
+  Object *ob;
+  float timenow;
+  /* Collision result of each face, applied in order after the parallel detection. */
+  float (*feedback)[3];
+  float *damp;
+} SBFaceForcesData;
+
+static void sb_detect_face_forces_cb(void *__restrict userdata,
+                                     const int a,
+                                     const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  SBFaceForcesData *data = userdata;
+  Object *ob = data->ob;
+  SoftBody *sb = ob->soft;
+  BodyFace *bf = &sb->scratch->bodyface[a];
+
+  bf->ext_force[0] = bf->ext_force[1] = bf->ext_force[2] = 0.0f;
+  /*+++edges intruding*/
+  bf->flag &= ~BFF_INTERSECT;
+  zero_v3(data->feedback[a]);
+  data->damp[a] = 0.0f;
+  if (sb_detect_face_collisionCached(sb->bpoint[bf->v1].pos,
+                                     sb->bpoint[bf->v2].pos,
+                                     sb->bpoint[bf->v3].pos,
+                                     &data->damp[a],
+                                     data->feedback[a],
+                                     ob,
+                                     data->timenow)) {
+    bf->flag |= BFF_INTERSECT;
+  }
+  /*---edges intruding*/
+
+  /*+++ close vertices*/
+  if ((bf->flag & BFF_INTERSECT) == 0) {
+    bf->flag &= ~BFF_CLOSEVERT;
+    zero_v3(data->feedback[a]);
+    if (sb_detect_face_pointCached(sb->bpoint[bf->v1].pos,
+                                   sb->bpoint[bf->v2].pos,
+                                   sb->bpoint[bf->v3].pos,
+                                   &data->damp[a],
+                                   data->feedback[a],
+                                   ob,
+                                   data->timenow)) {
+      bf->flag |= BFF_CLOSEVERT;
+    }
+  }
+  /*--- close vertices*/
+}
+
 static void scan_for_ext_face_forces(Object *ob, float timenow)
 {
   SoftBody *sb = ob->soft;
   BodyFace *bf;
   int a;
-  float damp = 0.0f, choke = 1.0f;
+  float choke = 1.0f;
   float tune = -10.0f;
-  float feedback[3];
 
   if (sb && sb->scratch->totface) {
-
+    const int totface = sb->scratch->totface;
+
+    /* Collision queries only read the colliders and body points, do them in parallel. */
+    SBFaceForcesData data = {
+        .ob = ob,
+        .timenow = timenow,
+        .feedback = MEM_mallocN(sizeof(*data.feedback) * totface, __func__),
+        .damp = MEM_mallocN(sizeof(*data.damp) * totface, __func__),
+    };
+
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (totface > SB_PARALLEL_THRESHOLD);
+    BLI_task_parallel_range(0, totface, &data, sb_detect_face_forces_cb, &settings);
+
+    /* Faces share body points, so accumulate the forces in order. */
     bf = sb->scratch->bodyface;
-    for (a = 0; a < sb->scratch->totface; a++, bf++) {
-      bf->ext_force[0] = bf->ext_force[1] = bf->ext_force[2] = 0.0f;
-      /*+++edges intruding*/
-      bf->flag &= ~BFF_INTERSECT;
-      zero_v3(feedback);
-      if (sb_detect_face_collisionCached(sb->bpoint[bf->v1].pos,
-                                         sb->bpoint[bf->v2].pos,
-                                         sb->bpoint[bf->v3].pos,
-                                         &damp,
-                                         feedback,
-                                         ob,
-                                         timenow)) {
-        madd_v3_v3fl(sb->bpoint[bf->v1].force, feedback, tune);
-        madd_v3_v3fl(sb->bpoint[bf->v2].force, feedback, tune);
-        madd_v3_v3fl(sb->bpoint[bf->v3].force, feedback, tune);
+    for (a = 0; a < totface; a++, bf++) {
+      if (bf->flag & BFF_INTERSECT) {
+        madd_v3_v3fl(sb->bpoint[bf->v1].force, data.feedback[a], tune);
+        madd_v3_v3fl(sb->bpoint[bf->v2].force, data.feedback[a], tune);
+        madd_v3_v3fl(sb->bpoint[bf->v3].force, data.feedback[a], tune);
         //              madd_v3_v3fl(bf->ext_force, feedback, tune);
-        bf->flag |= BFF_INTERSECT;
-        choke = min_ff(max_ff(damp, choke), 1.0f);
+        choke = min_ff(max_ff(data.damp[a], choke), 1.0f);
       }
-      /*---edges intruding*/
-
-      /*+++ close vertices*/
-      if ((bf->flag & BFF_INTERSECT) == 0) {
-        bf->flag &= ~BFF_CLOSEVERT;
+      else {
         tune = -1.0f;
-        zero_v3(feedback);
-        if (sb_detect_face_pointCached(sb->bpoint[bf->v1].pos,
-                                       sb->bpoint[bf->v2].pos,
-                                       sb->bpoint[bf->v3].pos,
-                                       &damp,
-                                       feedback,
-                                       ob,
-                                       timenow)) {
-          madd_v3_v3fl(sb->bpoint[bf->v1].force, feedback, tune);
-          madd_v3_v3fl(sb->bpoint[bf->v2].force, feedback, tune);
-          madd_v3_v3fl(sb->bpoint[bf->v3].force, feedback, tune);
+        if (bf->flag & BFF_CLOSEVERT) {
+          madd_v3_v3fl(sb->bpoint[bf->v1].force, data.feedback[a], tune);
+          madd_v3_v3fl(sb->bpoint[bf->v2].force, data.feedback[a], tune);
+          madd_v3_v3fl(sb->bpoint[bf->v3].force, data.feedback[a], tune);
           //                  madd_v3_v3fl(bf->ext_force, feedback, tune);
-          bf->flag |= BFF_CLOSEVERT;
-          choke = min_ff(max_ff(damp, choke), 1.0f);
+          choke = min_ff(max_ff(data.damp[a], choke), 1.0f);
         }
       }
-      /*--- close vertices*/
     }
+
+    MEM_freeN(data.feedback);
+    MEM_freeN(data.damp);
+
     bf = sb->scratch->bodyface;
-    for (a = 0; a < sb->scratch->totface; a++, bf++) {
+    for (a = 0; a < totface; a++, bf++) {
       if ((bf->flag & BFF_INTERSECT) || (bf->flag & BFF_CLOSEVERT)) {
         sb->bpoint[bf->v1].choke2 = max_ff(sb->bpoint[bf->v1].choke2, choke);
         sb->bpoint[bf->v2].choke2 = max_ff(sb->bpoint[bf->v2].choke2, choke);
@@ -1510,12 +1543,19 @@ static void _scan_for_ext_spring_forces(
   }
 }
 
-static void *exec_scan_for_ext_spring_forces(void *data)
+typedef struct SBSpringForcesData {
+  Scene *scene;
+  Object *ob;
+  float timenow;
+  ListBase *effectors;
+} SBSpringForcesData;
+
+static void sb_scan_for_ext_spring_forces_cb(void *__restrict userdata,
+                                             const int i,
+                                             const ParallelRangeTLS *__restrict UNUSED(tls))
 {
-  SB_thread_context *pctx = (SB_thread_context *)data;
-  _scan_for_ext_spring_forces(
-      pctx->scene, pctx->ob, pctx->timenow, pctx->ifirst, pctx->ilast, pctx->effectors);
-  return NULL;
+  SBSpringForcesData *data = userdata;
+  _scan_for_ext_spring_forces(data->scene, data->ob, data->timenow, i, i + 1, data->effectors);
 }
 
 static void sb_sfesf_threads_run(struct Depsgraph *depsgraph,
@@ -1525,61 +1565,19 @@ static void sb_sfesf_threads_run(struct Depsgraph *depsgraph,
                                  int totsprings,
                                  int *UNUSED(ptr_to_break_func(void)))
 {
-  ListBase threads;
-  SB_thread_context *sb_threads;
-  int i, totthread, left, dec;
-
-  /* wild guess .. may increase with better thread management 'above'
-   * or even be UI option sb->spawn_cf_threads_nopts */
-  int lowsprings = 100;
-
   ListBase *effectors = BKE_effectors_create(depsgraph, ob, NULL, ob->soft->effector_weights);
 
-  /* figure the number of threads while preventing pretty pointless threading overhead */
-  totthread = BKE_scene_num_threads(scene);
-  /* what if we got zillions of CPUs running but less to spread*/
-  while ((totsprings / totthread < lowsprings) && (totthread > 1)) {
-    totthread--;
-  }
-
-  sb_threads = MEM_callocN(sizeof(SB_thread_context) * totthread, "SBSpringsThread");
-  memset(sb_threads, 0, sizeof(SB_thread_context) * totthread);
-  left = totsprings;
-  dec = totsprings / totthread + 1;
-  for (i = 0; i < totthread; i++) {
-    sb_threads[i].scene = scene;
-    sb_threads[i].ob = ob;
-    sb_threads[i].forcetime = 0.0;  // not used here
-    sb_threads[i].timenow = timenow;
-    sb_threads[i].ilast = left;
-    left = left - dec;
-    if (left > 0) {
-      sb_threads[i].ifirst = left;
-    }
-    else {
-      sb_threads[i].ifirst = 0;
-    }
-    sb_threads[i].effectors = effectors;
-    sb_threads[i].do_deflector = false;  // not used here
-    sb_threads[i].fieldfactor = 0.0f;    // not used here
-    sb_threads[i].windfactor = 0.0f;     // not used here
-    sb_threads[i].nr = i;
-    sb_threads[i].tot = totthread;
-  }
-  if (totthread > 1) {
-    BLI_threadpool_init(&threads, exec_scan_for_ext_spring_forces, totthread);
-
-    for (i = 0; i < totthread; i++) {
-      BLI_threadpool_insert(&threads, &sb_threads[i]);
-    }
+  SBSpringForcesData data = {
+      .scene = scene,
+      .ob = ob,
+      .timenow = timenow,
+      .effectors = effectors,
+  };
 
-    BLI_threadpool_end(&threads);
-  }
-  else {
-    exec_scan_for_ext_spring_forces(&sb_threads[0]);
-  }
-  /* clean up */
-  MEM_freeN(sb_threads);
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (totsprings > SB_PARALLEL_THRESHOLD);
+  BLI_task_parallel_range(0, totsprings, &data, sb_scan_for_ext_spring_forces_cb, &settings);
 
   BKE_effectors_free(effectors);
 }
@@ -1630,7 +1628,8 @@ static int sb_detect_vertex_collisionCached(float opco[3],
   GHash *hash;
   GHashIterator *ihash;
   float nv1[3], nv2[3], nv3[3], edge1[3], edge2[3], d_nvect[3], dv1[3], ve[3],
-      avel[3] = {0.0, 0.0, 0.0}, vv1[3], vv2[3], vv3[3], coledge[3] = {0.0f, 0.0f, 0.0f},
+      avel[3] = {0.0, 0.0, 0.0}, vv1[3] = {0.0f}, vv2[3] = {0.0f}, vv3[3] = {0.0f},
+      coledge[3] = {0.0f, 0.0f, 0.0f},
       mindistedge = 1000.0f, outerforceaccu[3], innerforceaccu[3], facedist,
       /* n_mag, */ /* UNUSED */ force_mag_norm, minx, miny, minz, maxx, maxy, maxz,
       innerfacethickness = -0.5f, outerfacethickness = 0.2f, ee = 5.0f, ff = 0.1f, fa = 1;
@@ -2171,21 +2170,33 @@ static int _softbody_calc_forces_slice_in_a_thread(Scene *scene,
   return 0; /*done fine*/
 }
 
-static void *exec_softbody_calc_forces(void *data)
-{
-  SB_thread_context *pctx = (SB_thread_context *)data;
-  _softbody_calc_forces_slice_in_a_thread(pctx->scene,
-                                          pctx->ob,
-                                          pctx->forcetime,
-                                          pctx->timenow,
-                                          pctx->ifirst,
-                                          pctx->ilast,
+typedef struct SBCalcForcesData {
+  Scene *scene;
+  Object *ob;
+  float forcetime;
+  float timenow;
+  ListBase *effectors;
+  int do_deflector;
+  float fieldfactor;
+  float windfactor;
+} SBCalcForcesData;
+
+static void sb_calc_forces_cb(void *__restrict userdata,
+                              const int i,
+                              const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  SBCalcForcesData *data = userdata;
+  _softbody_calc_forces_slice_in_a_thread(data->scene,
+                                          data->ob,
+                                          data->forcetime,
+                                          data->timenow,
+                                          i,
+                                          i + 1,
                                           NULL,
-                                          pctx->effectors,
-                                          pctx->do_deflector,
-                                          pctx->fieldfactor,
-                                          pctx->windfactor);
-  return NULL;
+                                          data->effectors,
+                                          data->do_deflector,
+                                          data->fieldfactor,
+                                          data->windfactor);
 }
 
 static void sb_cf_threads_run(Scene *scene,
@@ -2199,62 +2210,23 @@ static void sb_cf_threads_run(Scene *scene,
                               float fieldfactor,
                               float windfactor)
 {
-  ListBase threads;
-  SB_thread_context *sb_threads;
-  int i, totthread, left, dec;
-
-  /* wild guess .. may increase with better thread management 'above'
-   * or even be UI option sb->spawn_cf_threads_nopts. */
-  int lowpoints = 100;
-
-  /* figure the number of threads while preventing pretty pointless threading overhead */
-  totthread = BKE_scene_num_threads(scene);
-  /* what if we got zillions of CPUs running but less to spread*/
-  while ((totpoint / totthread < lowpoints) && (totthread > 1)) {
-    totthread--;
-  }
-
-  /* printf("sb_cf_threads_run spawning %d threads\n", totthread); */
-
-  sb_threads = MEM_callocN(sizeof(SB_thread_context) * totthread, "SBThread");
-  memset(sb_threads, 0, sizeof(SB_thread_context) * totthread);
-  left = totpoint;
-  dec = totpoint / totthread + 1;
-  for (i = 0; i < totthread; i++) {
-    sb_threads[i].scene = scene;
-    sb_threads[i].ob = ob;
-    sb_threads[i].forcetime = forcetime;
-    sb_threads[i].timenow = timenow;
-    sb_threads[i].ilast = left;
-    left = left - dec;
-    if (left > 0) {
-      sb_threads[i].ifirst = left;
-    }
-    else {
-      sb_threads[i].ifirst = 0;
-    }
-    sb_threads[i].effectors = effectors;
-    sb_threads[i].do_deflector = do_deflector;
-    sb_threads[i].fieldfactor = fieldfactor;
-    sb_threads[i].windfactor = windfactor;
-    sb_threads[i].nr = i;
-    sb_threads[i].tot = totthread;
-  }
-
-  if (totthread > 1) {
-    BLI_threadpool_init(&threads, exec_softbody_calc_forces, totthread);
-
-    for (i = 0; i < totthread; i++) {
-      BLI_threadpool_insert(&threads, &sb_threads[i]);
-    }
-
-    BLI_threadpool_end(&threads);
-  }
-  else {
-    exec_softbody_calc_forces(&sb_threads[0]);
-  }
-  /* clean up */
-  MEM_freeN(sb_threads);
+  SBCalcForcesData data = {
+      .scene = scene,
+      .ob = ob,
+      .forcetime = forcetime,
+      .timenow = timenow,
+      .effectors = effectors,
+      .do_deflector = do_deflector,
+      .fieldfactor = fieldfactor,
+      .windfactor = windfactor,
+  };
+
+  /* The cost per point varies a lot (self collision, colliders nearby),
+   * so rely on the task scheduler to balance the work between threads. */
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (totpoint > SB_PARALLEL_THRESHOLD);
+  BLI_task_parallel_range(0, totpoint, &data, sb_calc_forces_cb, &settings);
 }
 
 static void softbody_calc_forces(
@@ -2316,158 +2288,218 @@ static void softbody_calc_forces(
   BKE_effectors_free(effectors);
 }
 
-static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *err, int mid_flags)
-{
-  /* time evolution */
-  /* actually does an explicit euler step mode == 0 */
-  /* or heun ~ 2nd order runge-kutta steps, mode 1, 2 */
-  SoftBody *sb = ob->soft; /* is supposed to be there */
-  BodyPoint *bp;
-  float dx[3] = {0}, dv[3], aabbmin[3], aabbmax[3], cm[3] = {0.0f, 0.0f, 0.0f};
-  float timeovermass /*, freezeloc=0.00001f, freezeforce=0.00000000001f*/;
-  float maxerrpos = 0.0f, maxerrvel = 0.0f;
-  int a, fuzzy = 0;
-
-  forcetime *= sb_time_scale(ob);
+/* Per thread statistics, reduced in #sb_apply_forces_finalize. */
+typedef struct SBApplyForcesChunk {
+  float aabbmin[3], aabbmax[3];
+  float maxerrpos, maxerrvel;
+  int fuzzy;
+} SBApplyForcesChunk;
 
-  aabbmin[0] = aabbmin[1] = aabbmin[2] = 1e20f;
-  aabbmax[0] = aabbmax[1] = aabbmax[2] = -1e20f;
+typedef struct SBApplyForcesData {
+  Object *ob;
+  float forcetime;
+  int mode;
+  int mid_flags;
+  SBApplyForcesChunk result;
+} SBApplyForcesData;
+
+static void sb_apply_forces_cb(void *__restrict userdata,
+                               const int a,
+                               const ParallelRangeTLS *__restrict tls)
+{
+  SBApplyForcesData *data = userdata;
+  SBApplyForcesChunk *chunk = tls->userdata_chunk;
+  Object *ob = data->ob;
+  SoftBody *sb = ob->soft;
+  BodyPoint *bp = &sb->bpoint[a];
+  const float forcetime = data->forcetime;
+  const int mode = data->mode;
+  const int mid_flags = data->mid_flags;
+  float dx[3] = {0}, dv[3];
+  float timeovermass /*, freezeloc=0.00001f, freezeforce=0.00000000001f*/;
 
-  /* old one with homogeneous masses  */
+  /* Now we have individual masses. */
   /* claim a minimum mass for vertex */
-#if 0
-  if (sb->nodemass > 0.009999f)
-    timeovermass = forcetime / sb->nodemass;
-  else
+  if (_final_mass(ob, bp) > 0.009999f) {
+    timeovermass = forcetime / _final_mass(ob, bp);
+  }
+  else {
     timeovermass = forcetime / 0.009999f;
-#endif
+  }
 
-  for (a = sb->totpoint, bp = sb->bpoint; a > 0; a--, bp++) {
-    /* Now we have individual masses. */
-    /* claim a minimum mass for vertex */
-    if (_final_mass(ob, bp) > 0.009999f) {
-      timeovermass = forcetime / _final_mass(ob, bp);
+  if (_final_goal(ob, bp) < SOFTGOALSNAP) {
+    /* this makes t~ = t */
+    if (mid_flags & MID_PRESERVE) {
+      copy_v3_v3(dx, bp->vec);
+    }
+
+    /**
+     * So here is:
+     * <pre>
+     * (v)' = a(cceleration) =
+     *     sum(F_springs)/m + gravitation + some friction forces + more forces.
+     * </pre>
+     *
+     * The ( ... )' operator denotes derivate respective time.
+     *
+     * The euler step for velocity then becomes:
+     * <pre>
+     * v(t + dt) = v(t) + a(t) * dt
+     * </pre>
+     */
+    mul_v3_fl(bp->force, timeovermass); /* individual mass of node here */
+    /* some nasty if's to have heun in here too */
+    copy_v3_v3(dv, bp->force);
+
+    if (mode == 1) {
+      copy_v3_v3(bp->prevvec, bp->vec);
+      copy_v3_v3(bp->prevdv, dv);
+    }
+
+    if (mode == 2) {
+      /* be optimistic and execute step */
+      bp->vec[0] = bp->prevvec[0] + 0.5f * (dv[0] + bp->prevdv[0]);
+      bp->vec[1] = bp->prevvec[1] + 0.5f * (dv[1] + bp->prevdv[1]);
+      bp->vec[2] = bp->prevvec[2] + 0.5f * (dv[2] + bp->prevdv[2]);
+      /* compare euler to heun to estimate error for step sizing */
+      chunk->maxerrvel = max_ff(chunk->maxerrvel, fabsf(dv[0] - bp->prevdv[0]));
+      chunk->maxerrvel = max_ff(chunk->maxerrvel, fabsf(dv[1] - bp->prevdv[1]));
+      chunk->maxerrvel = max_ff(chunk->maxerrvel, fabsf(dv[2] - bp->prevdv[2]));
     }
     else {
-      timeovermass = forcetime / 0.009999f;
+      add_v3_v3(bp->vec, bp->force);
     }
 
-    if (_final_goal(ob, bp) < SOFTGOALSNAP) {
-      /* this makes t~ = t */
-      if (mid_flags & MID_PRESERVE) {
-        copy_v3_v3(dx, bp->vec);
-      }
+    /* this makes t~ = t+dt */
+    if (!(mid_flags & MID_PRESERVE)) {
+      copy_v3_v3(dx, bp->vec);
+    }
 
-      /**
-       * So here is:
-       * <pre>
-       * (v)' = a(cceleration) =
-       *     sum(F_springs)/m + gravitation + some friction forces + more forces.
-       * </pre>
-       *
-       * The ( ... )' operator denotes derivate respective time.
-       *
-       * The euler step for velocity then becomes:
-       * <pre>
-       * v(t + dt) = v(t) + a(t) * dt
-       * </pre>
-       */
-      mul_v3_fl(bp->force, timeovermass); /* individual mass of node here */
-      /* some nasty if's to have heun in here too */
-      copy_v3_v3(dv, bp->force);
-
-      if (mode == 1) {
-        copy_v3_v3(bp->prevvec, bp->vec);
-        copy_v3_v3(bp->prevdv, dv);
-      }
+    /* so here is (x)'= v(elocity) */
+    /* the euler step for location then becomes */
+    /* x(t + dt) = x(t) + v(t~) * dt */
+    mul_v3_fl(dx, forcetime);
 
-      if (mode == 2) {
-        /* be optimistic and execute step */
-        bp->vec[0] = bp->prevvec[0] + 0.5f * (dv[0] + bp->prevdv[0]);
-        bp->vec[1] = bp->prevvec[1] + 0.5f * (dv[1] + bp->prevdv[1]);
-        bp->vec[2] = bp->prevvec[2] + 0.5f * (dv[2] + bp->prevdv[2]);
-        /* compare euler to heun to estimate error for step sizing */
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[0] - bp->prevdv[0]));
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[1] - bp->prevdv[1]));
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[2] - bp->prevdv[2]));
+    /* the freezer coming sooner or later */
+#if 0
+    if ((dot_v3v3(dx, dx) < freezeloc) && (dot_v3v3(bp->force, bp->force) < freezeforce)) {
+      bp->frozen /= 2;
+    }
+    else {
+      bp->frozen = min_ff(bp->frozen * 1.05f, 1.0f);
+    }
+    mul_v3_fl(dx, bp->frozen);
+#endif
+    /* again some nasty if's to have heun in here too */
+    if (mode == 1) {
+      copy_v3_v3(bp->prevpos, bp->pos);
+      copy_v3_v3(bp->prevdx, dx);
+    }
+
+    if (mode == 2) {
+      bp->pos[0] = bp->prevpos[0] + 0.5f * (dx[0] + bp->prevdx[0]);
+      bp->pos[1] = bp->prevpos[1] + 0.5f * (dx[1] + bp->prevdx[1]);
+      bp->pos[2] = bp->prevpos[2] + 0.5f * (dx[2] + bp->prevdx[2]);
+      chunk->maxerrpos = max_ff(chunk->maxerrpos, fabsf(dx[0] - bp->prevdx[0]));
+      chunk->maxerrpos = max_ff(chunk->maxerrpos, fabsf(dx[1] - bp->prevdx[1]));
+      chunk->maxerrpos = max_ff(chunk->maxerrpos, fabsf(dx[2] - bp->prevdx[2]));
+
+      /* bp->choke is set when we need to pull a vertex or edge out of the collider.
+       * the collider object signals to get out by pushing hard. on the other hand
+       * we don't want to end up in deep space so we add some <viscosity>
+       * to balance that out */
+      if (bp->choke2 > 0.0f) {
+        mul_v3_fl(bp->vec, (1.0f - bp->choke2));
       }
-      else {
-        add_v3_v3(bp->vec, bp->force);
+      if (bp->choke > 0.0f) {
+        mul_v3_fl(bp->vec, (1.0f - bp->choke));
       }
+    }
+    else {
+      add_v3_v3(bp->pos, dx);
+    }
+  } /*snap*/
+  /* so while we are looping BPs anyway do statistics on the fly */
+  minmax_v3v3_v3(chunk->aabbmin, chunk->aabbmax, bp->pos);
+  if (bp->loc_flag & SBF_DOFUZZY) {
+    chunk->fuzzy = 1;
+  }
+}
 
-      /* this makes t~ = t+dt */
-      if (!(mid_flags & MID_PRESERVE)) {
-        copy_v3_v3(dx, bp->vec);
-      }
+static void sb_apply_forces_finalize(void *__restrict userdata, void *__restrict userdata_chunk)
+{
+  SBApplyForcesData *data = userdata;
+  SBApplyForcesChunk *result = &data->result;
+  SBApplyForcesChunk *chunk = userdata_chunk;
+
+  DO_MIN(chunk->aabbmin, result->aabbmin);
+  DO_MAX(chunk->aabbmax, result->aabbmax);
+  result->maxerrpos = max_ff(result->maxerrpos, chunk->maxerrpos);
+  result->maxerrvel = max_ff(result->maxerrvel, chunk->maxerrvel);
+  result->fuzzy |= chunk->fuzzy;
+}
+
+static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *err, int mid_flags)
+{
+  /* time evolution */
+  /* actually does an explicit euler step mode == 0 */
+  /* or heun ~ 2nd order runge-kutta steps, mode 1, 2 */
+  SoftBody *sb = ob->soft; /* is supposed to be there */
+  float cm[3] = {0.0f, 0.0f, 0.0f};
+  SBApplyForcesChunk chunk;
+
+  forcetime *= sb_time_scale(ob);
 
-      /* so here is (x)'= v(elocity) */
-      /* the euler step for location then becomes */
-      /* x(t + dt) = x(t) + v(t~) * dt */
-      mul_v3_fl(dx, forcetime);
+  chunk.aabbmin[0] = chunk.aabbmin[1] = chunk.aabbmin[2] = 1e20f;
+  chunk.aabbmax[0] = chunk.aabbmax[1] = chunk.aabbmax[2] = -1e20f;
+  chunk.maxerrpos = chunk.maxerrvel = 0.0f;
+  chunk.fuzzy = 0;
 
-      /* the freezer coming sooner or later */
+  /* old one with homogeneous masses  */
+  /* claim a minimum mass for vertex */
 #if 0
-      if ((dot_v3v3(dx, dx) < freezeloc) && (dot_v3v3(bp->force, bp->force) < freezeforce)) {
-        bp->frozen /= 2;
-      }
-      else {
-        bp->frozen = min_ff(bp->frozen * 1.05f, 1.0f);
-      }
-      mul_v3_fl(dx, bp->frozen);
+  if (sb->nodemass > 0.009999f)
+    timeovermass = forcetime / sb->nodemass;
+  else
+    timeovermass = forcetime / 0.009999f;
 #endif
-      /* again some nasty if's to have heun in here too */
-      if (mode == 1) {
-        copy_v3_v3(bp->prevpos, bp->pos);
-        copy_v3_v3(bp->prevdx, dx);
-      }
 
-      if (mode == 2) {
-        bp->pos[0] = bp->prevpos[0] + 0.5f * (dx[0] + bp->prevdx[0]);
-        bp->pos[1] = bp->prevpos[1] + 0.5f * (dx[1] + bp->prevdx[1]);
-        bp->pos[2] = bp->prevpos[2] + 0.5f * (dx[2] + bp->prevdx[2]);
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[0] - bp->prevdx[0]));
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[1] - bp->prevdx[1]));
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[2] - bp->prevdx[2]));
-
-        /* bp->choke is set when we need to pull a vertex or edge out of the collider.
-         * the collider object signals to get out by pushing hard. on the other hand
-         * we don't want to end up in deep space so we add some <viscosity>
-         * to balance that out */
-        if (bp->choke2 > 0.0f) {
-          mul_v3_fl(bp->vec, (1.0f - bp->choke2));
-        }
-        if (bp->choke > 0.0f) {
-          mul_v3_fl(bp->vec, (1.0f - bp->choke));
-        }
-      }
-      else {
-        add_v3_v3(bp->pos, dx);
-      }
-    } /*snap*/
-    /* so while we are looping BPs anyway do statistics on the fly */
-    minmax_v3v3_v3(aabbmin, aabbmax, bp->pos);
-    if (bp->loc_flag & SBF_DOFUZZY) {
-      fuzzy = 1;
-    }
-  } /*for*/
+  SBApplyForcesData data = {
+      .ob = ob,
+      .forcetime = forcetime,
+      .mode = mode,
+      .mid_flags = mid_flags,
+      .result = chunk,
+  };
+
+  /* Each point is integrated independently, the statistics are gathered per thread. */
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (sb->totpoint > SB_PARALLEL_THRESHOLD);
+  settings.userdata_chunk = &chunk;
+  settings.userdata_chunk_size = sizeof(chunk);
+  settings.func_finalize = sb_apply_forces_finalize;
+  BLI_task_parallel_range(0, sb->totpoint, &data, sb_apply_forces_cb, &settings);
+
+  const SBApplyForcesChunk result = data.result;
 
   if (sb->totpoint) {
     mul_v3_fl(cm, 1.0f / sb->totpoint);
   }
   if (sb->scratch) {
-    copy_v3_v3(sb->scratch->aabbmin, aabbmin);
-    copy_v3_v3(sb->scratch->aabbmax, aabbmax);
+    copy_v3_v3(sb->scratch->aabbmin, result.aabbmin);
+    copy_v3_v3(sb->scratch->aabbmax, result.aabbmax);
   }
 
   if (err) { /* so step size will be controlled by biggest difference in slope */
     if (sb->solverflags & SBSO_OLDERR) {
-      *err = max_ff(maxerrpos, maxerrvel);
+      *err = max_ff(result.maxerrpos, result.maxerrvel);
     }
     else {
-      *err = maxerrpos;
+      *err = result.maxerrpos;
     }
     // printf("EP %f EV %f\n", maxerrpos, maxerrvel);
-    if (fuzzy) {
+    if (result.fuzzy) {
       *err /= sb->fuzzyness;
     }
   }
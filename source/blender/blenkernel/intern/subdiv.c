@@ -23,11 +23,16 @@
 
 #include "BKE_subdiv.h"
 
+#include <string.h>
+
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
 
 #include "BLI_utildefines.h"
+#include "BLI_hash_mm2a.h"
+
+#include "BKE_customdata.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -160,23 +165,102 @@ Subdiv *BKE_subdiv_update_from_converter(Subdiv *subdiv,
     can_reuse_subdiv = false;
   }
   if (can_reuse_subdiv) {
+    subdiv->stats.num_topology_cache_hits++;
     return subdiv;
   }
-  /* Create new subdiv. */
+  /* Create new subdiv, keeping the cache statistics of the old one. */
+  int num_topology_cache_hits = 0, num_topology_cache_misses = 0;
   if (subdiv != NULL) {
+    num_topology_cache_hits = subdiv->stats.num_topology_cache_hits;
+    num_topology_cache_misses = subdiv->stats.num_topology_cache_misses;
     BKE_subdiv_free(subdiv);
   }
-  return BKE_subdiv_new_from_converter(settings, converter);
+  subdiv = BKE_subdiv_new_from_converter(settings, converter);
+  subdiv->stats.num_topology_cache_hits = num_topology_cache_hits;
+  subdiv->stats.num_topology_cache_misses = num_topology_cache_misses + 1;
+  return subdiv;
+}
+
+/* Hash of everything the mesh converter passes to OpenSubdiv, except vertex
+ * positions. Element counts and loops are part of the hash, and are also
+ * compared exactly by the caller. */
+static unsigned int subdiv_topology_hash_from_mesh(const SubdivSettings *settings,
+                                                   const Mesh *mesh)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totedge);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totloop);
+  for (int edge_index = 0; edge_index < mesh->totedge; edge_index++) {
+    const MEdge *edge = &mesh->medge[edge_index];
+    BLI_hash_mm2a_add_int(&mm2, (int)edge->v1);
+    BLI_hash_mm2a_add_int(&mm2, (int)edge->v2);
+    if (settings->use_creases) {
+      BLI_hash_mm2a_add_int(&mm2, edge->crease);
+    }
+  }
+  for (int poly_index = 0; poly_index < mesh->totpoly; poly_index++) {
+    BLI_hash_mm2a_add_int(&mm2, mesh->mpoly[poly_index].totloop);
+  }
+  for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+    BLI_hash_mm2a_add_int(&mm2, (int)mesh->mloop[loop_index].v);
+    BLI_hash_mm2a_add_int(&mm2, (int)mesh->mloop[loop_index].e);
+  }
+  /* UV coordinates define face-varying topology. */
+  const int num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  BLI_hash_mm2a_add_int(&mm2, num_uv_layers);
+  for (int layer_index = 0; layer_index < num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+      BLI_hash_mm2a_add(&mm2, (const unsigned char *)mloopuv[loop_index].uv, sizeof(float[2]));
+    }
+  }
+  const unsigned int hash = BLI_hash_mm2a_end(&mm2);
+  /* Zero is reserved for unknown topology. */
+  return (hash != 0) ? hash : 1;
 }
 
 Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
                                     const SubdivSettings *settings,
                                     const Mesh *mesh)
 {
+  unsigned int topology_hash = 0;
+  /* Cheap check for the common case of a deforming mesh, which avoids building
+   * the converter and comparing its topology with the refiner. */
+  if (subdiv != NULL && subdiv->topology_refiner != NULL &&
+      BKE_subdiv_settings_equal(&subdiv->settings, settings)) {
+    BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_COMPARE);
+    topology_hash = subdiv_topology_hash_from_mesh(settings, mesh);
+    const bool is_topology_equal = topology_hash == subdiv->topology_hash &&
+                                   mesh->totvert == subdiv->topology_totvert &&
+                                   mesh->totedge == subdiv->topology_totedge &&
+                                   mesh->totpoly == subdiv->topology_totpoly &&
+                                   mesh->totloop == subdiv->topology_totloop &&
+                                   memcmp(mesh->mloop,
+                                          subdiv->topology_mloop,
+                                          sizeof(MLoop) * (size_t)mesh->totloop) == 0;
+    BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_COMPARE);
+    if (is_topology_equal) {
+      subdiv->stats.num_topology_cache_hits++;
+      return subdiv;
+    }
+  }
   OpenSubdiv_Converter converter;
   BKE_subdiv_converter_init_for_mesh(&converter, settings, mesh);
   subdiv = BKE_subdiv_update_from_converter(subdiv, settings, &converter);
   BKE_subdiv_converter_free(&converter);
+  subdiv->topology_hash = (topology_hash != 0) ? topology_hash :
+                                                 subdiv_topology_hash_from_mesh(settings, mesh);
+  subdiv->topology_totvert = mesh->totvert;
+  subdiv->topology_totedge = mesh->totedge;
+  subdiv->topology_totpoly = mesh->totpoly;
+  subdiv->topology_totloop = mesh->totloop;
+  MEM_SAFE_FREE(subdiv->topology_mloop);
+  subdiv->topology_mloop = MEM_malloc_arrayN(
+      MAX2(mesh->totloop, 1), sizeof(MLoop), "subdiv topology mloop");
+  memcpy(subdiv->topology_mloop, mesh->mloop, sizeof(MLoop) * (size_t)mesh->totloop);
   return subdiv;
 }
 
@@ -191,6 +275,9 @@ void BKE_subdiv_free(Subdiv *subdiv)
     openSubdiv_deleteTopologyRefiner(subdiv->topology_refiner);
   }
   BKE_subdiv_displacement_detach(subdiv);
+  if (subdiv->topology_mloop != NULL) {
+    MEM_freeN(subdiv->topology_mloop);
+  }
   if (subdiv->cache_.face_ptex_offset != NULL) {
     MEM_freeN(subdiv->cache_.face_ptex_offset);
   }
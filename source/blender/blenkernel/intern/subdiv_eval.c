@@ -23,6 +23,8 @@
 
 #include "BKE_subdiv_eval.h"
 
+#include <stddef.h>
+
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
@@ -78,14 +80,26 @@ static void set_coarse_positions(Subdiv *subdiv, const Mesh *mesh)
       BLI_BITMAP_ENABLE(vertex_used_map, loop->v);
     }
   }
-  for (int vertex_index = 0, manifold_veretx_index = 0; vertex_index < mesh->totvert;
-       vertex_index++) {
+  /* Pass runs of used vertices straight from the MVert array, instead of one vertex at a time.
+   * Without loose vertices this is a single call for the whole mesh. */
+  int manifold_vertex_index = 0;
+  for (int vertex_index = 0; vertex_index < mesh->totvert;) {
     if (!BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
+      vertex_index++;
       continue;
     }
-    const MVert *vertex = &mvert[vertex_index];
-    subdiv->evaluator->setCoarsePositions(subdiv->evaluator, vertex->co, manifold_veretx_index, 1);
-    manifold_veretx_index++;
+    const int run_start = vertex_index;
+    while (vertex_index < mesh->totvert && BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
+      vertex_index++;
+    }
+    const int run_len = vertex_index - run_start;
+    subdiv->evaluator->setCoarsePositionsFromBuffer(subdiv->evaluator,
+                                                    &mvert[run_start],
+                                                    offsetof(MVert, co),
+                                                    sizeof(MVert),
+                                                    manifold_vertex_index,
+                                                    run_len);
+    manifold_vertex_index += run_len;
   }
   MEM_freeN(vertex_used_map);
 }
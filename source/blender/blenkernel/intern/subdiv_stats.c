@@ -37,6 +37,8 @@ void BKE_subdiv_stats_init(SubdivStats *stats)
   stats->subdiv_to_ccg_time = 0.0;
   stats->subdiv_to_ccg_elements_time = 0.0;
   stats->topology_compare_time = 0.0;
+  stats->num_topology_cache_hits = 0;
+  stats->num_topology_cache_misses = 0;
 }
 
 void BKE_subdiv_stats_begin(SubdivStats *stats, eSubdivStatsValue value)
@@ -74,5 +76,14 @@ void BKE_subdiv_stats_print(const SubdivStats *stats)
   STATS_PRINT_TIME(stats, subdiv_to_ccg_elements_time, "    Elements time");
   STATS_PRINT_TIME(stats, topology_compare_time, "Topology comparison time");
 
+  const int num_topology_updates = stats->num_topology_cache_hits +
+                                   stats->num_topology_cache_misses;
+  if (num_topology_updates > 0) {
+    printf("  Topology cache: %d hits, %d misses (%.1f%% hit rate)\n",
+           stats->num_topology_cache_hits,
+           stats->num_topology_cache_misses,
+           100.0 * stats->num_topology_cache_hits / num_topology_updates);
+  }
+
 #undef STATS_PRINT_TIME
 }
@@ -53,6 +53,17 @@ int BLI_kdtree_nd_(range_search)(const KDTree *tree,
                                  KDTreeNearest **r_nearest,
                                  const float range) ATTR_NONNULL(1, 2) ATTR_WARN_UNUSED_RESULT;
 
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const unsigned int co_len,
+                                        KDTreeNearest *r_nearest) ATTR_NONNULL(1, 2, 4);
+void BLI_kdtree_nd_(range_search_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const unsigned int co_len,
+                                        const float range,
+                                        KDTreeNearest **r_nearest,
+                                        int *r_found) ATTR_NONNULL(1, 2, 5, 6);
+
 int BLI_kdtree_nd_(find_nearest_cb)(
     const KDTree *tree,
     const float co[KD_DIMS],
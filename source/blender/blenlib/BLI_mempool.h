@@ -58,6 +58,23 @@ void *BLI_mempool_as_arrayN(BLI_mempool *pool,
                             const char *allocstr) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
     ATTR_NONNULL(1, 2);
 
+/** Thread local allocation cache, see #BLI_mempool_local_init. */
+typedef struct BLI_mempool_local {
+  BLI_mempool *pool;
+  /** Private free list (#BLI_freenode). */
+  void *free;
+  /** Elements allocated minus elements freed, added to the pool on finalize. */
+  int totused;
+} BLI_mempool_local;
+
+void BLI_mempool_local_init(BLI_mempool *pool, BLI_mempool_local *local) ATTR_NONNULL();
+void *BLI_mempool_local_alloc(BLI_mempool_local *local) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_NONNULL(1);
+void *BLI_mempool_local_calloc(BLI_mempool_local *local) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_NONNULL(1);
+void BLI_mempool_local_free(BLI_mempool_local *local, void *addr) ATTR_NONNULL(1, 2);
+void BLI_mempool_local_finalize(BLI_mempool_local *local) ATTR_NONNULL();
+
 #ifndef NDEBUG
 void BLI_mempool_set_memory_debug(void);
 #endif
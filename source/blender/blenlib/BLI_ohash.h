@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __BLI_OHASH_H__
+#define __BLI_OHASH_H__
+
+/** \file
+ * \ingroup bli
+ *
+ * OHash is an open-addressing hash-map (unordered key, value pairs),
+ * with the same callbacks and semantics as #GHash.
+ *
+ * Entries are stored densely without per-entry allocation and slots are probed
+ * 16 at a time using one metadata byte per slot, which makes lookups and resizing
+ * much more cache friendly than the chained #GHash.
+ *
+ * Migrating from #GHash is a matter of replacing the `BLI_ghash_` prefix with `BLI_ohash_`
+ * (and `BLI_gset_` with `BLI_oset_`), with these differences:
+ *
+ * - Pointers returned by #BLI_ohash_lookup_p and #BLI_ohash_ensure_p
+ *   are only valid until the next insertion or removal.
+ * - Removing items while iterating is not supported.
+ * - Clearing keeps the allocated capacity.
+ *
+ * This is also used to implement a 'set' (see #OSet below).
+ */
+
+#include "BLI_compiler_attrs.h"
+#include "BLI_ghash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct OHash OHash;
+
+typedef struct OHashIterator {
+  struct OHashEntry *curEntry;
+  struct OHashEntry *endEntry;
+} OHashIterator;
+
+/** \name OHash API
+ *
+ * Defined in ``BLI_ohash.c``
+ * \{ */
+
+OHash *BLI_ohash_new_ex(GHashHashFP hashfp,
+                        GHashCmpFP cmpfp,
+                        const char *info,
+                        const unsigned int nentries_reserve) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_new(GHashHashFP hashfp,
+                     GHashCmpFP cmpfp,
+                     const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void BLI_ohash_free(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+void BLI_ohash_reserve(OHash *oh, const unsigned int nentries_reserve);
+void BLI_ohash_insert(OHash *oh, void *key, void *val);
+bool BLI_ohash_reinsert(
+    OHash *oh, void *key, void *val, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+void *BLI_ohash_lookup(OHash *oh, const void *key) ATTR_WARN_UNUSED_RESULT;
+void *BLI_ohash_lookup_default(OHash *oh,
+                               const void *key,
+                               void *val_default) ATTR_WARN_UNUSED_RESULT;
+void **BLI_ohash_lookup_p(OHash *oh, const void *key) ATTR_WARN_UNUSED_RESULT;
+bool BLI_ohash_ensure_p(OHash *oh, void *key, void ***r_val) ATTR_WARN_UNUSED_RESULT;
+bool BLI_ohash_remove(OHash *oh,
+                      const void *key,
+                      GHashKeyFreeFP keyfreefp,
+                      GHashValFreeFP valfreefp);
+void *BLI_ohash_popkey(OHash *oh,
+                       const void *key,
+                       GHashKeyFreeFP keyfreefp) ATTR_WARN_UNUSED_RESULT;
+bool BLI_ohash_haskey(OHash *oh, const void *key) ATTR_WARN_UNUSED_RESULT;
+void BLI_ohash_clear(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+unsigned int BLI_ohash_len(OHash *oh) ATTR_WARN_UNUSED_RESULT;
+
+OHash *BLI_ohash_ptr_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_str_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_int_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+
+/** \} */
+
+/** \name OHash Iterator
+ * \{ */
+
+void BLI_ohashIterator_init(OHashIterator *ohi, OHash *oh);
+
+BLI_INLINE void BLI_ohashIterator_step(OHashIterator *ohi);
+BLI_INLINE void *BLI_ohashIterator_getKey(OHashIterator *ohi) ATTR_WARN_UNUSED_RESULT;
+BLI_INLINE void *BLI_ohashIterator_getValue(OHashIterator *ohi) ATTR_WARN_UNUSED_RESULT;
+BLI_INLINE void **BLI_ohashIterator_getValue_p(OHashIterator *ohi) ATTR_WARN_UNUSED_RESULT;
+BLI_INLINE bool BLI_ohashIterator_done(OHashIterator *ohi) ATTR_WARN_UNUSED_RESULT;
+
+/* Must match the layout of #OHashEntry. */
+struct _oh_Entry {
+  void *key, *val;
+  unsigned int hash;
+};
+BLI_INLINE void BLI_ohashIterator_step(OHashIterator *ohi)
+{
+  ohi->curEntry = (struct OHashEntry *)(((struct _oh_Entry *)ohi->curEntry) + 1);
+}
+BLI_INLINE void *BLI_ohashIterator_getKey(OHashIterator *ohi)
+{
+  return ((struct _oh_Entry *)ohi->curEntry)->key;
+}
+BLI_INLINE void *BLI_ohashIterator_getValue(OHashIterator *ohi)
+{
+  return ((struct _oh_Entry *)ohi->curEntry)->val;
+}
+BLI_INLINE void **BLI_ohashIterator_getValue_p(OHashIterator *ohi)
+{
+  return &((struct _oh_Entry *)ohi->curEntry)->val;
+}
+BLI_INLINE bool BLI_ohashIterator_done(OHashIterator *ohi)
+{
+  return ohi->curEntry == ohi->endEntry;
+}
+/* disallow further access */
+#ifdef __GNUC__
+#  pragma GCC poison _oh_Entry
+#else
+#  define _oh_Entry void
+#endif
+
+#define OHASH_ITER(oh_iter_, ohash_) \
+  for (BLI_ohashIterator_init(&oh_iter_, ohash_); BLI_ohashIterator_done(&oh_iter_) == false; \
+       BLI_ohashIterator_step(&oh_iter_))
+
+/** \} */
+
+/** \name OSet API
+ * A 'set' implementation (unordered collection of unique elements).
+ *
+ * Internally this is an 'OHash' without any values.
+ * \{ */
+
+typedef struct OSet OSet;
+
+OSet *BLI_oset_new_ex(GSetHashFP hashfp,
+                      GSetCmpFP cmpfp,
+                      const char *info,
+                      const unsigned int nentries_reserve) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OSet *BLI_oset_new(GSetHashFP hashfp,
+                   GSetCmpFP cmpfp,
+                   const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+unsigned int BLI_oset_len(OSet *os) ATTR_WARN_UNUSED_RESULT;
+void BLI_oset_free(OSet *os, GSetKeyFreeFP keyfreefp);
+void BLI_oset_insert(OSet *os, void *key);
+bool BLI_oset_add(OSet *os, void *key);
+bool BLI_oset_haskey(OSet *os, const void *key) ATTR_WARN_UNUSED_RESULT;
+bool BLI_oset_remove(OSet *os, const void *key, GSetKeyFreeFP keyfreefp);
+void BLI_oset_clear(OSet *os, GSetKeyFreeFP keyfreefp);
+
+OSet *BLI_oset_ptr_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OSet *BLI_oset_str_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+
+/** \} */
+
+/** \name OSet Iterator
+ * \{ */
+
+typedef struct OSetIterator {
+  OHashIterator _ohi
+#ifdef __GNUC__
+      __attribute__((deprecated))
+#endif
+      ;
+} OSetIterator;
+
+BLI_INLINE void BLI_osetIterator_init(OSetIterator *osi, OSet *os)
+{
+  BLI_ohashIterator_init((OHashIterator *)osi, (OHash *)os);
+}
+BLI_INLINE void *BLI_osetIterator_getKey(OSetIterator *osi)
+{
+  return BLI_ohashIterator_getKey((OHashIterator *)osi);
+}
+BLI_INLINE void BLI_osetIterator_step(OSetIterator *osi)
+{
+  BLI_ohashIterator_step((OHashIterator *)osi);
+}
+BLI_INLINE bool BLI_osetIterator_done(OSetIterator *osi)
+{
+  return BLI_ohashIterator_done((OHashIterator *)osi);
+}
+
+#define OSET_ITER(os_iter_, oset_) \
+  for (BLI_osetIterator_init(&os_iter_, oset_); BLI_osetIterator_done(&os_iter_) == false; \
+       BLI_osetIterator_step(&os_iter_))
+
+/** \} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BLI_OHASH_H__ */
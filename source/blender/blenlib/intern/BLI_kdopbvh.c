@@ -52,6 +52,10 @@
 
 #include "BLI_strict_flags.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /* used for iterative_raycast */
 // #define USE_SKIP_LINKS
 
@@ -72,6 +76,15 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Number of leafs a branch must contain for its bounds to be computed in parallel
+ * while building the tree (only happens for the first few levels). */
+#define KDOPBVH_REFIT_PARALLEL_CHUNK 4096
+
+/* Maximum number of sub-trees #BLI_bvhtree_overlap splits the first tree into,
+ * the root children alone are too few tasks to keep all threads busy. */
+#define KDOPBVH_OVERLAP_TASKS_MAX 64
+BLI_STATIC_ASSERT(KDOPBVH_OVERLAP_TASKS_MAX >= MAX_TREETYPE, "too few overlap tasks")
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -112,6 +125,8 @@ BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
 /* avoid duplicating vars in BVHOverlapData_Thread */
 typedef struct BVHOverlapData_Shared {
   const BVHTree *tree1, *tree2;
+  /* Sub-trees of tree1, one per task. */
+  const BVHNode **roots;
   axis_t start_axis, stop_axis;
 
   /* use for callbacks */
@@ -401,6 +416,80 @@ static void refit_kdop_hull(const BVHTree *tree, BVHNode *node, int start, int e
   }
 }
 
+typedef struct BVHRefitData {
+  const BVHTree *tree;
+  float *bv;
+  int start, end;
+} BVHRefitData;
+
+static void refit_kdop_hull_task_cb(void *__restrict userdata,
+                                    const int chunk_index,
+                                    const ParallelRangeTLS *__restrict tls)
+{
+  const BVHRefitData *data = userdata;
+  const BVHTree *tree = data->tree;
+  float *__restrict bv = tls->userdata_chunk;
+  const int start = data->start + chunk_index * KDOPBVH_REFIT_PARALLEL_CHUNK;
+  const int end = min_ii(start + KDOPBVH_REFIT_PARALLEL_CHUNK, data->end);
+  axis_t axis_iter;
+
+  for (int j = start; j < end; j++) {
+    const float *__restrict node_bv = tree->nodes[j]->bv;
+    for (axis_iter = tree->start_axis; axis_iter < tree->stop_axis; axis_iter++) {
+      bv[(2 * axis_iter)] = min_ff(bv[(2 * axis_iter)], node_bv[(2 * axis_iter)]);
+      bv[(2 * axis_iter) + 1] = max_ff(bv[(2 * axis_iter) + 1], node_bv[(2 * axis_iter) + 1]);
+    }
+  }
+}
+
+static void refit_kdop_hull_finalize(void *__restrict userdata, void *__restrict userdata_chunk)
+{
+  const BVHRefitData *data = userdata;
+  const BVHTree *tree = data->tree;
+  const float *chunk_bv = userdata_chunk;
+  axis_t axis_iter;
+
+  for (axis_iter = tree->start_axis; axis_iter < tree->stop_axis; axis_iter++) {
+    data->bv[(2 * axis_iter)] = min_ff(data->bv[(2 * axis_iter)], chunk_bv[(2 * axis_iter)]);
+    data->bv[(2 * axis_iter) + 1] = max_ff(data->bv[(2 * axis_iter) + 1],
+                                           chunk_bv[(2 * axis_iter) + 1]);
+  }
+}
+
+/**
+ * Same as #refit_kdop_hull, splitting big ranges of leafs across threads.
+ * The top levels of the tree are built by very few tasks, this avoids them
+ * being the bottleneck of the whole build.
+ */
+static void refit_kdop_hull_parallel(const BVHTree *tree, BVHNode *node, int start, int end)
+{
+  if (end - start <= 2 * KDOPBVH_REFIT_PARALLEL_CHUNK) {
+    refit_kdop_hull(tree, node, start, end);
+    return;
+  }
+
+  node_minmax_init(tree, node);
+
+  float bv_chunk[26];
+  memcpy(bv_chunk, node->bv, sizeof(*bv_chunk) * (size_t)(2 * tree->stop_axis));
+
+  BVHRefitData data = {
+      .tree = tree,
+      .bv = node->bv,
+      .start = start,
+      .end = end,
+  };
+
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = bv_chunk;
+  settings.userdata_chunk_size = sizeof(bv_chunk);
+  settings.func_finalize = refit_kdop_hull_finalize;
+  const int chunks_num = (end - start + KDOPBVH_REFIT_PARALLEL_CHUNK - 1) /
+                         KDOPBVH_REFIT_PARALLEL_CHUNK;
+  BLI_task_parallel_range(0, chunks_num, &data, refit_kdop_hull_task_cb, &settings);
+}
+
 /**
  * only supports x,y,z axis in the moment
  * but we should use a plain and simple function here for speed sake */
@@ -713,7 +802,7 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
 
   /* This calculates the bounding box of this branch
    * and chooses the largest axis as the axis to divide leafs */
-  refit_kdop_hull(data->tree, parent, parent_leafs_begin, parent_leafs_end);
+  refit_kdop_hull_parallel(data->tree, parent, parent_leafs_begin, parent_leafs_end);
   split_axis = get_largest_axis(parent->bv);
 
   /* Save split axis (this can be used on raytracing to speedup the query time) */
@@ -1083,6 +1172,21 @@ static bool tree_overlap_test(const BVHNode *node1,
   const float *bv2 = node2->bv + (start_axis << 1);
   const float *bv1_end = node1->bv + (stop_axis << 1);
 
+#ifdef __SSE2__
+  /* Test two axes at once, comparing (min1, max1) with the swapped (max2, min2). */
+  for (; bv1_end - bv1 >= 4; bv1 += 4, bv2 += 4) {
+    const __m128 a = _mm_loadu_ps(bv1);
+    const __m128 b = _mm_loadu_ps(bv2);
+    const __m128 b_swap = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+    /* Even lanes: min1 > max2, odd lanes: max1 < min2. */
+    const int separated = (_mm_movemask_ps(_mm_cmpgt_ps(a, b_swap)) & 0x5) |
+                          (_mm_movemask_ps(_mm_cmplt_ps(a, b_swap)) & 0xA);
+    if (separated) {
+      return 0;
+    }
+  }
+#endif
+
   /* test all axis if min + max overlap */
   for (; bv1 != bv1_end; bv1 += 2, bv2 += 2) {
     if ((bv1[0] > bv2[1]) || (bv2[0] > bv1[1])) {
@@ -1181,6 +1285,57 @@ static void tree_overlap_traverse_cb(BVHOverlapData_Thread *data_thread,
   }
 }
 
+/**
+ * Split \a tree into the sub-trees traversed by each #BLI_bvhtree_overlap task.
+ *
+ * Starts with the root children, then replaces all branches by their children
+ * for as long as the result fits in #KDOPBVH_OVERLAP_TASKS_MAX.
+ * Order is kept, so the sub-trees are still sorted the same way as the leafs.
+ */
+static int bvhtree_overlap_roots(const BVHTree *tree,
+                                 const BVHNode *r_roots[KDOPBVH_OVERLAP_TASKS_MAX])
+{
+  const BVHNode *root = tree->nodes[tree->totleaf];
+  int roots_len = 0;
+  int j, k;
+
+  for (j = 0; j < root->totnode; j++) {
+    r_roots[roots_len++] = root->children[j];
+  }
+
+  if (tree->totleaf <= KDOPBVH_THREAD_LEAF_THRESHOLD) {
+    return roots_len;
+  }
+
+  while (true) {
+    int roots_len_next = 0;
+    for (j = 0; j < roots_len; j++) {
+      roots_len_next += max_ii(r_roots[j]->totnode, 1);
+    }
+    if (roots_len_next == roots_len || roots_len_next > KDOPBVH_OVERLAP_TASKS_MAX) {
+      break;
+    }
+
+    const BVHNode *roots_next[KDOPBVH_OVERLAP_TASKS_MAX];
+    roots_len_next = 0;
+    for (j = 0; j < roots_len; j++) {
+      const BVHNode *node = r_roots[j];
+      if (node->totnode) {
+        for (k = 0; k < node->totnode; k++) {
+          roots_next[roots_len_next++] = node->children[k];
+        }
+      }
+      else {
+        roots_next[roots_len_next++] = node;
+      }
+    }
+    memcpy(r_roots, roots_next, sizeof(*r_roots) * (size_t)roots_len_next);
+    roots_len = roots_len_next;
+  }
+
+  return roots_len;
+}
+
 /**
  * Use to check the total number of threads #BLI_bvhtree_overlap will use.
  *
@@ -1188,7 +1343,8 @@ static void tree_overlap_traverse_cb(BVHOverlapData_Thread *data_thread,
  */
 int BLI_bvhtree_overlap_thread_num(const BVHTree *tree)
 {
-  return (int)MIN2(tree->tree_type, tree->nodes[tree->totleaf]->totnode);
+  const BVHNode *roots[KDOPBVH_OVERLAP_TASKS_MAX];
+  return bvhtree_overlap_roots(tree, roots);
 }
 
 static void bvhtree_overlap_task_cb(void *__restrict userdata,
@@ -1199,14 +1355,12 @@ static void bvhtree_overlap_task_cb(void *__restrict userdata,
   BVHOverlapData_Shared *data_shared = data->shared;
 
   if (data_shared->callback) {
-    tree_overlap_traverse_cb(data,
-                             data_shared->tree1->nodes[data_shared->tree1->totleaf]->children[j],
-                             data_shared->tree2->nodes[data_shared->tree2->totleaf]);
+    tree_overlap_traverse_cb(
+        data, data_shared->roots[j], data_shared->tree2->nodes[data_shared->tree2->totleaf]);
   }
   else {
-    tree_overlap_traverse(data,
-                          data_shared->tree1->nodes[data_shared->tree1->totleaf]->children[j],
-                          data_shared->tree2->nodes[data_shared->tree2->totleaf]);
+    tree_overlap_traverse(
+        data, data_shared->roots[j], data_shared->tree2->nodes[data_shared->tree2->totleaf]);
   }
 }
 
@@ -1218,7 +1372,8 @@ BVHTreeOverlap *BLI_bvhtree_overlap(
     BVHTree_OverlapCallback callback,
     void *userdata)
 {
-  const int thread_num = BLI_bvhtree_overlap_thread_num(tree1);
+  const BVHNode *roots[KDOPBVH_OVERLAP_TASKS_MAX];
+  const int thread_num = bvhtree_overlap_roots(tree1, roots);
   int j;
   size_t total = 0;
   BVHTreeOverlap *overlap = NULL, *to = NULL;
@@ -1244,6 +1399,7 @@ BVHTreeOverlap *BLI_bvhtree_overlap(
 
   data_shared.tree1 = tree1;
   data_shared.tree2 = tree2;
+  data_shared.roots = roots;
   data_shared.start_axis = start_axis;
   data_shared.stop_axis = stop_axis;
 
@@ -1263,6 +1419,7 @@ BVHTreeOverlap *BLI_bvhtree_overlap(
   ParallelRangeSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (tree1->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
   BLI_task_parallel_range(0, thread_num, data, bvhtree_overlap_task_cb, &settings);
 
   for (j = 0; j < thread_num; j++) {
@@ -1705,6 +1862,64 @@ int BLI_bvhtree_ray_cast(BVHTree *tree,
       tree, co, dir, radius, hit, callback, userdata, BVH_RAYCAST_DEFAULT);
 }
 
+typedef struct BVHRayCastBatchData {
+  BVHTree *tree;
+  const BVHTreeRay *rays;
+  BVHTreeRayHit *hits;
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+  int flag;
+} BVHRayCastBatchData;
+
+static void bvhtree_ray_cast_batch_task_cb(void *__restrict userdata,
+                                           const int i,
+                                           const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const BVHRayCastBatchData *data = userdata;
+  const BVHTreeRay *ray = &data->rays[i];
+
+  BLI_bvhtree_ray_cast_ex(data->tree,
+                          ray->origin,
+                          ray->direction,
+                          ray->radius,
+                          &data->hits[i],
+                          data->callback,
+                          data->userdata,
+                          data->flag);
+}
+
+/**
+ * Cast many rays at once, spreading them across threads.
+ *
+ * \param hits: One hit per ray, initialized by the caller as for #BLI_bvhtree_ray_cast_ex
+ * (the distance limits the length of the ray, index should be -1).
+ *
+ * \note \a callback is called from multiple threads, so it must be thread-safe.
+ */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const BVHTreeRay *rays,
+                                BVHTreeRayHit *hits,
+                                const int rays_num,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag)
+{
+  BVHRayCastBatchData data = {
+      .tree = tree,
+      .rays = rays,
+      .hits = hits,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, rays_num, &data, bvhtree_ray_cast_batch_task_cb, &settings);
+}
+
 float BLI_bvhtree_bb_raycast(const float bv[6],
                              const float light_start[3],
                              const float light_end[3],
@@ -184,6 +184,41 @@ static BLI_mempool_chunk *mempool_chunk_alloc(BLI_mempool *pool)
   return MEM_mallocN(sizeof(BLI_mempool_chunk) + (size_t)pool->csize, "BLI_Mempool Chunk");
 }
 
+/**
+ * Build the free list over all elements of \a mpchunk.
+ *
+ * \return The last element of the chunk (its \a next is NULL).
+ */
+static BLI_freenode *mempool_chunk_link_nodes(const BLI_mempool *pool, BLI_mempool_chunk *mpchunk)
+{
+  const uint esize = pool->esize;
+  BLI_freenode *curnode = CHUNK_DATA(mpchunk);
+  uint j;
+
+  /* loop through the allocated data, building the pointer structures */
+  j = pool->pchunk;
+  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    while (j--) {
+      curnode->next = NODE_STEP_NEXT(curnode);
+      curnode->freeword = FREEWORD;
+      curnode = curnode->next;
+    }
+  }
+  else {
+    while (j--) {
+      curnode->next = NODE_STEP_NEXT(curnode);
+      curnode = curnode->next;
+    }
+  }
+
+  /* terminate the list (rewind one)
+   * will be overwritten if 'curnode' gets passed in again as 'last_tail' */
+  curnode = NODE_STEP_PREV(curnode);
+  curnode->next = NULL;
+
+  return curnode;
+}
+
 /**
  * Initialize a chunk and add into \a pool->chunks
  *
@@ -197,9 +232,7 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
                                        BLI_mempool_chunk *mpchunk,
                                        BLI_freenode *last_tail)
 {
-  const uint esize = pool->esize;
-  BLI_freenode *curnode = CHUNK_DATA(mpchunk);
-  uint j;
+  BLI_freenode *curnode;
 
   /* append */
   if (pool->chunk_tail) {
@@ -214,29 +247,10 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
   pool->chunk_tail = mpchunk;
 
   if (UNLIKELY(pool->free == NULL)) {
-    pool->free = curnode;
+    pool->free = CHUNK_DATA(mpchunk);
   }
 
-  /* loop through the allocated data, building the pointer structures */
-  j = pool->pchunk;
-  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode->freeword = FREEWORD;
-      curnode = curnode->next;
-    }
-  }
-  else {
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode = curnode->next;
-    }
-  }
-
-  /* terminate the list (rewind one)
-   * will be overwritten if 'curnode' gets passed in again as 'last_tail' */
-  curnode = NODE_STEP_PREV(curnode);
-  curnode->next = NULL;
+  curnode = mempool_chunk_link_nodes(pool, mpchunk);
 
 #ifdef USE_TOTALLOC
   pool->totalloc += pool->pchunk;
@@ -451,6 +465,165 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Thread Local Allocation
+ *
+ * Allows worker threads to allocate and free elements of the same pool concurrently.
+ *
+ * Each thread keeps its own free list in a #BLI_mempool_local, refilled either by taking
+ * the whole shared free list or by appending a new chunk, both done with atomic operations.
+ * Element counts are only accumulated into the pool on #BLI_mempool_local_finalize,
+ * so all threads must be finalized before using the pool (iterating, #BLI_mempool_len...)
+ * from the calling thread again.
+ *
+ * The regular (non thread-safe) functions must not be called on the pool meanwhile.
+ * \{ */
+
+/**
+ * Initialize a thread local cache for \a pool.
+ *
+ * \note Since no memory is owned before the first allocation, an initialized cache
+ * may be used as #ParallelRangeSettings.userdata_chunk,
+ * calling #BLI_mempool_local_finalize from #ParallelRangeSettings.func_finalize.
+ */
+void BLI_mempool_local_init(BLI_mempool *pool, BLI_mempool_local *local)
+{
+  local->pool = pool;
+  local->free = NULL;
+  local->totused = 0;
+}
+
+/**
+ * Move elements into the empty \a local free list, from the shared one when possible,
+ * otherwise from a newly allocated chunk.
+ */
+static void mempool_local_refill(BLI_mempool_local *local)
+{
+  BLI_mempool *pool = local->pool;
+  BLI_freenode *free_list;
+  BLI_mempool_chunk *mpchunk, *chunk_tail;
+
+  /* Take the whole shared free list, unlike popping a single element this is ABA safe. */
+  while ((free_list = pool->free) != NULL) {
+    if (atomic_cas_ptr((void **)&pool->free, free_list, NULL) == free_list) {
+      local->free = free_list;
+      return;
+    }
+  }
+
+  mpchunk = mempool_chunk_alloc(pool);
+  mpchunk->next = NULL;
+  mempool_chunk_link_nodes(pool, mpchunk);
+
+  /* Append to the chunk list, only the thread which replaced the tail links to it. */
+  do {
+    chunk_tail = pool->chunk_tail;
+  } while (atomic_cas_ptr((void **)&pool->chunk_tail, chunk_tail, mpchunk) != chunk_tail);
+
+  if (chunk_tail) {
+    chunk_tail->next = mpchunk;
+  }
+  else {
+    pool->chunks = mpchunk;
+  }
+
+#ifdef USE_TOTALLOC
+  atomic_add_and_fetch_u(&pool->totalloc, pool->pchunk);
+#endif
+
+  local->free = CHUNK_DATA(mpchunk);
+}
+
+void *BLI_mempool_local_alloc(BLI_mempool_local *local)
+{
+  BLI_freenode *free_pop;
+
+  if (UNLIKELY(local->free == NULL)) {
+    mempool_local_refill(local);
+  }
+
+  free_pop = local->free;
+
+  if (local->pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    free_pop->freeword = USEDWORD;
+  }
+
+  local->free = free_pop->next;
+  local->totused++;
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_ALLOC(local->pool, free_pop, local->pool->esize);
+#endif
+
+  return (void *)free_pop;
+}
+
+void *BLI_mempool_local_calloc(BLI_mempool_local *local)
+{
+  void *retval = BLI_mempool_local_alloc(local);
+  memset(retval, 0, (size_t)local->pool->esize);
+  return retval;
+}
+
+/**
+ * Free an element from the pool, it may have been allocated by any thread.
+ *
+ * \note Unlike #BLI_mempool_free, chunks are never freed here.
+ */
+void BLI_mempool_local_free(BLI_mempool_local *local, void *addr)
+{
+  BLI_freenode *newhead = addr;
+
+  if (local->pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+#ifndef NDEBUG
+    /* This will detect double free's. */
+    BLI_assert(newhead->freeword != FREEWORD);
+#endif
+    newhead->freeword = FREEWORD;
+  }
+
+  newhead->next = local->free;
+  local->free = newhead;
+  local->totused--;
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_FREE(local->pool, addr);
+#endif
+}
+
+/**
+ * Give the unused elements of \a local back to the pool and update its element count.
+ */
+void BLI_mempool_local_finalize(BLI_mempool_local *local)
+{
+  BLI_mempool *pool = local->pool;
+  BLI_freenode *free_head = local->free;
+
+  if (free_head != NULL) {
+    BLI_freenode *free_tail = free_head;
+    BLI_freenode *free_next;
+
+    while (free_tail->next) {
+      free_tail = free_tail->next;
+    }
+
+    /* Pushing is ABA safe, no need for more than a CAS loop. */
+    do {
+      free_next = pool->free;
+      free_tail->next = free_next;
+    } while (atomic_cas_ptr((void **)&pool->free, free_next, free_head) != free_next);
+
+    local->free = NULL;
+  }
+
+  if (local->totused != 0) {
+    atomic_add_and_fetch_u(&pool->totused, (uint)local->totused);
+    local->totused = 0;
+  }
+}
+
+/** \} */
+
 int BLI_mempool_len(BLI_mempool *pool)
 {
   return (int)pool->totused;
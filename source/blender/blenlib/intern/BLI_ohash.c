@@ -0,0 +1,652 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * An open-addressing (key -> pointer) hash table.
+ *
+ * Layout is similar to #EdgeHash: entries are stored densely in insertion order,
+ * and a separate map (twice as large) stores the entry index for every slot.
+ * Each slot additionally has a control byte, which is either #SLOT_EMPTY, #SLOT_DUMMY
+ * (a removed entry) or the 7 lowest bits of the key hash.
+ *
+ * Slots are probed in aligned groups of #GROUP_SIZE, comparing all control bytes of a
+ * group at once (with SSE2 when available), so the key compare callback is only called
+ * for slots which are very likely to match. The full hash is stored in the entry as well,
+ * which makes growing the table a linear pass without calling the hash callback.
+ *
+ * \note The API matches BLI_ghash.c, but the implementation is different.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_math_bits.h"
+#include "BLI_ohash.h"
+#include "BLI_strict_flags.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+typedef struct OHashEntry {
+  void *key, *val;
+  uint hash;
+} OHashEntry;
+
+struct OHash {
+  GHashHashFP hashfp;
+  GHashCmpFP cmpfp;
+
+  OHashEntry *entries;
+  uint8_t *ctrl;
+  int32_t *map;
+  uint32_t group_mask;
+  uint capacity_exp;
+  uint length;
+  uint dummy_count;
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Internal Helper Macros & Defines
+ * \{ */
+
+#define GROUP_SIZE 16
+
+#define ENTRIES_CAPACITY(container) (uint)(1 << (container)->capacity_exp)
+#define MAP_CAPACITY(container) (uint)(1 << ((container)->capacity_exp + 1))
+#define CLEAR_MAP(container) memset((container)->ctrl, SLOT_EMPTY, MAP_CAPACITY(container))
+#define UPDATE_GROUP_MASK(container) \
+  { \
+    (container)->group_mask = (MAP_CAPACITY(container) / GROUP_SIZE) - 1; \
+  } \
+  ((void)0)
+
+/* Control bytes of free slots have the high bit set, used slots store #SLOT_TAG. */
+#define SLOT_EMPTY 0x80
+#define SLOT_DUMMY 0xFE
+#define SLOT_TAG(hash) (uint8_t)((hash)&0x7F)
+#define GROUP_FROM_HASH(hash) ((hash) >> 7)
+
+/* Smallest capacity so the map holds at least one group. */
+#define CAPACITY_EXP_MIN 3
+#define CAPACITY_EXP_DEFAULT 3
+
+/**
+ * Visit every group once using triangular probing, which is guaranteed
+ * to cover the whole table since the number of groups is a power of two.
+ */
+#define ITER_GROUPS(CONTAINER, HASH, GROUP) \
+  uint32_t mask = (CONTAINER)->group_mask; \
+  uint32_t GROUP = mask & GROUP_FROM_HASH(HASH); \
+  for (uint32_t step = 1;; GROUP = mask & (GROUP + step), step++)
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Internal Group Probing
+ * \{ */
+
+/* Bit-mask of the slots in the group which have the given control byte. */
+BLI_INLINE uint group_match(const uint8_t *ctrl, const uint8_t value)
+{
+#ifdef __SSE2__
+  const __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)value)));
+#else
+  uint result = 0;
+  for (uint i = 0; i < GROUP_SIZE; i++) {
+    if (ctrl[i] == value) {
+      result |= 1u << i;
+    }
+  }
+  return result;
+#endif
+}
+
+/* Bit-mask of the empty or removed slots in the group. */
+BLI_INLINE uint group_match_free(const uint8_t *ctrl)
+{
+#ifdef __SSE2__
+  const __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (uint)_mm_movemask_epi8(group);
+#else
+  uint result = 0;
+  for (uint i = 0; i < GROUP_SIZE; i++) {
+    if (ctrl[i] & 0x80) {
+      result |= 1u << i;
+    }
+  }
+  return result;
+#endif
+}
+
+static uint calc_capacity_exp_for_reserve(uint reserve)
+{
+  uint result = 1;
+  while (reserve >>= 1) {
+    result++;
+  }
+  return (result < CAPACITY_EXP_MIN) ? CAPACITY_EXP_MIN : result;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Internal Utility API
+ * \{ */
+
+/**
+ * Return the slot storing \a key, or -1 when not found.
+ */
+BLI_INLINE int ohash_lookup_slot(OHash *oh, const void *key, const uint hash)
+{
+  const uint8_t tag = SLOT_TAG(hash);
+  ITER_GROUPS (oh, hash, group) {
+    const uint group_offset = group * GROUP_SIZE;
+    const uint8_t *ctrl = &oh->ctrl[group_offset];
+    uint match = group_match(ctrl, tag);
+    while (match) {
+      const uint slot = group_offset + bitscan_forward_clear_uint(&match);
+      const OHashEntry *entry = &oh->entries[oh->map[slot]];
+      if (entry->hash == hash && oh->cmpfp(key, entry->key) == false) {
+        return (int)slot;
+      }
+    }
+    if (group_match(ctrl, SLOT_EMPTY)) {
+      return -1;
+    }
+  }
+}
+
+BLI_INLINE uint ohash_find_free_slot(OHash *oh, const uint hash)
+{
+  ITER_GROUPS (oh, hash, group) {
+    const uint match = group_match_free(&oh->ctrl[group * GROUP_SIZE]);
+    if (match) {
+      return group * GROUP_SIZE + bitscan_forward_uint(match);
+    }
+  }
+}
+
+BLI_INLINE void ohash_insert_index(OHash *oh, const uint hash, const uint entry_index)
+{
+  const uint slot = ohash_find_free_slot(oh, hash);
+  oh->ctrl[slot] = SLOT_TAG(hash);
+  oh->map[slot] = (int32_t)entry_index;
+}
+
+static void ohash_resize(OHash *oh, const uint capacity_exp)
+{
+  oh->capacity_exp = capacity_exp;
+  UPDATE_GROUP_MASK(oh);
+  oh->dummy_count = 0;
+  oh->entries = MEM_reallocN(oh->entries, sizeof(OHashEntry) * ENTRIES_CAPACITY(oh));
+  oh->ctrl = MEM_reallocN(oh->ctrl, sizeof(uint8_t) * MAP_CAPACITY(oh));
+  oh->map = MEM_reallocN(oh->map, sizeof(int32_t) * MAP_CAPACITY(oh));
+  CLEAR_MAP(oh);
+  for (uint i = 0; i < oh->length; i++) {
+    ohash_insert_index(oh, oh->entries[i].hash, i);
+  }
+}
+
+BLI_INLINE void ohash_ensure_can_insert(OHash *oh)
+{
+  if (UNLIKELY(ENTRIES_CAPACITY(oh) <= oh->length + oh->dummy_count)) {
+    /* Grow when most used slots hold live entries,
+     * otherwise rebuilding is enough to get rid of removed slots. */
+    ohash_resize(oh, oh->capacity_exp + ((oh->dummy_count < oh->length) ? 1 : 0));
+  }
+}
+
+BLI_INLINE OHashEntry *ohash_insert(OHash *oh, void *key, void *val, const uint hash)
+{
+  ohash_ensure_can_insert(oh);
+  const uint slot = ohash_find_free_slot(oh, hash);
+  if (oh->ctrl[slot] == SLOT_DUMMY) {
+    oh->dummy_count--;
+  }
+  OHashEntry *entry = &oh->entries[oh->length];
+  entry->key = key;
+  entry->val = val;
+  entry->hash = hash;
+  oh->ctrl[slot] = SLOT_TAG(hash);
+  oh->map[slot] = (int32_t)oh->length;
+  oh->length++;
+  return entry;
+}
+
+BLI_INLINE OHashEntry *ohash_lookup_entry(OHash *oh, const void *key)
+{
+  const int slot = ohash_lookup_slot(oh, key, oh->hashfp(key));
+  return (slot != -1) ? &oh->entries[oh->map[slot]] : NULL;
+}
+
+BLI_INLINE void ohash_change_index(OHash *oh, const uint hash, int32_t old_index, int32_t new_index)
+{
+  const uint8_t tag = SLOT_TAG(hash);
+  ITER_GROUPS (oh, hash, group) {
+    const uint group_offset = group * GROUP_SIZE;
+    uint match = group_match(&oh->ctrl[group_offset], tag);
+    while (match) {
+      const uint slot = group_offset + bitscan_forward_clear_uint(&match);
+      if (oh->map[slot] == old_index) {
+        oh->map[slot] = new_index;
+        return;
+      }
+    }
+  }
+}
+
+static void ohash_remove_slot(OHash *oh, const uint slot)
+{
+  const int32_t index = oh->map[slot];
+  const uint group_offset = slot - (slot % GROUP_SIZE);
+
+  /* When the group still has an empty slot no probing went past it,
+   * so the slot can be freed without leaving a dummy behind. */
+  if (group_match(&oh->ctrl[group_offset], SLOT_EMPTY)) {
+    oh->ctrl[slot] = SLOT_EMPTY;
+  }
+  else {
+    oh->ctrl[slot] = SLOT_DUMMY;
+    oh->dummy_count++;
+  }
+
+  oh->length--;
+  if ((uint)index < oh->length) {
+    oh->entries[index] = oh->entries[oh->length];
+    ohash_change_index(oh, oh->entries[index].hash, (int32_t)oh->length, index);
+  }
+}
+
+static void ohash_free_keys_and_values(OHash *oh,
+                                       GHashKeyFreeFP keyfreefp,
+                                       GHashValFreeFP valfreefp)
+{
+  if (keyfreefp || valfreefp) {
+    for (uint i = 0; i < oh->length; i++) {
+      if (keyfreefp) {
+        keyfreefp(oh->entries[i].key);
+      }
+      if (valfreefp) {
+        valfreefp(oh->entries[i].val);
+      }
+    }
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name OHash Public API
+ * \{ */
+
+/**
+ * Creates a new, empty OHash.
+ *
+ * \param hashfp: Hash callback.
+ * \param cmpfp: Comparison callback.
+ * \param info: Identifier string for the OHash.
+ * \param nentries_reserve: Optionally reserve the number of members that the hash will hold.
+ * Use this to avoid resizing buckets if the size is known or can be closely approximated.
+ * \return  An empty OHash.
+ */
+OHash *BLI_ohash_new_ex(GHashHashFP hashfp,
+                        GHashCmpFP cmpfp,
+                        const char *info,
+                        const uint nentries_reserve)
+{
+  OHash *oh = MEM_mallocN(sizeof(OHash), info);
+  oh->hashfp = hashfp;
+  oh->cmpfp = cmpfp;
+  oh->capacity_exp = calc_capacity_exp_for_reserve(nentries_reserve);
+  UPDATE_GROUP_MASK(oh);
+  oh->length = 0;
+  oh->dummy_count = 0;
+  oh->entries = MEM_malloc_arrayN(sizeof(OHashEntry), ENTRIES_CAPACITY(oh), "oh entries");
+  oh->ctrl = MEM_malloc_arrayN(sizeof(uint8_t), MAP_CAPACITY(oh), "oh ctrl");
+  oh->map = MEM_malloc_arrayN(sizeof(int32_t), MAP_CAPACITY(oh), "oh map");
+  CLEAR_MAP(oh);
+  return oh;
+}
+
+/**
+ * Wraps #BLI_ohash_new_ex with room for the default number of entries
+ * (`1 << CAPACITY_EXP_DEFAULT`) reserved.
+ */
+OHash *BLI_ohash_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info)
+{
+  return BLI_ohash_new_ex(hashfp, cmpfp, info, 1 << CAPACITY_EXP_DEFAULT);
+}
+
+/**
+ * Frees the OHash and its members.
+ *
+ * \param oh: The OHash to free.
+ * \param keyfreefp: Optional callback to free the key.
+ * \param valfreefp: Optional callback to free the value.
+ */
+void BLI_ohash_free(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  ohash_free_keys_and_values(oh, keyfreefp, valfreefp);
+  MEM_freeN(oh->map);
+  MEM_freeN(oh->ctrl);
+  MEM_freeN(oh->entries);
+  MEM_freeN(oh);
+}
+
+/**
+ * Reserve given amount of entries (resize \a oh accordingly if needed).
+ */
+void BLI_ohash_reserve(OHash *oh, const uint nentries_reserve)
+{
+  const uint capacity_exp = calc_capacity_exp_for_reserve(nentries_reserve);
+  if (capacity_exp > oh->capacity_exp) {
+    ohash_resize(oh, capacity_exp);
+  }
+}
+
+/**
+ * Insert a key/value pair into the \a oh.
+ *
+ * \note Duplicates are not checked,
+ * the caller is expected to ensure elements are unique.
+ */
+void BLI_ohash_insert(OHash *oh, void *key, void *val)
+{
+  ohash_insert(oh, key, val, oh->hashfp(key));
+}
+
+/**
+ * Inserts a new value to a key that may already be in ohash.
+ *
+ * Avoids #BLI_ohash_remove, #BLI_ohash_insert calls (double lookups)
+ *
+ * \returns true if a new key has been added.
+ */
+bool BLI_ohash_reinsert(
+    OHash *oh, void *key, void *val, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  const uint hash = oh->hashfp(key);
+  const int slot = ohash_lookup_slot(oh, key, hash);
+  if (slot != -1) {
+    OHashEntry *entry = &oh->entries[oh->map[slot]];
+    if (keyfreefp) {
+      keyfreefp(entry->key);
+    }
+    if (valfreefp) {
+      valfreefp(entry->val);
+    }
+    entry->key = key;
+    entry->val = val;
+    return false;
+  }
+  ohash_insert(oh, key, val, hash);
+  return true;
+}
+
+/**
+ * Lookup the value of \a key in \a oh.
+ *
+ * \param key: The key to lookup.
+ * \returns the value for \a key or NULL.
+ *
+ * \note When NULL is a valid value, use #BLI_ohash_lookup_p to differentiate a missing key
+ * from a key with a NULL value. (Avoids calling #BLI_ohash_haskey before #BLI_ohash_lookup)
+ */
+void *BLI_ohash_lookup(OHash *oh, const void *key)
+{
+  OHashEntry *entry = ohash_lookup_entry(oh, key);
+  return entry ? entry->val : NULL;
+}
+
+/**
+ * A version of #BLI_ohash_lookup which accepts a fallback argument.
+ */
+void *BLI_ohash_lookup_default(OHash *oh, const void *key, void *val_default)
+{
+  OHashEntry *entry = ohash_lookup_entry(oh, key);
+  return entry ? entry->val : val_default;
+}
+
+/**
+ * Lookup a pointer to the value of \a key in \a oh.
+ *
+ * \param key: The key to lookup.
+ * \returns the pointer to value for \a key or NULL.
+ *
+ * \note The pointer is only valid until the next insertion or removal.
+ */
+void **BLI_ohash_lookup_p(OHash *oh, const void *key)
+{
+  OHashEntry *entry = ohash_lookup_entry(oh, key);
+  return entry ? &entry->val : NULL;
+}
+
+/**
+ * Ensure \a key is exists in \a oh.
+ *
+ * \returns true when the value didn't need to be added.
+ * (when false, the caller _must_ initialize the value).
+ *
+ * \note The pointer is only valid until the next insertion or removal.
+ */
+bool BLI_ohash_ensure_p(OHash *oh, void *key, void ***r_val)
+{
+  const uint hash = oh->hashfp(key);
+  const int slot = ohash_lookup_slot(oh, key, hash);
+  if (slot != -1) {
+    *r_val = &oh->entries[oh->map[slot]].val;
+    return true;
+  }
+  *r_val = &ohash_insert(oh, key, NULL, hash)->val;
+  return false;
+}
+
+/**
+ * Remove \a key from \a oh, or return false if the key wasn't found.
+ *
+ * \param key: The key to remove.
+ * \param keyfreefp: Optional callback to free the key.
+ * \param valfreefp: Optional callback to free the value.
+ * \return true if \a key was removed from \a oh.
+ */
+bool BLI_ohash_remove(OHash *oh,
+                      const void *key,
+                      GHashKeyFreeFP keyfreefp,
+                      GHashValFreeFP valfreefp)
+{
+  const int slot = ohash_lookup_slot(oh, key, oh->hashfp(key));
+  if (slot == -1) {
+    return false;
+  }
+  OHashEntry *entry = &oh->entries[oh->map[slot]];
+  if (keyfreefp) {
+    keyfreefp(entry->key);
+  }
+  if (valfreefp) {
+    valfreefp(entry->val);
+  }
+  ohash_remove_slot(oh, (uint)slot);
+  return true;
+}
+
+/**
+ * Remove \a key from \a oh, returning the value or NULL if the key wasn't found.
+ *
+ * \param key: The key to remove.
+ * \param keyfreefp: Optional callback to free the key.
+ * \return the value of \a key int \a oh or NULL.
+ */
+void *BLI_ohash_popkey(OHash *oh, const void *key, GHashKeyFreeFP keyfreefp)
+{
+  const int slot = ohash_lookup_slot(oh, key, oh->hashfp(key));
+  if (slot == -1) {
+    return NULL;
+  }
+  OHashEntry *entry = &oh->entries[oh->map[slot]];
+  void *val = entry->val;
+  if (keyfreefp) {
+    keyfreefp(entry->key);
+  }
+  ohash_remove_slot(oh, (uint)slot);
+  return val;
+}
+
+/**
+ * \return true if the \a key is in \a oh.
+ */
+bool BLI_ohash_haskey(OHash *oh, const void *key)
+{
+  return (ohash_lookup_entry(oh, key) != NULL);
+}
+
+/**
+ * Remove all entries from \a oh, keeping its capacity.
+ */
+void BLI_ohash_clear(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  ohash_free_keys_and_values(oh, keyfreefp, valfreefp);
+  oh->length = 0;
+  oh->dummy_count = 0;
+  CLEAR_MAP(oh);
+}
+
+/**
+ * \return size of the OHash.
+ */
+uint BLI_ohash_len(OHash *oh)
+{
+  return oh->length;
+}
+
+OHash *BLI_ohash_ptr_new(const char *info)
+{
+  return BLI_ohash_new(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, info);
+}
+OHash *BLI_ohash_str_new(const char *info)
+{
+  return BLI_ohash_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, info);
+}
+OHash *BLI_ohash_int_new(const char *info)
+{
+  return BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, info);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name OHash Iterator API
+ * \{ */
+
+/**
+ * Init an already allocated OHashIterator.
+ * Entries are visited in insertion order, as long as none have been removed.
+ *
+ * \param ohi: The OHashIterator to initialize.
+ * \param oh: The OHash to iterate over.
+ */
+void BLI_ohashIterator_init(OHashIterator *ohi, OHash *oh)
+{
+  ohi->curEntry = oh->entries;
+  ohi->endEntry = oh->entries + oh->length;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name OSet Public API
+ *
+ * Use ohash API to give 'set' functionality
+ * \{ */
+
+OSet *BLI_oset_new_ex(GSetHashFP hashfp,
+                      GSetCmpFP cmpfp,
+                      const char *info,
+                      const uint nentries_reserve)
+{
+  return (OSet *)BLI_ohash_new_ex(hashfp, cmpfp, info, nentries_reserve);
+}
+
+OSet *BLI_oset_new(GSetHashFP hashfp, GSetCmpFP cmpfp, const char *info)
+{
+  return (OSet *)BLI_ohash_new(hashfp, cmpfp, info);
+}
+
+uint BLI_oset_len(OSet *os)
+{
+  return ((OHash *)os)->length;
+}
+
+void BLI_oset_free(OSet *os, GSetKeyFreeFP keyfreefp)
+{
+  BLI_ohash_free((OHash *)os, keyfreefp, NULL);
+}
+
+/**
+ * Adds the key to the set (no checks for unique keys!).
+ * Matching #BLI_ohash_insert
+ */
+void BLI_oset_insert(OSet *os, void *key)
+{
+  BLI_ohash_insert((OHash *)os, key, NULL);
+}
+
+/**
+ * A version of BLI_oset_insert which checks first if the key is in the set.
+ * \returns true if a new key has been added.
+ */
+bool BLI_oset_add(OSet *os, void *key)
+{
+  OHash *oh = (OHash *)os;
+  const uint hash = oh->hashfp(key);
+  if (ohash_lookup_slot(oh, key, hash) != -1) {
+    return false;
+  }
+  ohash_insert(oh, key, NULL, hash);
+  return true;
+}
+
+bool BLI_oset_haskey(OSet *os, const void *key)
+{
+  return BLI_ohash_haskey((OHash *)os, key);
+}
+
+bool BLI_oset_remove(OSet *os, const void *key, GSetKeyFreeFP keyfreefp)
+{
+  return BLI_ohash_remove((OHash *)os, key, keyfreefp, NULL);
+}
+
+void BLI_oset_clear(OSet *os, GSetKeyFreeFP keyfreefp)
+{
+  BLI_ohash_clear((OHash *)os, keyfreefp, NULL);
+}
+
+OSet *BLI_oset_ptr_new(const char *info)
+{
+  return BLI_oset_new(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, info);
+}
+OSet *BLI_oset_str_new(const char *info)
+{
+  return BLI_oset_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, info);
+}
+
+/** \} */
@@ -22,6 +22,7 @@
 
 #include "BLI_math.h"
 #include "BLI_kdtree_impl.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_strict_flags.h"
 
@@ -56,6 +57,11 @@ struct KDTree {
 #define KD_NEAR_ALLOC_INC 100 /* alloc increment for collecting nearest */
 #define KD_FOUND_ALLOC_INC 50 /* alloc increment for collecting nearest */
 
+/* Ranges of nodes large enough to be balanced in their own task. */
+#define KD_BALANCE_THREADED_MIN 10000
+/* Number of query points from which batch queries are threaded. */
+#define KD_BATCH_THREADED_MIN 1000
+
 #define KD_NODE_UNSET ((uint)-1)
 
 /** When set we know all values are unbalanced,
@@ -143,19 +149,17 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Quicksort style partitioning of \a nodes around their median on \a axis.
+ *
+ * \return The median, all nodes before it are lower or equal on \a axis,
+ * all nodes after it are greater or equal.
+ */
+static uint kdtree_balance_partition(KDTreeNode *nodes, uint nodes_len, uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
   /* quicksort style sorting around median */
   left = 0;
   right = nodes_len - 1;
@@ -188,6 +192,23 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
   /* set node and sort subnodes */
   node = &nodes[median];
   node->d = axis;
@@ -199,6 +220,65 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Threaded Balance
+ *
+ * Both halves of a partitioned range are independent,
+ * so large ranges balance their left half in a new task.
+ * \{ */
+
+typedef struct KDTreeBalanceTask {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+  /** Where to store the root of this range. */
+  uint *r_root;
+} KDTreeBalanceTask;
+
+static void kdtree_balance_task_cb(TaskPool *__restrict pool, void *taskdata, int threadid);
+
+static uint kdtree_balance_threaded(
+    TaskPool *pool, const int threadid, KDTreeNode *nodes, uint nodes_len, uint axis, uint ofs)
+{
+  if (nodes_len >= KD_BALANCE_THREADED_MIN) {
+    const uint median = kdtree_balance_partition(nodes, nodes_len, axis);
+    KDTreeNode *node = &nodes[median];
+    KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+
+    node->d = axis;
+    axis = (axis + 1) % KD_DIMS;
+
+    task->nodes = nodes;
+    task->nodes_len = median;
+    task->axis = axis;
+    task->ofs = ofs;
+    task->r_root = &node->left;
+    BLI_task_pool_push_from_thread(
+        pool, kdtree_balance_task_cb, task, true, TASK_PRIORITY_HIGH, threadid);
+
+    /* Continue with the right half on this thread. */
+    node->right = kdtree_balance_threaded(pool,
+                                          threadid,
+                                          nodes + median + 1,
+                                          nodes_len - (median + 1),
+                                          axis,
+                                          (median + 1) + ofs);
+    return median + ofs;
+  }
+
+  return kdtree_balance(nodes, nodes_len, axis, ofs);
+}
+
+static void kdtree_balance_task_cb(TaskPool *__restrict pool, void *taskdata, int threadid)
+{
+  KDTreeBalanceTask *task = taskdata;
+  *task->r_root = kdtree_balance_threaded(
+      pool, threadid, task->nodes, task->nodes_len, task->axis, task->ofs);
+}
+
+/** \} */
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -208,7 +288,24 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len >= KD_BALANCE_THREADED_MIN) {
+    TaskScheduler *scheduler = BLI_task_scheduler_get();
+    TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+    KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+
+    task->nodes = tree->nodes;
+    task->nodes_len = tree->nodes_len;
+    task->axis = 0;
+    task->ofs = 0;
+    task->r_root = &tree->root;
+    BLI_task_pool_push(pool, kdtree_balance_task_cb, task, true, TASK_PRIORITY_HIGH);
+
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -804,6 +901,97 @@ finally:
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batch Queries
+ *
+ * Run the same query for many points, threaded when there are enough of them.
+ * \{ */
+
+struct KDTreeBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  float range;
+  KDTreeNearest *r_nearest;
+  KDTreeNearest **r_nearest_range;
+  int *r_found;
+};
+
+static void kdtree_find_nearest_batch_cb(void *__restrict userdata,
+                                         const int i,
+                                         const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const struct KDTreeBatchData *data = userdata;
+  if (BLI_kdtree_nd_(find_nearest)(data->tree, data->co[i], &data->r_nearest[i]) == -1) {
+    data->r_nearest[i].index = -1;
+  }
+}
+
+static void kdtree_range_search_batch_cb(void *__restrict userdata,
+                                         const int i,
+                                         const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const struct KDTreeBatchData *data = userdata;
+  data->r_found[i] = BLI_kdtree_nd_(range_search)(
+      data->tree, data->co[i], &data->r_nearest_range[i], data->range);
+}
+
+static void kdtree_batch_settings(ParallelRangeSettings *settings, const uint co_len)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (co_len >= KD_BATCH_THREADED_MIN);
+  settings->min_iter_per_thread = 64;
+}
+
+/**
+ * Find the nearest node of every point in \a co.
+ *
+ * \param r_nearest: Array of \a co_len results,
+ * the index of a result is -1 when the tree is empty.
+ */
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const uint co_len,
+                                        KDTreeNearest *r_nearest)
+{
+  struct KDTreeBatchData data = {
+      .tree = tree,
+      .co = co,
+      .r_nearest = r_nearest,
+  };
+  ParallelRangeSettings settings;
+  kdtree_batch_settings(&settings, co_len);
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_find_nearest_batch_cb, &settings);
+}
+
+/**
+ * Range search for every point in \a co.
+ *
+ * \param r_nearest: Array of \a co_len arrays, sorted by distance,
+ * each non-NULL array needs to be freed by the caller.
+ * \param r_found: Array of \a co_len, the number of nodes found for each point.
+ */
+void BLI_kdtree_nd_(range_search_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const uint co_len,
+                                        const float range,
+                                        KDTreeNearest **r_nearest,
+                                        int *r_found)
+{
+  struct KDTreeBatchData data = {
+      .tree = tree,
+      .co = co,
+      .range = range,
+      .r_nearest_range = r_nearest,
+      .r_found = r_found,
+  };
+  ParallelRangeSettings settings;
+  kdtree_batch_settings(&settings, co_len);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_range_search_batch_cb, &settings);
+}
+
+/** \} */
+
 /**
  * Use when we want to loop over nodes ordered by index.
  * Requires indices to be aligned with nodes.
@@ -3033,6 +3033,8 @@ static void direct_link_fcurves(FileData *fd, ListBase *list)
      */
     fcu->flag &= ~FCURVE_DISABLED;
 
+    fcu->last_eval_index = 0;
+
     /* driver */
     fcu->driver = newdataadr(fd, fcu->driver);
     if (fcu->driver) {
@@ -6744,6 +6746,7 @@ static void direct_link_scene(FileData *fd, Scene *sce)
 
     ed->act_seq = newdataadr(fd, ed->act_seq);
     ed->cache = NULL;
+    ed->prefetch_job = NULL;
 
     /* recursive link sequences, lb will be correctly initialized */
     link_recurs_seq(fd, &ed->seqbase);
@@ -601,7 +601,10 @@ void BLO_version_defaults_userpref_blend(Main *bmain, UserDef *userdef)
    * Include next version bump.
    */
   {
-    /* pass */
+    if (userdef->sequencer_disk_cache_size_limit == 0) {
+      userdef->sequencer_disk_cache_size_limit = 100;
+      userdef->sequencer_disk_cache_compression = USER_SEQ_DISK_CACHE_COMPRESSION_LOW;
+    }
   }
 
   if (userdef->pixelsize == 0.0f) {
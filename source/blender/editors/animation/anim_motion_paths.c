@@ -125,8 +125,8 @@ static void motionpaths_calc_update_scene(Main *bmain, struct Depsgraph *depsgra
 
 /* ........ */
 
-/* perform baking for the targets on the current frame */
-static void motionpaths_calc_bake_targets(ListBase *targets, int cframe)
+/* perform baking for the targets on the current frame, as evaluated by the given depsgraph */
+static void motionpaths_calc_bake_targets(ListBase *targets, Depsgraph *depsgraph, int cframe)
 {
   MPathTarget *mpt;
 
@@ -144,7 +144,8 @@ static void motionpaths_calc_bake_targets(ListBase *targets, int cframe)
     /* get the relevant cache vert to write to */
     bMotionPathVert *mpv = mpath->points + (cframe - mpath->start_frame);
 
-    Object *ob_eval = mpt->ob_eval;
+    /* Not always the active depsgraph, see animviz_calc_motionpaths(). */
+    Object *ob_eval = DEG_get_evaluated_object(depsgraph, mpt->ob);
 
     /* Lookup evaluated pose channel, here because the depsgraph
      * evaluation can change them so they are not cached in mpt. */
@@ -181,14 +182,17 @@ static void motionpaths_calc_bake_targets(ListBase *targets, int cframe)
       mpv->flag &= ~MOTIONPATH_VERT_KEY;
     }
 
-    /* Incremental update on evaluated object if possible, for fast updating
-     * while dragging in transform. */
+    /* Incremental update on evaluated object of the active depsgraph if possible,
+     * for fast updating while dragging in transform. */
     bMotionPath *mpath_eval = NULL;
     if (mpt->pchan) {
+      if (mpt->ob_eval != ob_eval) {
+        pchan_eval = BKE_pose_channel_find_name(mpt->ob_eval->pose, mpt->pchan->name);
+      }
       mpath_eval = (pchan_eval) ? pchan_eval->mpath : NULL;
     }
     else {
-      mpath_eval = ob_eval->mpath;
+      mpath_eval = mpt->ob_eval->mpath;
     }
 
     if (mpath_eval && mpath_eval->length == mpath->length) {
@@ -202,6 +206,12 @@ static void motionpaths_calc_bake_targets(ListBase *targets, int cframe)
   }
 }
 
+static void motionpaths_calc_frame_cb(Depsgraph *depsgraph, float ctime, void *userdata)
+{
+  ListBase *targets = userdata;
+  motionpaths_calc_bake_targets(targets, depsgraph, (int)ctime);
+}
+
 /* Perform baking of the given object's and/or its bones' transforms to motion paths
  * - scene: current scene
  * - ob: object whose flagged motionpaths should get calculated
@@ -294,27 +304,50 @@ void animviz_calc_motionpaths(Depsgraph *depsgraph,
             sfra,
             efra,
             efra - sfra + 1);
-  for (CFRA = sfra; CFRA <= efra; CFRA++) {
-    if (current_frame_only) {
-      /* For current frame, only update tagged. */
-      BKE_scene_graph_update_tagged(depsgraph, bmain);
+  /* Without simulations frames don't depend on each other, so they are evaluated in
+   * parallel by private depsgraphs, leaving the given one at the current frame. */
+  bool frames_evaluated = false;
+  if (!current_frame_only) {
+    const int frames_len = efra - sfra + 1;
+    float *frames = MEM_malloc_arrayN(frames_len, sizeof(float), __func__);
+    for (int i = 0; i < frames_len; i++) {
+      frames[i] = (float)(sfra + i);
     }
-    else {
-      /* Update relevant data for new frame. */
-      motionpaths_calc_update_scene(bmain, depsgraph);
-    }
-
-    /* perform baking for targets */
-    motionpaths_calc_bake_targets(targets, CFRA);
+    frames_evaluated = BKE_scene_graph_evaluate_frames(bmain,
+                                                       scene,
+                                                       DEG_get_input_view_layer(depsgraph),
+                                                       false,
+                                                       frames,
+                                                       frames_len,
+                                                       0,
+                                                       motionpaths_calc_frame_cb,
+                                                       targets);
+    MEM_freeN(frames);
   }
 
-  /* reset original environment */
-  /* NOTE: We don't always need to reevaluate the main scene, as the depsgraph
-   * may be a temporary one that works on a subset of the data. We always have
-   * to resoture the current frame though. */
-  CFRA = cfra;
-  if (!current_frame_only && restore) {
-    motionpaths_calc_update_scene(bmain, depsgraph);
+  if (!frames_evaluated) {
+    for (CFRA = sfra; CFRA <= efra; CFRA++) {
+      if (current_frame_only) {
+        /* For current frame, only update tagged. */
+        BKE_scene_graph_update_tagged(depsgraph, bmain);
+      }
+      else {
+        /* Update relevant data for new frame. */
+        motionpaths_calc_update_scene(bmain, depsgraph);
+      }
+
+      /* perform baking for targets */
+      motionpaths_calc_bake_targets(targets, depsgraph, CFRA);
+    }
+
+    /* reset original environment */
+    /* NOTE: We don't always need to reevaluate the main scene, as the depsgraph
+     * may be a temporary one that works on a subset of the data. We always have
+     * to resoture the current frame though. */
+    CFRA = cfra;
+    if (!current_frame_only && restore) {
+      motionpaths_calc_update_scene(bmain, depsgraph);
+    }
   }
 
   /* clear recalc flags from targets */
@@ -26,6 +26,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -297,6 +298,9 @@ void DPAINT_OT_output_toggle(wmOperatorType *ot)
 
 /***************************** Image Sequence Baking ******************************/
 
+/* Memory of the float images waiting to be saved, before the bake waits for them to finish. */
+#define DPAINT_BAKE_SAVE_QUEUE_MAX_BYTES ((size_t)1024 * 1024 * 1024)
+
 typedef struct DynamicPaintBakeJob {
   /* from wmJob */
   void *owner;
@@ -311,6 +315,10 @@ typedef struct DynamicPaintBakeJob {
   DynamicPaintSurface *surface;
   DynamicPaintCanvasSettings *canvas;
 
+  /* Image sequence frames are written in the background while the next frame is baked. */
+  struct TaskPool *save_pool;
+  size_t save_queued_bytes;
+
   int success;
   double start;
 } DynamicPaintBakeJob;
@@ -416,6 +424,20 @@ static void dynamicPaint_bakeImageSequence(DynamicPaintBakeJob *job)
      */
     {
       char filename[FILE_MAX];
+      const size_t image_bytes = sizeof(float[4]) * (size_t)surface->image_resolution *
+                                 (size_t)surface->image_resolution;
+      const int image_num = ((surface->flags & MOD_DPAINT_OUT1) ? 1 : 0) +
+                            ((surface->flags & MOD_DPAINT_OUT2 &&
+                              surface->type == MOD_DPAINT_SURFACE_T_PAINT) ?
+                                 1 :
+                                 0);
+
+      /* Bound the memory held by queued images, in case saving is slower than baking. */
+      job->save_queued_bytes += image_bytes * image_num;
+      if (job->save_queued_bytes > DPAINT_BAKE_SAVE_QUEUE_MAX_BYTES) {
+        BLI_task_pool_work_and_wait(job->save_pool);
+        job->save_queued_bytes = image_bytes * image_num;
+      }
 
       /* primary output layer */
       if (surface->flags & MOD_DPAINT_OUT1) {
@@ -425,7 +447,7 @@ static void dynamicPaint_bakeImageSequence(DynamicPaintBakeJob *job)
         BLI_path_frame(filename, frame, 4);
 
         /* save image */
-        dynamicPaint_outputSurfaceImage(surface, filename, 0);
+        dynamicPaint_outputSurfaceImage(surface, filename, 0, job->save_pool);
       }
       /* secondary output */
       if (surface->flags & MOD_DPAINT_OUT2 && surface->type == MOD_DPAINT_SURFACE_T_PAINT) {
@@ -435,7 +457,7 @@ static void dynamicPaint_bakeImageSequence(DynamicPaintBakeJob *job)
         BLI_path_frame(filename, frame, 4);
 
         /* save image */
-        dynamicPaint_outputSurfaceImage(surface, filename, 1);
+        dynamicPaint_outputSurfaceImage(surface, filename, 1, job->save_pool);
       }
     }
   }
@@ -462,8 +484,16 @@ static void dpaint_bake_startjob(void *customdata, short *stop, short *do_update
   G.is_rendering = true;
   BKE_spacedata_draw_locks(true);
 
+  job->save_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+  job->save_queued_bytes = 0;
+
   dynamicPaint_bakeImageSequence(job);
 
+  /* Finish writing queued frames before reporting the bake as done. */
+  BLI_task_pool_work_and_wait(job->save_pool);
+  BLI_task_pool_free(job->save_pool);
+  job->save_pool = NULL;
+
   *do_update = true;
   *stop = 0;
 }
@@ -556,6 +556,11 @@ static int startffmpeg(struct anim *anim)
 
   pCodecCtx->workaround_bugs = 1;
 
+  /* Let FFmpeg pick the number of threads. Frame threading delays output by one frame per
+   * thread, which is drained on EOF and doesn't matter for mostly sequential playback. */
+  pCodecCtx->thread_count = 0;
+  pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
   if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
     avformat_close_input(&pFormatCtx);
     return -1;
@@ -771,6 +771,11 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
 
   context->iCodecCtx->workaround_bugs = 1;
 
+  /* Slice threading only: frame threading delays the decoded frames by several packets,
+   * while the index stores the position of the last packet read for each frame. */
+  context->iCodecCtx->thread_count = 0;
+  context->iCodecCtx->thread_type = FF_THREAD_SLICE;
+
   if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
     avformat_close_input(&context->iFormatCtx);
     MEM_freeN(context);
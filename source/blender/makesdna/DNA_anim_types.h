@@ -561,7 +561,11 @@ typedef struct FCurve {
   /* value cache + settings */
   /** Value stored from last time curve was evaluated (not threadsafe, debug display only!). */
   float curval;
-  char _pad2[4];
+  /**
+   * Index of the keyframe ending the segment found by the last evaluation, used as a
+   * starting guess for the next one (runtime, not threadsafe, always validated before use).
+   */
+  int last_eval_index;
   /** User-editable settings for this curve. */
   short flag;
   /** Value-extending mode for this curve (does not cover). */
@@ -263,6 +263,8 @@ typedef struct Editing {
   rctf over_border;
 
   struct SeqCache *cache;
+  /** Renders frames ahead of the playhead, runtime only. */
+  struct PrefetchJob *prefetch_job;
 
   /* Cache control */
   float recycle_max_cost;
@@ -777,6 +777,14 @@ typedef struct UserDef {
 
   char _pad5[2];
 
+  /** Sequencer disk cache, empty to disable, 1024 = FILE_MAX. */
+  char sequencer_disk_cache_dir[1024];
+  /** Sequencer disk cache size limit (in gigabytes). */
+  int sequencer_disk_cache_size_limit;
+  /** #eUserpref_DiskCacheCompression. */
+  short sequencer_disk_cache_compression;
+  char _pad6[2];
+
   /** Runtime data (keep last). */
   UserDef_Runtime runtime;
 } UserDef;
@@ -1153,6 +1161,13 @@ typedef enum eUserpref_FactorDisplay {
   USER_FACTOR_AS_PERCENTAGE = 1,
 } eUserpref_FactorDisplay;
 
+/** #UserDef.sequencer_disk_cache_compression */
+typedef enum eUserpref_DiskCacheCompression {
+  USER_SEQ_DISK_CACHE_COMPRESSION_NONE = 0,
+  USER_SEQ_DISK_CACHE_COMPRESSION_LOW = 1,
+  USER_SEQ_DISK_CACHE_COMPRESSION_HIGH = 2,
+} eUserpref_DiskCacheCompression;
+
 #ifdef __cplusplus
 }
 #endif
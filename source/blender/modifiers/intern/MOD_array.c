@@ -28,6 +28,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_curve_types.h"
 #include "DNA_mesh_types.h"
@@ -109,6 +110,9 @@ BLI_INLINE float sum_v3(const float v[3])
   return v[0] + v[1] + v[2];
 }
 
+/* Only use threads when there are more elements than this to process. */
+#define ARRAY_PARALLEL_THRESHOLD 10000
+
 /* Structure used for sorting vertices, when processing doubles */
 typedef struct SortVertsElem {
   int vertex_num; /* The original index of the vertex, prior to sorting */
@@ -145,12 +149,111 @@ static void svert_from_mvert(SortVertsElem *sv,
   }
 }
 
+/**
+ * Find the double of \a sve_source within the sorted target vertices,
+ * scanning from \a sve_target (the lowest candidate in terms of sumco).
+ *
+ * \return The target vertex index or -1 if no double found.
+ */
+static int svert_find_double(const int *doubles_map,
+                             const MVert *mverts,
+                             const SortVertsElem *sve_source,
+                             const SortVertsElem *sve_target,
+                             const SortVertsElem *sve_target_end,
+                             const float dist,
+                             const float dist3)
+{
+  int best_target_vertex = -1;
+  float best_dist_sq = dist * dist;
+  const float sve_source_sumco = sum_v3(sve_source->co);
+
+  /* sve_target will scan vertices in the
+   * [v_source_sumco - dist3;  v_source_sumco + dist3] range */
+
+  while ((sve_target != sve_target_end) && (sve_target->sum_co <= sve_source_sumco + dist3)) {
+    /* Testing distance for candidate double in target */
+    /* v_target is within dist3 of v_source in terms of sumco;  check real distance */
+    float dist_sq;
+    if ((dist_sq = len_squared_v3v3(sve_source->co, sve_target->co)) <= best_dist_sq) {
+      /* Potential double found */
+      best_dist_sq = dist_sq;
+      best_target_vertex = sve_target->vertex_num;
+
+      /* If target is already mapped, we only follow that mapping if final target remains
+       * close enough from current vert (otherwise no mapping at all).
+       * Note that if we later find another target closer than this one, then we check it.
+       * But if other potential targets are farther,
+       * then there will be no mapping at all for this source. */
+      while (best_target_vertex != -1 &&
+             !ELEM(doubles_map[best_target_vertex], -1, best_target_vertex)) {
+        if (compare_len_v3v3(mverts[sve_source->vertex_num].co,
+                             mverts[doubles_map[best_target_vertex]].co,
+                             dist)) {
+          best_target_vertex = doubles_map[best_target_vertex];
+        }
+        else {
+          best_target_vertex = -1;
+        }
+      }
+    }
+    sve_target++;
+  }
+  return best_target_vertex;
+}
+
+typedef struct MapDoublesData {
+  int *doubles_map;
+  const MVert *mverts;
+  const SortVertsElem *sorted_verts_target;
+  const SortVertsElem *sorted_verts_source;
+  int target_num_verts;
+  float dist, dist3;
+} MapDoublesData;
+
+static void dm_mvert_map_doubles_cb(void *__restrict userdata,
+                                    const int i_source,
+                                    const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const MapDoublesData *data = userdata;
+  const SortVertsElem *sve_source = &data->sorted_verts_source[i_source];
+  const float sumco_low = sum_v3(sve_source->co) - data->dist3;
+  int low = 0, high = data->target_num_verts;
+
+  /* If source has already been assigned to a target (in an earlier call, with other chunks) */
+  if (data->doubles_map[sve_source->vertex_num] != -1) {
+    return;
+  }
+
+  /* Binary search of the first target vertex no more than dist3 lower in terms of sumco. */
+  while (low < high) {
+    const int mid = (low + high) / 2;
+    if (data->sorted_verts_target[mid].sum_co < sumco_low) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+
+  data->doubles_map[sve_source->vertex_num] = svert_find_double(
+      data->doubles_map,
+      data->mverts,
+      sve_source,
+      &data->sorted_verts_target[low],
+      &data->sorted_verts_target[data->target_num_verts],
+      data->dist,
+      data->dist3);
+}
+
 /**
  * Take as inputs two sets of verts, to be processed for detection of doubles and mapping.
  * Each set of verts is defined by its start within mverts array and its num_verts;
  * It builds a mapping for all vertices within source,
  * to vertices within target, or -1 if no double found.
  * The int doubles_map[num_verts_source] array must have been allocated by caller.
+ *
+ * \param use_threading: Scan source vertices in parallel, only valid when following
+ * the mapping of target vertices can never lead to source vertices.
  */
 static void dm_mvert_map_doubles(int *doubles_map,
                                  const MVert *mverts,
@@ -158,12 +261,13 @@ static void dm_mvert_map_doubles(int *doubles_map,
                                  const int target_num_verts,
                                  const int source_start,
                                  const int source_num_verts,
-                                 const float dist)
+                                 const float dist,
+                                 const bool use_threading)
 {
   const float dist3 = ((float)M_SQRT3 + 0.00005f) * dist; /* Just above sqrt(3) */
-  int i_source, i_target, i_target_low_bound, target_end, source_end;
+  int i_source, i_target_low_bound, target_end, source_end;
   SortVertsElem *sorted_verts_target, *sorted_verts_source;
-  SortVertsElem *sve_source, *sve_target, *sve_target_low_bound;
+  SortVertsElem *sve_source, *sve_target_low_bound;
   bool target_scan_completed;
 
   target_end = target_start + target_num_verts;
@@ -183,6 +287,25 @@ static void dm_mvert_map_doubles(int *doubles_map,
   qsort(sorted_verts_target, target_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
   qsort(sorted_verts_source, source_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
 
+  if (use_threading && (source_num_verts > ARRAY_PARALLEL_THRESHOLD)) {
+    MapDoublesData data = {
+        .doubles_map = doubles_map,
+        .mverts = mverts,
+        .sorted_verts_target = sorted_verts_target,
+        .sorted_verts_source = sorted_verts_source,
+        .target_num_verts = target_num_verts,
+        .dist = dist,
+        .dist3 = dist3,
+    };
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    BLI_task_parallel_range(0, source_num_verts, &data, dm_mvert_map_doubles_cb, &settings);
+
+    MEM_freeN(sorted_verts_source);
+    MEM_freeN(sorted_verts_target);
+    return;
+  }
+
   sve_target_low_bound = sorted_verts_target;
   i_target_low_bound = 0;
   target_scan_completed = false;
@@ -191,8 +314,6 @@ static void dm_mvert_map_doubles(int *doubles_map,
   /* all the while maintaining the lower bound of possible doubles in target vertices */
   for (i_source = 0, sve_source = sorted_verts_source; i_source < source_num_verts;
        i_source++, sve_source++) {
-    int best_target_vertex = -1;
-    float best_dist_sq = dist * dist;
     float sve_source_sumco;
 
     /* If source has already been assigned to a target (in an earlier call, with other chunks) */
@@ -223,49 +344,116 @@ static void dm_mvert_map_doubles(int *doubles_map,
     }
     /* Test target candidates starting at the low bound of possible doubles,
      * ordered in terms of sumco. */
-    i_target = i_target_low_bound;
-    sve_target = sve_target_low_bound;
-
-    /* i_target will scan vertices in the
-     * [v_source_sumco - dist3;  v_source_sumco + dist3] range */
-
-    while ((i_target < target_num_verts) && (sve_target->sum_co <= sve_source_sumco + dist3)) {
-      /* Testing distance for candidate double in target */
-      /* v_target is within dist3 of v_source in terms of sumco;  check real distance */
-      float dist_sq;
-      if ((dist_sq = len_squared_v3v3(sve_source->co, sve_target->co)) <= best_dist_sq) {
-        /* Potential double found */
-        best_dist_sq = dist_sq;
-        best_target_vertex = sve_target->vertex_num;
-
-        /* If target is already mapped, we only follow that mapping if final target remains
-         * close enough from current vert (otherwise no mapping at all).
-         * Note that if we later find another target closer than this one, then we check it.
-         * But if other potential targets are farther,
-         * then there will be no mapping at all for this source. */
-        while (best_target_vertex != -1 &&
-               !ELEM(doubles_map[best_target_vertex], -1, best_target_vertex)) {
-          if (compare_len_v3v3(mverts[sve_source->vertex_num].co,
-                               mverts[doubles_map[best_target_vertex]].co,
-                               dist)) {
-            best_target_vertex = doubles_map[best_target_vertex];
-          }
-          else {
-            best_target_vertex = -1;
-          }
-        }
-      }
-      i_target++;
-      sve_target++;
-    }
-    /* End of candidate scan: if none found then no doubles */
-    doubles_map[sve_source->vertex_num] = best_target_vertex;
+    doubles_map[sve_source->vertex_num] = svert_find_double(doubles_map,
+                                                            mverts,
+                                                            sve_source,
+                                                            sve_target_low_bound,
+                                                            sorted_verts_target + target_num_verts,
+                                                            dist,
+                                                            dist3);
   }
 
   MEM_freeN(sorted_verts_source);
   MEM_freeN(sorted_verts_target);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Threaded Copies
+ *
+ * Every copy only writes its own range of the result,
+ * at offsets known in advance, so all copies are generated in parallel.
+ * \{ */
+
+typedef struct ArrayCopyData {
+  const Mesh *mesh;
+  Mesh *result;
+  /** Cumulative offset of each copy. */
+  float (*copy_offsets)[4][4];
+  int chunk_nverts, chunk_nedges, chunk_nloops, chunk_npolys;
+  bool use_recalc_normals;
+  bool use_uv_offset;
+  float uv_offset[2];
+} ArrayCopyData;
+
+static void array_copy_cb(void *__restrict userdata,
+                          const int c,
+                          const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const ArrayCopyData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  Mesh *result = data->result;
+  const int chunk_nverts = data->chunk_nverts;
+  const int chunk_nedges = data->chunk_nedges;
+  const int chunk_nloops = data->chunk_nloops;
+  const int chunk_npolys = data->chunk_npolys;
+  float(*current_offset)[4] = data->copy_offsets[c];
+  MVert *mv;
+  MEdge *me;
+  MLoop *ml;
+  MPoly *mp;
+  int i;
+
+  /* copy customdata to new geometry */
+  CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
+  CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
+  CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
+  CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
+
+  /* apply offset to all new verts */
+  mv = result->mvert + c * chunk_nverts;
+  for (i = 0; i < chunk_nverts; i++, mv++) {
+    mul_m4_v3(current_offset, mv->co);
+
+    /* We have to correct normals too, if we do not tag them as dirty! */
+    if (!data->use_recalc_normals) {
+      float no[3];
+      normal_short_to_float_v3(no, mv->no);
+      mul_mat3_m4_v3(current_offset, no);
+      normalize_v3(no);
+      normal_float_to_short_v3(mv->no, no);
+    }
+  }
+
+  /* adjust edge vertex indices */
+  me = result->medge + c * chunk_nedges;
+  for (i = 0; i < chunk_nedges; i++, me++) {
+    me->v1 += c * chunk_nverts;
+    me->v2 += c * chunk_nverts;
+  }
+
+  mp = result->mpoly + c * chunk_npolys;
+  for (i = 0; i < chunk_npolys; i++, mp++) {
+    mp->loopstart += c * chunk_nloops;
+  }
+
+  /* adjust loop vertex and edge indices */
+  ml = result->mloop + c * chunk_nloops;
+  for (i = 0; i < chunk_nloops; i++, ml++) {
+    ml->v += c * chunk_nverts;
+    ml->e += c * chunk_nedges;
+  }
+
+  /* handle UVs */
+  if (data->use_uv_offset) {
+    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
+    const float uv_offset[2] = {
+        data->uv_offset[0] * (float)c,
+        data->uv_offset[1] * (float)c,
+    };
+    for (i = 0; i < totuv; i++) {
+      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
+      int l_index = chunk_nloops;
+      dmloopuv += c * chunk_nloops;
+      for (; l_index-- != 0; dmloopuv++) {
+        dmloopuv->uv[0] += uv_offset[0];
+        dmloopuv->uv[1] += uv_offset[1];
+      }
+    }
+  }
+}
+
+/** \} */
+
 static void mesh_merge_transform(Mesh *result,
                                  Mesh *cap_mesh,
                                  float cap_offset[4][4],
@@ -354,11 +542,8 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
 {
   const float eps = 1e-6f;
   const MVert *src_mvert;
-  MVert *mv, *mv_prev, *result_dm_verts;
+  MVert *result_dm_verts;
 
-  MEdge *me;
-  MLoop *ml;
-  MPoly *mp;
   int i, j, c, count;
   float length = amd->length;
   /* offset matrix */
@@ -367,6 +552,7 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
   bool offset_has_scale;
   float current_offset[4][4];
   float final_offset[4][4];
+  float(*copy_offsets)[4][4];
   int *full_doubles_map = NULL;
   int tot_doubles;
 
@@ -535,55 +721,37 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
   first_chunk_start = 0;
   first_chunk_nverts = chunk_nverts;
 
-  unit_m4(current_offset);
+  /* Cumulative offset of each copy, computed upfront so copies can be generated in parallel. */
+  copy_offsets = MEM_malloc_arrayN(count, sizeof(*copy_offsets), __func__);
+  unit_m4(copy_offsets[0]);
   for (c = 1; c < count; c++) {
-    /* copy customdata to new geometry */
-    CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
-    CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
-    CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
-    CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
-
-    mv_prev = result_dm_verts;
-    mv = mv_prev + c * chunk_nverts;
-
-    /* recalculate cumulative offset here */
-    mul_m4_m4m4(current_offset, current_offset, offset);
-
-    /* apply offset to all new verts */
-    for (i = 0; i < chunk_nverts; i++, mv++, mv_prev++) {
-      mul_m4_v3(current_offset, mv->co);
-
-      /* We have to correct normals too, if we do not tag them as dirty! */
-      if (!use_recalc_normals) {
-        float no[3];
-        normal_short_to_float_v3(no, mv->no);
-        mul_mat3_m4_v3(current_offset, no);
-        normalize_v3(no);
-        normal_float_to_short_v3(mv->no, no);
-      }
-    }
-
-    /* adjust edge vertex indices */
-    me = result->medge + c * chunk_nedges;
-    for (i = 0; i < chunk_nedges; i++, me++) {
-      me->v1 += c * chunk_nverts;
-      me->v2 += c * chunk_nverts;
-    }
-
-    mp = result->mpoly + c * chunk_npolys;
-    for (i = 0; i < chunk_npolys; i++, mp++) {
-      mp->loopstart += c * chunk_nloops;
-    }
-
-    /* adjust loop vertex and edge indices */
-    ml = result->mloop + c * chunk_nloops;
-    for (i = 0; i < chunk_nloops; i++, ml++) {
-      ml->v += c * chunk_nverts;
-      ml->e += c * chunk_nedges;
-    }
-
-    /* Handle merge between chunk n and n-1 */
-    if (use_merge && (c >= 1)) {
+    mul_m4_m4m4(copy_offsets[c], copy_offsets[c - 1], offset);
+  }
+  copy_m4_m4(current_offset, copy_offsets[count - 1]);
+
+  if (count > 1) {
+    ArrayCopyData data = {
+        .mesh = mesh,
+        .result = result,
+        .copy_offsets = copy_offsets,
+        .chunk_nverts = chunk_nverts,
+        .chunk_nedges = chunk_nedges,
+        .chunk_nloops = chunk_nloops,
+        .chunk_npolys = chunk_npolys,
+        .use_recalc_normals = use_recalc_normals,
+        .use_uv_offset = (chunk_nloops > 0 && is_zero_v2(amd->uv_offset) == false),
+    };
+    ParallelRangeSettings settings;
+    copy_v2_v2(data.uv_offset, amd->uv_offset);
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = ((chunk_nverts + chunk_nloops) * (count - 1) >
+                              ARRAY_PARALLEL_THRESHOLD);
+    BLI_task_parallel_range(1, count, &data, array_copy_cb, &settings);
+  }
+
+  /* Handle merge between chunk n and n-1 */
+  if (use_merge) {
+    for (c = 1; c < count; c++) {
       if (!offset_has_scale && (c >= 2)) {
         /* Mapping chunk 3 to chunk 2 is a translation of mapping 2 to 1
          * ... that is except if scaling makes the distance grow */
@@ -611,36 +779,20 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
         }
       }
       else {
+        /* Chunk n-1 is only mapped to previous chunks, never to chunk n. */
         dm_mvert_map_doubles(full_doubles_map,
                              result_dm_verts,
                              (c - 1) * chunk_nverts,
                              chunk_nverts,
                              c * chunk_nverts,
                              chunk_nverts,
-                             amd->merge_dist);
+                             amd->merge_dist,
+                             true);
       }
     }
   }
 
-  /* handle UVs */
-  if (chunk_nloops > 0 && is_zero_v2(amd->uv_offset) == false) {
-    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
-    for (i = 0; i < totuv; i++) {
-      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
-      dmloopuv += chunk_nloops;
-      for (c = 1; c < count; c++) {
-        const float uv_offset[2] = {
-            amd->uv_offset[0] * (float)c,
-            amd->uv_offset[1] * (float)c,
-        };
-        int l_index = chunk_nloops;
-        for (; l_index-- != 0; dmloopuv++) {
-          dmloopuv->uv[0] += uv_offset[0];
-          dmloopuv->uv[1] += uv_offset[1];
-        }
-      }
-    }
-  }
+  MEM_freeN(copy_offsets);
 
   last_chunk_start = (count - 1) * chunk_nverts;
   last_chunk_nverts = chunk_nverts;
@@ -655,7 +807,8 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                          last_chunk_nverts,
                          first_chunk_start,
                          first_chunk_nverts,
-                         amd->merge_dist);
+                         amd->merge_dist,
+                         false);
   }
 
   /* start capping */
@@ -684,7 +837,8 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                            first_chunk_nverts,
                            start_cap_start,
                            start_cap_nverts,
-                           amd->merge_dist);
+                           amd->merge_dist,
+                           false);
     }
   }
 
@@ -713,7 +867,8 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                            last_chunk_nverts,
                            end_cap_start,
                            end_cap_nverts,
-                           amd->merge_dist);
+                           amd->merge_dist,
+                           false);
     }
   }
   /* done capping */
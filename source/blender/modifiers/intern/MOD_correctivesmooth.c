@@ -26,6 +26,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_scene_types.h"
 #include "DNA_meshdata_types.h"
@@ -36,6 +37,7 @@
 
 #include "BKE_deform.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 #include "BKE_editmesh.h"
 #include "BKE_library.h"
 
@@ -168,13 +170,54 @@ static void mesh_get_boundaries(Mesh *mesh, float *smooth_weights)
   MEM_freeN(boundaries);
 }
 
+/* Minimum number of vertices before smoothing iterations are threaded. */
+#define CORRECTIVESMOOTH_PARALLEL_THRESHOLD 1024
+
+/* Shared by both smoothing methods, each iteration reads #co_src and writes #co_dst. */
+typedef struct SmoothIterData {
+  const MeshElemMap *vert_edge_vert_map;
+  float (*co_src)[3];
+  float (*co_dst)[3];
+  /* Simple: per vertex factor, weighted: neighbor counts. */
+  const float *vertex_edge_count;
+  const float *smooth_weights;
+  float lambda;
+} SmoothIterData;
+
+static void correctivesmooth_parallel_settings_init(ParallelRangeSettings *settings,
+                                                    unsigned int numVerts)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (numVerts > CORRECTIVESMOOTH_PARALLEL_THRESHOLD);
+  settings->min_iter_per_thread = 256;
+}
+
 /* -------------------------------------------------------------------- */
 /* Simple Weighted Smoothing
  *
  * (average of surrounding verts)
  */
+static void smooth_iter__simple_cb(void *__restrict userdata,
+                                   const int i,
+                                   const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const SmoothIterData *data = userdata;
+  const MeshElemMap *map = &data->vert_edge_vert_map[i];
+  const float *co = data->co_src[i];
+  float delta[3] = {0.0f, 0.0f, 0.0f};
+
+  for (int j = 0; j < map->count; j++) {
+    const float *co_other = data->co_src[map->indices[j]];
+    delta[0] += co_other[0] - co[0];
+    delta[1] += co_other[1] - co[1];
+    delta[2] += co_other[2] - co[2];
+  }
+
+  madd_v3_v3v3fl(data->co_dst[i], co, delta, data->vertex_edge_count[i]);
+}
+
 static void smooth_iter__simple(CorrectiveSmoothModifierData *csmd,
-                                Mesh *mesh,
+                                const MeshElemMap *vert_edge_vert_map,
                                 float (*vertexCos)[3],
                                 unsigned int numVerts,
                                 const float *smooth_weights,
@@ -183,164 +226,133 @@ static void smooth_iter__simple(CorrectiveSmoothModifierData *csmd,
   const float lambda = csmd->lambda;
   unsigned int i;
 
-  const unsigned int numEdges = (unsigned int)mesh->totedge;
-  const MEdge *edges = mesh->medge;
   float *vertex_edge_count_div;
+  float(*co_tmp)[3] = MEM_malloc_arrayN(numVerts, sizeof(*co_tmp), __func__);
 
-  struct SmoothingData_Simple {
-    float delta[3];
-  } *smooth_data = MEM_calloc_arrayN(numVerts, sizeof(*smooth_data), __func__);
-
-  vertex_edge_count_div = MEM_calloc_arrayN(numVerts, sizeof(float), __func__);
-
-  /* calculate as floats to avoid int->float conversion in #smooth_iter */
-  for (i = 0; i < numEdges; i++) {
-    vertex_edge_count_div[edges[i].v1] += 1.0f;
-    vertex_edge_count_div[edges[i].v2] += 1.0f;
-  }
+  vertex_edge_count_div = MEM_malloc_arrayN(numVerts, sizeof(float), __func__);
 
   /* a little confusing, but we can include 'lambda' and smoothing weight
    * here to avoid multiplying for every iteration */
-  if (smooth_weights == NULL) {
-    for (i = 0; i < numVerts; i++) {
-      vertex_edge_count_div[i] = lambda * (vertex_edge_count_div[i] ?
-                                               (1.0f / vertex_edge_count_div[i]) :
-                                               1.0f);
-    }
-  }
-  else {
-    for (i = 0; i < numVerts; i++) {
-      vertex_edge_count_div[i] = smooth_weights[i] * lambda *
-                                 (vertex_edge_count_div[i] ? (1.0f / vertex_edge_count_div[i]) :
-                                                             1.0f);
+  for (i = 0; i < numVerts; i++) {
+    const int count = vert_edge_vert_map[i].count;
+    vertex_edge_count_div[i] = lambda * (count ? (1.0f / (float)count) : 1.0f);
+    if (smooth_weights) {
+      vertex_edge_count_div[i] *= smooth_weights[i];
     }
   }
 
   /* -------------------------------------------------------------------- */
   /* Main Smoothing Loop */
 
-  while (iterations--) {
-    for (i = 0; i < numEdges; i++) {
-      struct SmoothingData_Simple *sd_v1;
-      struct SmoothingData_Simple *sd_v2;
-      float edge_dir[3];
-
-      sub_v3_v3v3(edge_dir, vertexCos[edges[i].v2], vertexCos[edges[i].v1]);
-
-      sd_v1 = &smooth_data[edges[i].v1];
-      sd_v2 = &smooth_data[edges[i].v2];
+  SmoothIterData data = {
+      .vert_edge_vert_map = vert_edge_vert_map,
+      .co_src = vertexCos,
+      .co_dst = co_tmp,
+      .vertex_edge_count = vertex_edge_count_div,
+  };
+  float(*co_swap)[3];
+  ParallelRangeSettings settings;
+  correctivesmooth_parallel_settings_init(&settings, numVerts);
 
-      add_v3_v3(sd_v1->delta, edge_dir);
-      sub_v3_v3(sd_v2->delta, edge_dir);
-    }
+  while (iterations--) {
+    BLI_task_parallel_range(0, (int)numVerts, &data, smooth_iter__simple_cb, &settings);
+    SWAP_TVAL(co_swap, data.co_src, data.co_dst);
+  }
 
-    for (i = 0; i < numVerts; i++) {
-      struct SmoothingData_Simple *sd = &smooth_data[i];
-      madd_v3_v3fl(vertexCos[i], sd->delta, vertex_edge_count_div[i]);
-      /* zero for the next iteration (saves memset on entire array) */
-      memset(sd, 0, sizeof(*sd));
-    }
+  if (data.co_src != vertexCos) {
+    memcpy(vertexCos, data.co_src, sizeof(*vertexCos) * numVerts);
   }
 
   MEM_freeN(vertex_edge_count_div);
-  MEM_freeN(smooth_data);
+  MEM_freeN(co_tmp);
 }
 
 /* -------------------------------------------------------------------- */
 /* Edge-Length Weighted Smoothing
  */
+static void smooth_iter__length_weight_cb(void *__restrict userdata,
+                                          const int i,
+                                          const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const float eps = FLT_EPSILON * 10.0f;
+  const SmoothIterData *data = userdata;
+  const MeshElemMap *map = &data->vert_edge_vert_map[i];
+  const float *co = data->co_src[i];
+  float delta[3] = {0.0f, 0.0f, 0.0f};
+  float edge_length_sum = 0.0f;
+
+  for (int j = 0; j < map->count; j++) {
+    float edge_dir[3];
+    float edge_dist;
+
+    sub_v3_v3v3(edge_dir, data->co_src[map->indices[j]], co);
+    edge_dist = len_v3(edge_dir);
+
+    /* weight by distance */
+    madd_v3_v3fl(delta, edge_dir, edge_dist);
+    edge_length_sum += edge_dist;
+  }
+
+  /* Divide by sum of all neighbour distances (weighted) and amount of neighbors,
+   * (mean average). */
+  const float div = edge_length_sum * data->vertex_edge_count[i];
+  if (div > eps) {
+    const float lambda_w = data->smooth_weights ? data->lambda * data->smooth_weights[i] :
+                                                  data->lambda;
+    madd_v3_v3v3fl(data->co_dst[i], co, delta, lambda_w / div);
+  }
+  else {
+    copy_v3_v3(data->co_dst[i], co);
+  }
+}
+
 static void smooth_iter__length_weight(CorrectiveSmoothModifierData *csmd,
-                                       Mesh *mesh,
+                                       const MeshElemMap *vert_edge_vert_map,
                                        float (*vertexCos)[3],
                                        unsigned int numVerts,
                                        const float *smooth_weights,
                                        unsigned int iterations)
 {
-  const float eps = FLT_EPSILON * 10.0f;
-  const unsigned int numEdges = (unsigned int)mesh->totedge;
   /* note: the way this smoothing method works, its approx half as strong as the simple-smooth,
    * and 2.0 rarely spikes, double the value for consistent behavior. */
   const float lambda = csmd->lambda * 2.0f;
-  const MEdge *edges = mesh->medge;
   float *vertex_edge_count;
   unsigned int i;
 
-  struct SmoothingData_Weighted {
-    float delta[3];
-    float edge_length_sum;
-  } *smooth_data = MEM_calloc_arrayN(numVerts, sizeof(*smooth_data), __func__);
+  float(*co_tmp)[3] = MEM_malloc_arrayN(numVerts, sizeof(*co_tmp), __func__);
 
   /* calculate as floats to avoid int->float conversion in #smooth_iter */
-  vertex_edge_count = MEM_calloc_arrayN(numVerts, sizeof(float), __func__);
-  for (i = 0; i < numEdges; i++) {
-    vertex_edge_count[edges[i].v1] += 1.0f;
-    vertex_edge_count[edges[i].v2] += 1.0f;
+  vertex_edge_count = MEM_malloc_arrayN(numVerts, sizeof(float), __func__);
+  for (i = 0; i < numVerts; i++) {
+    vertex_edge_count[i] = (float)vert_edge_vert_map[i].count;
   }
 
   /* -------------------------------------------------------------------- */
   /* Main Smoothing Loop */
 
-  while (iterations--) {
-    for (i = 0; i < numEdges; i++) {
-      struct SmoothingData_Weighted *sd_v1;
-      struct SmoothingData_Weighted *sd_v2;
-      float edge_dir[3];
-      float edge_dist;
-
-      sub_v3_v3v3(edge_dir, vertexCos[edges[i].v2], vertexCos[edges[i].v1]);
-      edge_dist = len_v3(edge_dir);
+  SmoothIterData data = {
+      .vert_edge_vert_map = vert_edge_vert_map,
+      .co_src = vertexCos,
+      .co_dst = co_tmp,
+      .vertex_edge_count = vertex_edge_count,
+      .smooth_weights = smooth_weights,
+      .lambda = lambda,
+  };
+  float(*co_swap)[3];
+  ParallelRangeSettings settings;
+  correctivesmooth_parallel_settings_init(&settings, numVerts);
 
-      /* weight by distance */
-      mul_v3_fl(edge_dir, edge_dist);
-
-      sd_v1 = &smooth_data[edges[i].v1];
-      sd_v2 = &smooth_data[edges[i].v2];
-
-      add_v3_v3(sd_v1->delta, edge_dir);
-      sub_v3_v3(sd_v2->delta, edge_dir);
-
-      sd_v1->edge_length_sum += edge_dist;
-      sd_v2->edge_length_sum += edge_dist;
-    }
+  while (iterations--) {
+    BLI_task_parallel_range(0, (int)numVerts, &data, smooth_iter__length_weight_cb, &settings);
+    SWAP_TVAL(co_swap, data.co_src, data.co_dst);
+  }
 
-    if (smooth_weights == NULL) {
-      /* fast-path */
-      for (i = 0; i < numVerts; i++) {
-        struct SmoothingData_Weighted *sd = &smooth_data[i];
-        /* Divide by sum of all neighbour distances (weighted) and amount of neighbors,
-         * (mean average). */
-        const float div = sd->edge_length_sum * vertex_edge_count[i];
-        if (div > eps) {
-#if 0
-          /* first calculate the new location */
-          mul_v3_fl(sd->delta, 1.0f / div);
-          /* then interpolate */
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda);
-#else
-          /* do this in one step */
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda / div);
-#endif
-        }
-        /* zero for the next iteration (saves memset on entire array) */
-        memset(sd, 0, sizeof(*sd));
-      }
-    }
-    else {
-      for (i = 0; i < numVerts; i++) {
-        struct SmoothingData_Weighted *sd = &smooth_data[i];
-        const float div = sd->edge_length_sum * vertex_edge_count[i];
-        if (div > eps) {
-          const float lambda_w = lambda * smooth_weights[i];
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda_w / div);
-        }
-
-        memset(sd, 0, sizeof(*sd));
-      }
-    }
+  if (data.co_src != vertexCos) {
+    memcpy(vertexCos, data.co_src, sizeof(*vertexCos) * numVerts);
   }
 
   MEM_freeN(vertex_edge_count);
-  MEM_freeN(smooth_data);
+  MEM_freeN(co_tmp);
 }
 
 static void smooth_iter(CorrectiveSmoothModifierData *csmd,
@@ -350,16 +362,28 @@ static void smooth_iter(CorrectiveSmoothModifierData *csmd,
                         const float *smooth_weights,
                         unsigned int iterations)
 {
+  MeshElemMap *vert_edge_vert_map;
+  int *vert_edge_vert_mem;
+
+  /* Neighbors of each vertex stored contiguously, so iterations gather per vertex. */
+  BKE_mesh_vert_edge_vert_map_create(
+      &vert_edge_vert_map, &vert_edge_vert_mem, mesh->medge, (int)numVerts, mesh->totedge);
+
   switch (csmd->smooth_type) {
     case MOD_CORRECTIVESMOOTH_SMOOTH_LENGTH_WEIGHT:
-      smooth_iter__length_weight(csmd, mesh, vertexCos, numVerts, smooth_weights, iterations);
+      smooth_iter__length_weight(
+          csmd, vert_edge_vert_map, vertexCos, numVerts, smooth_weights, iterations);
       break;
 
     /* case MOD_CORRECTIVESMOOTH_SMOOTH_SIMPLE: */
     default:
-      smooth_iter__simple(csmd, mesh, vertexCos, numVerts, smooth_weights, iterations);
+      smooth_iter__simple(
+          csmd, vert_edge_vert_map, vertexCos, numVerts, smooth_weights, iterations);
       break;
   }
+
+  MEM_freeN(vert_edge_vert_map);
+  MEM_freeN(vert_edge_vert_mem);
 }
 
 static void smooth_verts(CorrectiveSmoothModifierData *csmd,
@@ -502,6 +526,31 @@ static void calc_tangent_spaces(Mesh *mesh, float (*vertexCos)[3], float (*r_tan
 #endif
 }
 
+typedef struct CalcDeltasData {
+  const float (*rest_coords)[3];
+  const float (*smooth_vertex_coords)[3];
+  float (*tangent_spaces)[3][3];
+  float (*delta_cache)[3];
+} CalcDeltasData;
+
+static void calc_deltas_cb(void *__restrict userdata,
+                           const int i,
+                           const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const CalcDeltasData *data = userdata;
+  float imat[3][3], delta[3];
+
+#ifdef USE_TANGENT_CALC_INLINE
+  calc_tangent_ortho(data->tangent_spaces[i]);
+#endif
+
+  sub_v3_v3v3(delta, data->rest_coords[i], data->smooth_vertex_coords[i]);
+  if (UNLIKELY(!invert_m3_m3(imat, data->tangent_spaces[i]))) {
+    transpose_m3_m3(imat, data->tangent_spaces[i]);
+  }
+  mul_v3_m3v3(data->delta_cache[i], imat, delta);
+}
+
 /**
  * This calculates #CorrectiveSmoothModifierData.delta_cache
  * It's not run on every update (during animation for example).
@@ -515,7 +564,6 @@ static void calc_deltas(CorrectiveSmoothModifierData *csmd,
 {
   float(*smooth_vertex_coords)[3] = MEM_dupallocN(rest_coords);
   float(*tangent_spaces)[3][3];
-  unsigned int i;
 
   tangent_spaces = MEM_calloc_arrayN(numVerts, sizeof(float[3][3]), __func__);
 
@@ -533,22 +581,39 @@ static void calc_deltas(CorrectiveSmoothModifierData *csmd,
 
   calc_tangent_spaces(mesh, smooth_vertex_coords, tangent_spaces);
 
-  for (i = 0; i < numVerts; i++) {
-    float imat[3][3], delta[3];
+  CalcDeltasData data = {
+      .rest_coords = rest_coords,
+      .smooth_vertex_coords = (const float(*)[3])smooth_vertex_coords,
+      .tangent_spaces = tangent_spaces,
+      .delta_cache = csmd->delta_cache,
+  };
+  ParallelRangeSettings settings;
+  correctivesmooth_parallel_settings_init(&settings, numVerts);
+  BLI_task_parallel_range(0, (int)numVerts, &data, calc_deltas_cb, &settings);
+
+  MEM_freeN(tangent_spaces);
+  MEM_freeN(smooth_vertex_coords);
+}
+
+typedef struct ApplyDeltasData {
+  float (*vertexCos)[3];
+  float (*tangent_spaces)[3][3];
+  const float (*delta_cache)[3];
+} ApplyDeltasData;
+
+static void apply_deltas_cb(void *__restrict userdata,
+                            const int i,
+                            const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const ApplyDeltasData *data = userdata;
+  float delta[3];
 
 #ifdef USE_TANGENT_CALC_INLINE
-    calc_tangent_ortho(tangent_spaces[i]);
+  calc_tangent_ortho(data->tangent_spaces[i]);
 #endif
 
-    sub_v3_v3v3(delta, rest_coords[i], smooth_vertex_coords[i]);
-    if (UNLIKELY(!invert_m3_m3(imat, tangent_spaces[i]))) {
-      transpose_m3_m3(imat, tangent_spaces[i]);
-    }
-    mul_v3_m3v3(csmd->delta_cache[i], imat, delta);
-  }
-
-  MEM_freeN(tangent_spaces);
-  MEM_freeN(smooth_vertex_coords);
+  mul_v3_m3v3(delta, data->tangent_spaces[i], data->delta_cache[i]);
+  add_v3_v3(data->vertexCos[i], delta);
 }
 
 static void correctivesmooth_modifier_do(ModifierData *md,
@@ -673,8 +738,6 @@ static void correctivesmooth_modifier_do(ModifierData *md,
   smooth_verts(csmd, mesh, dvert, defgrp_index, vertexCos, numVerts);
 
   {
-    unsigned int i;
-
     float(*tangent_spaces)[3][3];
 
     /* calloc, since values are accumulated */
@@ -682,16 +745,14 @@ static void correctivesmooth_modifier_do(ModifierData *md,
 
     calc_tangent_spaces(mesh, vertexCos, tangent_spaces);
 
-    for (i = 0; i < numVerts; i++) {
-      float delta[3];
-
-#ifdef USE_TANGENT_CALC_INLINE
-      calc_tangent_ortho(tangent_spaces[i]);
-#endif
-
-      mul_v3_m3v3(delta, tangent_spaces[i], csmd->delta_cache[i]);
-      add_v3_v3(vertexCos[i], delta);
-    }
+    ApplyDeltasData data = {
+        .vertexCos = vertexCos,
+        .tangent_spaces = tangent_spaces,
+        .delta_cache = (const float(*)[3])csmd->delta_cache,
+    };
+    ParallelRangeSettings settings;
+    correctivesmooth_parallel_settings_init(&settings, numVerts);
+    BLI_task_parallel_range(0, (int)numVerts, &data, apply_deltas_cb, &settings);
 
     MEM_freeN(tangent_spaces);
   }
@@ -25,6 +25,7 @@
 
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 
 #include "MEM_guardedalloc.h"
@@ -54,6 +55,9 @@ enum {
   LAPDEFORM_SYSTEM_CHANGE_NOT_VALID_GROUP,
 };
 
+/* Minimum number of vertices before per-vertex passes are threaded. */
+#define LAPDEFORM_PARALLEL_THRESHOLD 1024
+
 typedef struct LaplacianSystem {
   bool is_matrix_computed;
   bool has_solution;
@@ -298,102 +302,171 @@ static void initLaplacianMatrix(LaplacianSystem *sys)
   }
 }
 
-static void computeImplictRotations(LaplacianSystem *sys)
+static void computeImplictRotations_cb(void *__restrict userdata,
+                                       const int i,
+                                       const ParallelRangeTLS *__restrict UNUSED(tls))
 {
-  int vid, *vidn = NULL;
-  float minj, mjt, qj[3], vj[3];
-  int i, j, ln;
-
-  for (i = 0; i < sys->total_verts; i++) {
-    normalize_v3(sys->no[i]);
-    vidn = sys->ringv_map[i].indices;
-    ln = sys->ringv_map[i].count;
-    minj = 1000000.0f;
-    for (j = 0; j < ln; j++) {
-      vid = vidn[j];
-      copy_v3_v3(qj, sys->co[vid]);
-      sub_v3_v3v3(vj, qj, sys->co[i]);
-      normalize_v3(vj);
-      mjt = fabsf(dot_v3v3(vj, sys->no[i]));
-      if (mjt < minj) {
-        minj = mjt;
-        sys->unit_verts[i] = vidn[j];
-      }
+  LaplacianSystem *sys = userdata;
+  const int *vidn = sys->ringv_map[i].indices;
+  const int ln = sys->ringv_map[i].count;
+  float minj, mjt, vj[3];
+  int j;
+
+  normalize_v3(sys->no[i]);
+  minj = 1000000.0f;
+  for (j = 0; j < ln; j++) {
+    sub_v3_v3v3(vj, sys->co[vidn[j]], sys->co[i]);
+    normalize_v3(vj);
+    mjt = fabsf(dot_v3v3(vj, sys->no[i]));
+    if (mjt < minj) {
+      minj = mjt;
+      sys->unit_verts[i] = vidn[j];
     }
   }
 }
 
-static void rotateDifferentialCoordinates(LaplacianSystem *sys)
+static void computeImplictRotations(LaplacianSystem *sys)
 {
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (sys->total_verts > LAPDEFORM_PARALLEL_THRESHOLD);
+  BLI_task_parallel_range(0, sys->total_verts, sys, computeImplictRotations_cb, &settings);
+}
+
+/**
+ * Each vertex only reads the previous solution and writes its own right hand side rows,
+ * which is threadsafe once the solver matrix has been built.
+ */
+static void rotateDifferentialCoordinates_cb(void *__restrict userdata,
+                                             const int i,
+                                             const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  LaplacianSystem *sys = userdata;
   float alpha, beta, gamma;
   float pj[3], ni[3], di[3];
   float uij[3], dun[3], e2[3], pi[3], fni[3], vn[3][3];
-  int i, j, num_fni, k, fi;
+  int j, num_fni, k, fi;
   int *fidn;
 
-  for (i = 0; i < sys->total_verts; i++) {
-    copy_v3_v3(pi, sys->co[i]);
-    copy_v3_v3(ni, sys->no[i]);
-    k = sys->unit_verts[i];
-    copy_v3_v3(pj, sys->co[k]);
-    sub_v3_v3v3(uij, pj, pi);
-    mul_v3_v3fl(dun, ni, dot_v3v3(uij, ni));
-    sub_v3_v3(uij, dun);
-    normalize_v3(uij);
-    cross_v3_v3v3(e2, ni, uij);
-    copy_v3_v3(di, sys->delta[i]);
-    alpha = dot_v3v3(ni, di);
-    beta = dot_v3v3(uij, di);
-    gamma = dot_v3v3(e2, di);
-
-    pi[0] = EIG_linear_solver_variable_get(sys->context, 0, i);
-    pi[1] = EIG_linear_solver_variable_get(sys->context, 1, i);
-    pi[2] = EIG_linear_solver_variable_get(sys->context, 2, i);
-    zero_v3(ni);
-    num_fni = sys->ringf_map[i].count;
-    for (fi = 0; fi < num_fni; fi++) {
-      const unsigned int *vin;
-      fidn = sys->ringf_map[i].indices;
-      vin = sys->tris[fidn[fi]];
-      for (j = 0; j < 3; j++) {
-        vn[j][0] = EIG_linear_solver_variable_get(sys->context, 0, vin[j]);
-        vn[j][1] = EIG_linear_solver_variable_get(sys->context, 1, vin[j]);
-        vn[j][2] = EIG_linear_solver_variable_get(sys->context, 2, vin[j]);
-        if (vin[j] == sys->unit_verts[i]) {
-          copy_v3_v3(pj, vn[j]);
-        }
+  copy_v3_v3(pi, sys->co[i]);
+  copy_v3_v3(ni, sys->no[i]);
+  k = sys->unit_verts[i];
+  copy_v3_v3(pj, sys->co[k]);
+  sub_v3_v3v3(uij, pj, pi);
+  mul_v3_v3fl(dun, ni, dot_v3v3(uij, ni));
+  sub_v3_v3(uij, dun);
+  normalize_v3(uij);
+  cross_v3_v3v3(e2, ni, uij);
+  copy_v3_v3(di, sys->delta[i]);
+  alpha = dot_v3v3(ni, di);
+  beta = dot_v3v3(uij, di);
+  gamma = dot_v3v3(e2, di);
+
+  pi[0] = EIG_linear_solver_variable_get(sys->context, 0, i);
+  pi[1] = EIG_linear_solver_variable_get(sys->context, 1, i);
+  pi[2] = EIG_linear_solver_variable_get(sys->context, 2, i);
+  zero_v3(ni);
+  num_fni = sys->ringf_map[i].count;
+  for (fi = 0; fi < num_fni; fi++) {
+    const unsigned int *vin;
+    fidn = sys->ringf_map[i].indices;
+    vin = sys->tris[fidn[fi]];
+    for (j = 0; j < 3; j++) {
+      vn[j][0] = EIG_linear_solver_variable_get(sys->context, 0, vin[j]);
+      vn[j][1] = EIG_linear_solver_variable_get(sys->context, 1, vin[j]);
+      vn[j][2] = EIG_linear_solver_variable_get(sys->context, 2, vin[j]);
+      if (vin[j] == sys->unit_verts[i]) {
+        copy_v3_v3(pj, vn[j]);
       }
-
-      normal_tri_v3(fni, UNPACK3(vn));
-      add_v3_v3(ni, fni);
     }
 
-    normalize_v3(ni);
-    sub_v3_v3v3(uij, pj, pi);
-    mul_v3_v3fl(dun, ni, dot_v3v3(uij, ni));
-    sub_v3_v3(uij, dun);
-    normalize_v3(uij);
-    cross_v3_v3v3(e2, ni, uij);
-    fni[0] = alpha * ni[0] + beta * uij[0] + gamma * e2[0];
-    fni[1] = alpha * ni[1] + beta * uij[1] + gamma * e2[1];
-    fni[2] = alpha * ni[2] + beta * uij[2] + gamma * e2[2];
-
-    if (len_squared_v3(fni) > FLT_EPSILON) {
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, i, fni[0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, i, fni[1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, i, fni[2]);
+    normal_tri_v3(fni, UNPACK3(vn));
+    add_v3_v3(ni, fni);
+  }
+
+  normalize_v3(ni);
+  sub_v3_v3v3(uij, pj, pi);
+  mul_v3_v3fl(dun, ni, dot_v3v3(uij, ni));
+  sub_v3_v3(uij, dun);
+  normalize_v3(uij);
+  cross_v3_v3v3(e2, ni, uij);
+  fni[0] = alpha * ni[0] + beta * uij[0] + gamma * e2[0];
+  fni[1] = alpha * ni[1] + beta * uij[1] + gamma * e2[1];
+  fni[2] = alpha * ni[2] + beta * uij[2] + gamma * e2[2];
+
+  if (len_squared_v3(fni) > FLT_EPSILON) {
+    EIG_linear_solver_right_hand_side_add(sys->context, 0, i, fni[0]);
+    EIG_linear_solver_right_hand_side_add(sys->context, 1, i, fni[1]);
+    EIG_linear_solver_right_hand_side_add(sys->context, 2, i, fni[2]);
+  }
+  else {
+    EIG_linear_solver_right_hand_side_add(sys->context, 0, i, sys->delta[i][0]);
+    EIG_linear_solver_right_hand_side_add(sys->context, 1, i, sys->delta[i][1]);
+    EIG_linear_solver_right_hand_side_add(sys->context, 2, i, sys->delta[i][2]);
+  }
+}
+
+static void rotateDifferentialCoordinates(LaplacianSystem *sys)
+{
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (sys->total_verts > LAPDEFORM_PARALLEL_THRESHOLD);
+  BLI_task_parallel_range(0, sys->total_verts, sys, rotateDifferentialCoordinates_cb, &settings);
+}
+
+/**
+ * Solve for the current anchor positions, only the right hand side is filled in,
+ * the matrix and its factorization are kept by the solver between evaluations.
+ */
+static void laplacianDeformSolve(LaplacianSystem *sys, float (*vertexCos)[3])
+{
+  int vid, i, j, n, na;
+  n = sys->total_verts;
+  na = sys->total_anchors;
+
+  for (i = 0; i < n; i++) {
+    EIG_linear_solver_right_hand_side_add(sys->context, 0, i, sys->delta[i][0]);
+    EIG_linear_solver_right_hand_side_add(sys->context, 1, i, sys->delta[i][1]);
+    EIG_linear_solver_right_hand_side_add(sys->context, 2, i, sys->delta[i][2]);
+  }
+  for (i = 0; i < na; i++) {
+    vid = sys->index_anchors[i];
+    EIG_linear_solver_right_hand_side_add(sys->context, 0, n + i, vertexCos[vid][0]);
+    EIG_linear_solver_right_hand_side_add(sys->context, 1, n + i, vertexCos[vid][1]);
+    EIG_linear_solver_right_hand_side_add(sys->context, 2, n + i, vertexCos[vid][2]);
+  }
+
+  if (!EIG_linear_solver_solve(sys->context)) {
+    sys->has_solution = false;
+    return;
+  }
+
+  sys->has_solution = true;
+  for (j = 1; j <= sys->repeat; j++) {
+    rotateDifferentialCoordinates(sys);
+
+    for (i = 0; i < na; i++) {
+      vid = sys->index_anchors[i];
+      EIG_linear_solver_right_hand_side_add(sys->context, 0, n + i, vertexCos[vid][0]);
+      EIG_linear_solver_right_hand_side_add(sys->context, 1, n + i, vertexCos[vid][1]);
+      EIG_linear_solver_right_hand_side_add(sys->context, 2, n + i, vertexCos[vid][2]);
     }
-    else {
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, i, sys->delta[i][0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, i, sys->delta[i][1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, i, sys->delta[i][2]);
+    if (!EIG_linear_solver_solve(sys->context)) {
+      sys->has_solution = false;
+      return;
     }
   }
+
+  for (vid = 0; vid < sys->total_verts; vid++) {
+    vertexCos[vid][0] = EIG_linear_solver_variable_get(sys->context, 0, vid);
+    vertexCos[vid][1] = EIG_linear_solver_variable_get(sys->context, 1, vid);
+    vertexCos[vid][2] = EIG_linear_solver_variable_get(sys->context, 2, vid);
+  }
 }
 
 static void laplacianDeformPreview(LaplacianSystem *sys, float (*vertexCos)[3])
 {
-  int vid, i, j, n, na;
+  int vid, i, n, na;
   n = sys->total_verts;
   na = sys->total_anchors;
 
@@ -415,96 +488,16 @@ static void laplacianDeformPreview(LaplacianSystem *sys, float (*vertexCos)[3])
     initLaplacianMatrix(sys);
     computeImplictRotations(sys);
 
-    for (i = 0; i < n; i++) {
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, i, sys->delta[i][0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, i, sys->delta[i][1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, i, sys->delta[i][2]);
-    }
     for (i = 0; i < na; i++) {
       vid = sys->index_anchors[i];
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, n + i, vertexCos[vid][0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, n + i, vertexCos[vid][1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, n + i, vertexCos[vid][2]);
       EIG_linear_solver_matrix_add(sys->context, n + i, vid, 1.0f);
     }
-    if (EIG_linear_solver_solve(sys->context)) {
-      sys->has_solution = true;
-
-      for (j = 1; j <= sys->repeat; j++) {
-        rotateDifferentialCoordinates(sys);
-
-        for (i = 0; i < na; i++) {
-          vid = sys->index_anchors[i];
-          EIG_linear_solver_right_hand_side_add(sys->context, 0, n + i, vertexCos[vid][0]);
-          EIG_linear_solver_right_hand_side_add(sys->context, 1, n + i, vertexCos[vid][1]);
-          EIG_linear_solver_right_hand_side_add(sys->context, 2, n + i, vertexCos[vid][2]);
-        }
 
-        if (!EIG_linear_solver_solve(sys->context)) {
-          sys->has_solution = false;
-          break;
-        }
-      }
-      if (sys->has_solution) {
-        for (vid = 0; vid < sys->total_verts; vid++) {
-          vertexCos[vid][0] = EIG_linear_solver_variable_get(sys->context, 0, vid);
-          vertexCos[vid][1] = EIG_linear_solver_variable_get(sys->context, 1, vid);
-          vertexCos[vid][2] = EIG_linear_solver_variable_get(sys->context, 2, vid);
-        }
-      }
-      else {
-        sys->has_solution = false;
-      }
-    }
-    else {
-      sys->has_solution = false;
-    }
+    laplacianDeformSolve(sys, vertexCos);
     sys->is_matrix_computed = true;
   }
   else if (sys->has_solution) {
-    for (i = 0; i < n; i++) {
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, i, sys->delta[i][0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, i, sys->delta[i][1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, i, sys->delta[i][2]);
-    }
-    for (i = 0; i < na; i++) {
-      vid = sys->index_anchors[i];
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, n + i, vertexCos[vid][0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, n + i, vertexCos[vid][1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, n + i, vertexCos[vid][2]);
-      EIG_linear_solver_matrix_add(sys->context, n + i, vid, 1.0f);
-    }
-
-    if (EIG_linear_solver_solve(sys->context)) {
-      sys->has_solution = true;
-      for (j = 1; j <= sys->repeat; j++) {
-        rotateDifferentialCoordinates(sys);
-
-        for (i = 0; i < na; i++) {
-          vid = sys->index_anchors[i];
-          EIG_linear_solver_right_hand_side_add(sys->context, 0, n + i, vertexCos[vid][0]);
-          EIG_linear_solver_right_hand_side_add(sys->context, 1, n + i, vertexCos[vid][1]);
-          EIG_linear_solver_right_hand_side_add(sys->context, 2, n + i, vertexCos[vid][2]);
-        }
-        if (!EIG_linear_solver_solve(sys->context)) {
-          sys->has_solution = false;
-          break;
-        }
-      }
-      if (sys->has_solution) {
-        for (vid = 0; vid < sys->total_verts; vid++) {
-          vertexCos[vid][0] = EIG_linear_solver_variable_get(sys->context, 0, vid);
-          vertexCos[vid][1] = EIG_linear_solver_variable_get(sys->context, 1, vid);
-          vertexCos[vid][2] = EIG_linear_solver_variable_get(sys->context, 2, vid);
-        }
-      }
-      else {
-        sys->has_solution = false;
-      }
-    }
-    else {
-      sys->has_solution = false;
-    }
+    laplacianDeformSolve(sys, vertexCos);
   }
 }
 
@@ -24,6 +24,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -41,6 +42,9 @@
 
 #include "eigen_capi.h"
 
+/* Minimum number of vertices before per-vertex passes are threaded. */
+#define LAPLACIANSMOOTH_PARALLEL_THRESHOLD 1024
+
 struct BLaplacianSystem {
   float *eweights;      /* Length weights per Edge */
   float (*fweights)[3]; /* Cotangent weights per face */
@@ -169,27 +173,46 @@ static float compute_volume(const float center[3],
   return fabsf(vol);
 }
 
-static void volume_preservation(LaplacianSystem *sys, float vini, float vend, short flag)
-{
+typedef struct LaplacianSmoothVertsData {
+  LaplacianSystem *sys;
+  short flag;
+  float lambda, lambda_border;
   float beta;
-  int i;
+} LaplacianSmoothVertsData;
+
+static void volume_preservation_cb(void *__restrict userdata,
+                                   const int i,
+                                   const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const LaplacianSmoothVertsData *data = userdata;
+  LaplacianSystem *sys = data->sys;
 
+  if (data->flag & MOD_LAPLACIANSMOOTH_X) {
+    sys->vertexCos[i][0] = (sys->vertexCos[i][0] - sys->vert_centroid[0]) * data->beta +
+                           sys->vert_centroid[0];
+  }
+  if (data->flag & MOD_LAPLACIANSMOOTH_Y) {
+    sys->vertexCos[i][1] = (sys->vertexCos[i][1] - sys->vert_centroid[1]) * data->beta +
+                           sys->vert_centroid[1];
+  }
+  if (data->flag & MOD_LAPLACIANSMOOTH_Z) {
+    sys->vertexCos[i][2] = (sys->vertexCos[i][2] - sys->vert_centroid[2]) * data->beta +
+                           sys->vert_centroid[2];
+  }
+}
+
+static void volume_preservation(LaplacianSystem *sys, float vini, float vend, short flag)
+{
   if (vend != 0.0f) {
-    beta = pow(vini / vend, 1.0f / 3.0f);
-    for (i = 0; i < sys->numVerts; i++) {
-      if (flag & MOD_LAPLACIANSMOOTH_X) {
-        sys->vertexCos[i][0] = (sys->vertexCos[i][0] - sys->vert_centroid[0]) * beta +
-                               sys->vert_centroid[0];
-      }
-      if (flag & MOD_LAPLACIANSMOOTH_Y) {
-        sys->vertexCos[i][1] = (sys->vertexCos[i][1] - sys->vert_centroid[1]) * beta +
-                               sys->vert_centroid[1];
-      }
-      if (flag & MOD_LAPLACIANSMOOTH_Z) {
-        sys->vertexCos[i][2] = (sys->vertexCos[i][2] - sys->vert_centroid[2]) * beta +
-                               sys->vert_centroid[2];
-      }
-    }
+    LaplacianSmoothVertsData data = {
+        .sys = sys,
+        .flag = flag,
+        .beta = pow(vini / vend, 1.0f / 3.0f),
+    };
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (sys->numVerts > LAPLACIANSMOOTH_PARALLEL_THRESHOLD);
+    BLI_task_parallel_range(0, sys->numVerts, &data, volume_preservation_cb, &settings);
   }
 }
 
@@ -334,34 +357,52 @@ static void fill_laplacian_matrix(LaplacianSystem *sys)
   }
 }
 
-static void validate_solution(LaplacianSystem *sys, short flag, float lambda, float lambda_border)
+static void validate_solution_cb(void *__restrict userdata,
+                                 const int i,
+                                 const ParallelRangeTLS *__restrict UNUSED(tls))
 {
-  int i;
+  const LaplacianSmoothVertsData *data = userdata;
+  LaplacianSystem *sys = data->sys;
   float lam;
+
+  if (sys->zerola[i] == 0) {
+    lam = sys->numNeEd[i] == sys->numNeFa[i] ? (data->lambda >= 0.0f ? 1.0f : -1.0f) :
+                                               (data->lambda_border >= 0.0f ? 1.0f : -1.0f);
+    if (data->flag & MOD_LAPLACIANSMOOTH_X) {
+      sys->vertexCos[i][0] += lam * ((float)EIG_linear_solver_variable_get(sys->context, 0, i) -
+                                     sys->vertexCos[i][0]);
+    }
+    if (data->flag & MOD_LAPLACIANSMOOTH_Y) {
+      sys->vertexCos[i][1] += lam * ((float)EIG_linear_solver_variable_get(sys->context, 1, i) -
+                                     sys->vertexCos[i][1]);
+    }
+    if (data->flag & MOD_LAPLACIANSMOOTH_Z) {
+      sys->vertexCos[i][2] += lam * ((float)EIG_linear_solver_variable_get(sys->context, 2, i) -
+                                     sys->vertexCos[i][2]);
+    }
+  }
+}
+
+static void validate_solution(LaplacianSystem *sys, short flag, float lambda, float lambda_border)
+{
   float vini = 0.0f, vend = 0.0f;
 
   if (flag & MOD_LAPLACIANSMOOTH_PRESERVE_VOLUME) {
     vini = compute_volume(
         sys->vert_centroid, sys->vertexCos, sys->mpoly, sys->numPolys, sys->mloop);
   }
-  for (i = 0; i < sys->numVerts; i++) {
-    if (sys->zerola[i] == 0) {
-      lam = sys->numNeEd[i] == sys->numNeFa[i] ? (lambda >= 0.0f ? 1.0f : -1.0f) :
-                                                 (lambda_border >= 0.0f ? 1.0f : -1.0f);
-      if (flag & MOD_LAPLACIANSMOOTH_X) {
-        sys->vertexCos[i][0] += lam * ((float)EIG_linear_solver_variable_get(sys->context, 0, i) -
-                                       sys->vertexCos[i][0]);
-      }
-      if (flag & MOD_LAPLACIANSMOOTH_Y) {
-        sys->vertexCos[i][1] += lam * ((float)EIG_linear_solver_variable_get(sys->context, 1, i) -
-                                       sys->vertexCos[i][1]);
-      }
-      if (flag & MOD_LAPLACIANSMOOTH_Z) {
-        sys->vertexCos[i][2] += lam * ((float)EIG_linear_solver_variable_get(sys->context, 2, i) -
-                                       sys->vertexCos[i][2]);
-      }
-    }
-  }
+
+  LaplacianSmoothVertsData data = {
+      .sys = sys,
+      .flag = flag,
+      .lambda = lambda,
+      .lambda_border = lambda_border,
+  };
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (sys->numVerts > LAPLACIANSMOOTH_PARALLEL_THRESHOLD);
+  BLI_task_parallel_range(0, sys->numVerts, &data, validate_solution_cb, &settings);
+
   if (flag & MOD_LAPLACIANSMOOTH_PRESERVE_VOLUME) {
     vend = compute_volume(
         sys->vert_centroid, sys->vertexCos, sys->mpoly, sys->numPolys, sys->mloop);
@@ -22,6 +22,7 @@
  */
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -68,6 +69,104 @@ static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphConte
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Threaded Mirror
+ *
+ * Mirrored elements only depend on their own original,
+ * so vertices and polygons are mirrored in parallel ranges.
+ * \{ */
+
+/* Only use threads for meshes with more elements than this. */
+#define MIRROR_PARALLEL_THRESHOLD 10000
+
+typedef struct MirrorData {
+  Mesh *result;
+  float (*mtx)[4];
+  float tolerance_sq;
+  int maxVerts, maxLoops, maxPolys;
+  /* Merge map, NULL when merging is disabled. */
+  int *vtargetmap;
+  /* Total of merged vertices, accumulated on finalize. */
+  int tot_vtargetmap;
+} MirrorData;
+
+typedef struct MirrorVertsTLS {
+  int tot_vtargetmap;
+} MirrorVertsTLS;
+
+static void mirror_verts_cb(void *__restrict userdata,
+                            const int i,
+                            const ParallelRangeTLS *__restrict tls)
+{
+  const MirrorData *data = userdata;
+  MirrorVertsTLS *mirror_tls = tls->userdata_chunk;
+  MVert *mv_prev = &data->result->mvert[i];
+  MVert *mv = mv_prev + data->maxVerts;
+
+  mul_m4_v3(data->mtx, mv->co);
+
+  if (data->vtargetmap) {
+    /* compare location of the original and mirrored vertex, to see if they
+     * should be mapped for merging */
+    if (UNLIKELY(len_squared_v3v3(mv_prev->co, mv->co) < data->tolerance_sq)) {
+      data->vtargetmap[i] = data->maxVerts + i;
+      mirror_tls->tot_vtargetmap++;
+
+      /* average location */
+      mid_v3_v3v3(mv->co, mv_prev->co, mv->co);
+      copy_v3_v3(mv_prev->co, mv->co);
+    }
+    else {
+      data->vtargetmap[i] = -1;
+    }
+
+    data->vtargetmap[data->maxVerts + i] = -1; /* fill here to avoid 2x loops */
+  }
+}
+
+static void mirror_verts_finalize(void *__restrict userdata, void *__restrict userdata_chunk)
+{
+  MirrorData *data = userdata;
+  const MirrorVertsTLS *mirror_tls = userdata_chunk;
+  data->tot_vtargetmap += mirror_tls->tot_vtargetmap;
+}
+
+static void mirror_polys_cb(void *__restrict userdata,
+                            const int i,
+                            const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const MirrorData *data = userdata;
+  Mesh *result = data->result;
+  const int maxLoops = data->maxLoops;
+  MPoly *mp = &result->mpoly[data->maxPolys + i];
+  MLoop *ml2;
+  int j, e;
+
+  /* reverse the loop, but we keep the first vertex in the face the same,
+   * to ensure that quads are split the same way as on the other side */
+  CustomData_copy_data(
+      &result->ldata, &result->ldata, mp->loopstart, mp->loopstart + maxLoops, 1);
+
+  for (j = 1; j < mp->totloop; j++) {
+    CustomData_copy_data(&result->ldata,
+                         &result->ldata,
+                         mp->loopstart + j,
+                         mp->loopstart + maxLoops + mp->totloop - j,
+                         1);
+  }
+
+  ml2 = result->mloop + mp->loopstart + maxLoops;
+  e = ml2[0].e;
+  for (j = 0; j < mp->totloop - 1; j++) {
+    ml2[j].e = ml2[j + 1].e;
+  }
+  ml2[mp->totloop - 1].e = e;
+
+  mp->loopstart += maxLoops;
+}
+
+/** \} */
+
 static Mesh *doBiscetOnMirrorPlane(
     MirrorModifierData *mmd, const Mesh *mesh, int axis, float plane_co[3], float plane_no[3])
 {
@@ -136,15 +235,13 @@ static Mesh *doMirrorOnAxis(MirrorModifierData *mmd,
                           (axis == 2 && mmd->flag & MOD_MIR_BISECT_AXIS_Z));
 
   Mesh *result;
-  MVert *mv, *mv_prev;
   MEdge *me;
   MLoop *ml;
-  MPoly *mp;
   float mtx[4][4];
   float plane_co[3], plane_no[3];
   int i;
   int a, totshape;
-  int *vtargetmap = NULL, *vtmap_a = NULL, *vtmap_b = NULL;
+  int *vtargetmap = NULL;
 
   /* mtx is the mirror transformation */
   unit_m4(mtx);
@@ -222,37 +319,29 @@ static Mesh *doMirrorOnAxis(MirrorModifierData *mmd,
   if (do_vtargetmap) {
     /* second half is filled with -1 */
     vtargetmap = MEM_malloc_arrayN(maxVerts, 2 * sizeof(int), "MOD_mirror tarmap");
-
-    vtmap_a = vtargetmap;
-    vtmap_b = vtargetmap + maxVerts;
   }
 
   /* mirror vertex coordinates */
-  mv_prev = result->mvert;
-  mv = mv_prev + maxVerts;
-  for (i = 0; i < maxVerts; i++, mv++, mv_prev++) {
-    mul_m4_v3(mtx, mv->co);
-
-    if (do_vtargetmap) {
-      /* compare location of the original and mirrored vertex, to see if they
-       * should be mapped for merging */
-      if (UNLIKELY(len_squared_v3v3(mv_prev->co, mv->co) < tolerance_sq)) {
-        *vtmap_a = maxVerts + i;
-        tot_vtargetmap++;
-
-        /* average location */
-        mid_v3_v3v3(mv->co, mv_prev->co, mv->co);
-        copy_v3_v3(mv_prev->co, mv->co);
-      }
-      else {
-        *vtmap_a = -1;
-      }
-
-      *vtmap_b = -1; /* fill here to avoid 2x loops */
-
-      vtmap_a++;
-      vtmap_b++;
-    }
+  MirrorData data = {
+      .result = result,
+      .mtx = mtx,
+      .tolerance_sq = tolerance_sq,
+      .maxVerts = maxVerts,
+      .maxLoops = maxLoops,
+      .maxPolys = maxPolys,
+      .vtargetmap = vtargetmap,
+      .tot_vtargetmap = 0,
+  };
+  {
+    MirrorVertsTLS mirror_tls = {0};
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (maxVerts > MIRROR_PARALLEL_THRESHOLD);
+    settings.userdata_chunk = &mirror_tls;
+    settings.userdata_chunk_size = sizeof(mirror_tls);
+    settings.func_finalize = mirror_verts_finalize;
+    BLI_task_parallel_range(0, maxVerts, &data, mirror_verts_cb, &settings);
+    tot_vtargetmap = data.tot_vtargetmap;
   }
 
   /* handle shape keys */
@@ -272,33 +361,11 @@ static Mesh *doMirrorOnAxis(MirrorModifierData *mmd,
   }
 
   /* adjust mirrored poly loopstart indices, and reverse loop order (normals) */
-  mp = result->mpoly + maxPolys;
-  ml = result->mloop;
-  for (i = 0; i < maxPolys; i++, mp++) {
-    MLoop *ml2;
-    int j, e;
-
-    /* reverse the loop, but we keep the first vertex in the face the same,
-     * to ensure that quads are split the same way as on the other side */
-    CustomData_copy_data(
-        &result->ldata, &result->ldata, mp->loopstart, mp->loopstart + maxLoops, 1);
-
-    for (j = 1; j < mp->totloop; j++) {
-      CustomData_copy_data(&result->ldata,
-                           &result->ldata,
-                           mp->loopstart + j,
-                           mp->loopstart + maxLoops + mp->totloop - j,
-                           1);
-    }
-
-    ml2 = ml + mp->loopstart + maxLoops;
-    e = ml2[0].e;
-    for (j = 0; j < mp->totloop - 1; j++) {
-      ml2[j].e = ml2[j + 1].e;
-    }
-    ml2[mp->totloop - 1].e = e;
-
-    mp->loopstart += maxLoops;
+  {
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (maxPolys > MIRROR_PARALLEL_THRESHOLD);
+    BLI_task_parallel_range(0, maxPolys, &data, mirror_polys_cb, &settings);
   }
 
   /* adjust mirrored loop vertex and edge indices */
@@ -28,6 +28,7 @@
 
 #include "BLI_math.h"
 #include "BLI_alloca.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -175,6 +176,107 @@ static void initData(ModifierData *md)
   ltmd->merge_dist = 0.01f;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Threaded Slices
+ *
+ * Each step of the revolution writes its own slice of vertices and edges,
+ * so they can be generated in parallel.
+ * \{ */
+
+/* Only use threads when there are more vertices than this to generate. */
+#define SCREW_PARALLEL_THRESHOLD 10000
+
+typedef struct ScrewStepData {
+  Mesh *mesh;
+  Mesh *result;
+  MVert *mvert_new;
+  MEdge *medge_new;
+  const ScrewVertConnect *vert_connect;
+  float (*mtx_tx)[4];
+  const float *axis_vec;
+  float angle;
+  float screw_ofs;
+  unsigned int totvert;
+  unsigned int totedge;
+  unsigned int step_tot;
+  bool close;
+  bool use_ob_axis;
+  char axis_char;
+} ScrewStepData;
+
+static void screw_step_slice_cb(void *__restrict userdata,
+                                const int step_index,
+                                const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const ScrewStepData *data = userdata;
+  const unsigned int step = (unsigned int)step_index;
+  const unsigned int totvert = data->totvert;
+  const unsigned int varray_stride = totvert * step;
+  const MVert *mv_new_base = data->mvert_new;
+  MVert *mv_new = &data->mvert_new[varray_stride]; /* advance to the next slice */
+  MEdge *med_new = &data->medge_new[data->totedge + (totvert * (step - 1))];
+  float step_angle;
+  float nor_tx[3];
+  float mat3[3][3];
+  float mat[4][4];
+  unsigned int j;
+
+  /* Rotation Matrix */
+  step_angle = (data->angle / (float)(data->step_tot - (!data->close))) * (float)step;
+
+  if (data->use_ob_axis) {
+    axis_angle_normalized_to_mat3(mat3, data->axis_vec, step_angle);
+  }
+  else {
+    axis_angle_to_mat3_single(mat3, data->axis_char, step_angle);
+  }
+  copy_m4_m3(mat, mat3);
+
+  if (data->screw_ofs) {
+    madd_v3_v3fl(
+        mat[3], data->axis_vec, data->screw_ofs * ((float)step / (float)(data->step_tot - 1)));
+  }
+
+  /* copy a slice */
+  CustomData_copy_data(
+      &data->mesh->vdata, &data->result->vdata, 0, (int)varray_stride, (int)totvert);
+
+  for (j = 0; j < totvert; j++, mv_new_base++, mv_new++) {
+    /* set normal */
+    if (data->vert_connect) {
+      mul_v3_m3v3(nor_tx, mat3, data->vert_connect[j].no);
+
+      /* set the normal now its transformed */
+      normal_float_to_short_v3(mv_new->no, nor_tx);
+    }
+
+    /* set location */
+    copy_v3_v3(mv_new->co, mv_new_base->co);
+
+    /* only need to set these if using non cleared memory */
+    /*mv_new->mat_nr = mv_new->flag = 0;*/
+
+    if (data->use_ob_axis) {
+      sub_v3_v3(mv_new->co, data->mtx_tx[3]);
+
+      mul_m4_v3(mat, mv_new->co);
+
+      add_v3_v3(mv_new->co, data->mtx_tx[3]);
+    }
+    else {
+      mul_m4_v3(mat, mv_new->co);
+    }
+
+    /* add the new edge */
+    med_new->v1 = varray_stride + j;
+    med_new->v2 = med_new->v1 - totvert;
+    med_new->flag = ME_EDGEDRAW | ME_EDGERENDER;
+    med_new++;
+  }
+}
+
+/** \} */
+
 static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mesh *meshData)
 {
   Mesh *mesh = meshData;
@@ -226,7 +328,6 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
   float screw_ofs = ltmd->screw_ofs;
   float axis_vec[3] = {0.0f, 0.0f, 0.0f};
   float tmp_vec1[3], tmp_vec2[3];
-  float mat3[3][3];
   /* transform the coords by an object relative to this objects transformation */
   float mtx_tx[4][4];
   float mtx_tx_inv[4][4]; /* inverted */
@@ -241,7 +342,7 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
   MPoly *mpoly_orig, *mpoly_new, *mp_new;
   MLoop *mloop_orig, *mloop_new, *ml_new;
   MEdge *medge_orig, *med_orig, *med_new, *med_new_firstloop, *medge_new;
-  MVert *mvert_new, *mvert_orig, *mv_orig, *mv_new, *mv_new_base;
+  MVert *mvert_new, *mvert_orig, *mv_orig, *mv_new;
 
   Object *ob_axis = ltmd->ob_axis;
 
@@ -841,65 +942,30 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
   /* done with edge connectivity based normal flipping */
 
   /* Add Faces */
-  for (step = 1; step < step_tot; step++) {
-    const unsigned int varray_stride = totvert * step;
-    float step_angle;
-    float nor_tx[3];
-    float mat[4][4];
-    /* Rotation Matrix */
-    step_angle = (angle / (float)(step_tot - (!close))) * (float)step;
-
-    if (ob_axis != NULL) {
-      axis_angle_normalized_to_mat3(mat3, axis_vec, step_angle);
-    }
-    else {
-      axis_angle_to_mat3_single(mat3, axis_char, step_angle);
-    }
-    copy_m4_m3(mat, mat3);
-
-    if (screw_ofs) {
-      madd_v3_v3fl(mat[3], axis_vec, screw_ofs * ((float)step / (float)(step_tot - 1)));
-    }
-
-    /* copy a slice */
-    CustomData_copy_data(&mesh->vdata, &result->vdata, 0, (int)varray_stride, (int)totvert);
-
-    mv_new_base = mvert_new;
-    mv_new = &mvert_new[varray_stride]; /* advance to the next slice */
-
-    for (j = 0; j < totvert; j++, mv_new_base++, mv_new++) {
-      /* set normal */
-      if (vert_connect) {
-        mul_v3_m3v3(nor_tx, mat3, vert_connect[j].no);
-
-        /* set the normal now its transformed */
-        normal_float_to_short_v3(mv_new->no, nor_tx);
-      }
-
-      /* set location */
-      copy_v3_v3(mv_new->co, mv_new_base->co);
-
-      /* only need to set these if using non cleared memory */
-      /*mv_new->mat_nr = mv_new->flag = 0;*/
-
-      if (ob_axis != NULL) {
-        sub_v3_v3(mv_new->co, mtx_tx[3]);
-
-        mul_m4_v3(mat, mv_new->co);
-
-        add_v3_v3(mv_new->co, mtx_tx[3]);
-      }
-      else {
-        mul_m4_v3(mat, mv_new->co);
-      }
-
-      /* add the new edge */
-      med_new->v1 = varray_stride + j;
-      med_new->v2 = med_new->v1 - totvert;
-      med_new->flag = ME_EDGEDRAW | ME_EDGERENDER;
-      med_new++;
-    }
+  if (step_tot > 1) {
+    ScrewStepData data = {
+        .mesh = mesh,
+        .result = result,
+        .mvert_new = mvert_new,
+        .medge_new = medge_new,
+        .vert_connect = vert_connect,
+        .mtx_tx = mtx_tx,
+        .axis_vec = axis_vec,
+        .angle = angle,
+        .screw_ofs = screw_ofs,
+        .totvert = totvert,
+        .totedge = totedge,
+        .step_tot = step_tot,
+        .close = close,
+        .use_ob_axis = (ob_axis != NULL),
+        .axis_char = axis_char,
+    };
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = ((size_t)totvert * step_tot > SCREW_PARALLEL_THRESHOLD);
+    BLI_task_parallel_range(1, (int)step_tot, &data, screw_step_slice_cb, &settings);
   }
+  med_new = medge_new + totedge + (totvert * (step_tot - 1));
 
   /* we can avoid if using vert alloc trick */
   if (vert_connect) {
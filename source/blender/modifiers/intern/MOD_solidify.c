@@ -25,6 +25,7 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 
 #include "DNA_mesh_types.h"
@@ -189,6 +190,157 @@ BLI_INLINE void madd_v3v3short_fl(float r[3], const short a[3], const float f)
   r[2] += (float)a[2] * f;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Threaded Shell
+ *
+ * Flipping the shell polygons and offsetting vertices only write
+ * to their own element, so they run in parallel ranges.
+ * \{ */
+
+/* Only use threads for meshes with more elements than this. */
+#define SOLIDIFY_PARALLEL_THRESHOLD 10000
+
+typedef struct SolidifyShellFlipData {
+  const Mesh *mesh;
+  Mesh *result;
+  MPoly *mpoly;
+  MLoop *mloop;
+  unsigned int numVerts, numEdges, numPolys;
+  short mat_ofs, mat_nr_max;
+} SolidifyShellFlipData;
+
+static void solidify_shell_flip_cb(void *__restrict userdata,
+                                   const int index,
+                                   const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const SolidifyShellFlipData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  MPoly *mp = &data->mpoly[data->numPolys + (unsigned int)index];
+  const int loop_end = mp->totloop - 1;
+  MLoop *ml2;
+  unsigned int e;
+  int j;
+
+  /* reverses the loop direction (MLoop.v as well as custom-data)
+   * MLoop.e also needs to be corrected too, done in a separate loop below. */
+  ml2 = data->mloop + mp->loopstart + mesh->totloop;
+
+  /* slightly more involved, keep the first vertex the same for the copy,
+   * ensures the diagonals in the new face match the original. */
+  j = 0;
+  for (int j_prev = loop_end; j < mp->totloop; j_prev = j++) {
+    CustomData_copy_data(&mesh->ldata,
+                         &data->result->ldata,
+                         mp->loopstart + j,
+                         mp->loopstart + (loop_end - j_prev) + mesh->totloop,
+                         1);
+  }
+
+  if (data->mat_ofs) {
+    mp->mat_nr += data->mat_ofs;
+    CLAMP(mp->mat_nr, 0, data->mat_nr_max);
+  }
+
+  e = ml2[0].e;
+  for (j = 0; j < loop_end; j++) {
+    ml2[j].e = ml2[j + 1].e;
+  }
+  ml2[loop_end].e = e;
+
+  mp->loopstart += mesh->totloop;
+
+  for (j = 0; j < mp->totloop; j++) {
+    ml2[j].e += data->numEdges;
+    ml2[j].v += data->numVerts;
+  }
+}
+
+typedef struct SolidifyOffsetData {
+  /** First vertex to offset, the other vertex is found using \a new_vert_arr. */
+  MVert *mvert;
+  const unsigned int *new_vert_arr;
+  bool do_shell_align;
+
+  /* Simple offset. */
+  const MDeformVert *dvert;
+  int defgrp_index;
+  bool defgrp_invert;
+  float offset_fac_vg, offset_fac_vg_inv;
+  float scalar_short;
+  /** Minimum squared edge length of each vertex, NULL when not clamping. */
+  const float *vert_lens;
+  float offset, offset_sq;
+
+  /* Even thickness offset. */
+  const float (*vert_nors)[3];
+  const float *vert_angles;
+  const float *vert_accum;
+  float ofs;
+} SolidifyOffsetData;
+
+static void solidify_offset_cb(void *__restrict userdata,
+                               const int index,
+                               const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const SolidifyOffsetData *data = userdata;
+  const unsigned int i_orig = (unsigned int)index;
+  const unsigned int i = data->do_shell_align ? i_orig : data->new_vert_arr[i_orig];
+  MVert *mv = &data->mvert[i_orig];
+  float scalar_short_vgroup = data->scalar_short;
+
+  if (data->dvert) {
+    const MDeformVert *dv = &data->dvert[i];
+    if (data->defgrp_invert) {
+      scalar_short_vgroup = 1.0f - defvert_find_weight(dv, data->defgrp_index);
+    }
+    else {
+      scalar_short_vgroup = defvert_find_weight(dv, data->defgrp_index);
+    }
+    scalar_short_vgroup = (data->offset_fac_vg + (scalar_short_vgroup * data->offset_fac_vg_inv)) *
+                          data->scalar_short;
+  }
+  if (data->vert_lens) {
+    if (data->vert_lens[i] < data->offset_sq) {
+      float scalar = sqrtf(data->vert_lens[i]) / data->offset;
+      scalar_short_vgroup *= scalar;
+    }
+  }
+  madd_v3v3short_fl(mv->co, mv->no, scalar_short_vgroup);
+}
+
+static void solidify_offset_even_cb(void *__restrict userdata,
+                                    const int index,
+                                    const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const SolidifyOffsetData *data = userdata;
+  const unsigned int i_orig = (unsigned int)index;
+  const unsigned int i_other = data->do_shell_align ? i_orig : data->new_vert_arr[i_orig];
+  MVert *mv = &data->mvert[i_orig];
+
+  if (data->vert_accum[i_other]) { /* zero if unselected */
+    madd_v3_v3fl(mv->co,
+                 data->vert_nors[i_other],
+                 data->ofs * (data->vert_angles[i_other] / data->vert_accum[i_other]));
+  }
+}
+
+static void solidify_offset_apply(SolidifyOffsetData *data,
+                                  TaskParallelRangeFunc func,
+                                  MVert *mvert,
+                                  const unsigned int i_end,
+                                  const bool do_shell_align)
+{
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (i_end > SOLIDIFY_PARALLEL_THRESHOLD);
+
+  data->mvert = mvert;
+  data->do_shell_align = do_shell_align;
+  BLI_task_parallel_range(0, (int)i_end, data, func, &settings);
+}
+
+/** \} */
+
 static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
 {
   Mesh *result;
@@ -444,54 +596,22 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
   if (do_shell) {
     unsigned int i;
 
-    mp = mpoly + numPolys;
-    for (i = 0; i < mesh->totpoly; i++, mp++) {
-      const int loop_end = mp->totloop - 1;
-      MLoop *ml2;
-      unsigned int e;
-      int j;
-
-      /* reverses the loop direction (MLoop.v as well as custom-data)
-       * MLoop.e also needs to be corrected too, done in a separate loop below. */
-      ml2 = mloop + mp->loopstart + mesh->totloop;
-#if 0
-      for (j = 0; j < mp->totloop; j++) {
-        CustomData_copy_data(&mesh->ldata,
-                             &result->ldata,
-                             mp->loopstart + j,
-                             mp->loopstart + (loop_end - j) + mesh->totloop,
-                             1);
-      }
-#else
-      /* slightly more involved, keep the first vertex the same for the copy,
-       * ensures the diagonals in the new face match the original. */
-      j = 0;
-      for (int j_prev = loop_end; j < mp->totloop; j_prev = j++) {
-        CustomData_copy_data(&mesh->ldata,
-                             &result->ldata,
-                             mp->loopstart + j,
-                             mp->loopstart + (loop_end - j_prev) + mesh->totloop,
-                             1);
-      }
-#endif
-
-      if (mat_ofs) {
-        mp->mat_nr += mat_ofs;
-        CLAMP(mp->mat_nr, 0, mat_nr_max);
-      }
-
-      e = ml2[0].e;
-      for (j = 0; j < loop_end; j++) {
-        ml2[j].e = ml2[j + 1].e;
-      }
-      ml2[loop_end].e = e;
-
-      mp->loopstart += mesh->totloop;
-
-      for (j = 0; j < mp->totloop; j++) {
-        ml2[j].e += numEdges;
-        ml2[j].v += numVerts;
-      }
+    {
+      SolidifyShellFlipData data = {
+          .mesh = mesh,
+          .result = result,
+          .mpoly = mpoly,
+          .mloop = mloop,
+          .numVerts = numVerts,
+          .numEdges = numEdges,
+          .numPolys = numPolys,
+          .mat_ofs = mat_ofs,
+          .mat_nr_max = mat_nr_max,
+      };
+      ParallelRangeSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.use_threading = (numPolys > SOLIDIFY_PARALLEL_THRESHOLD);
+      BLI_task_parallel_range(0, (int)numPolys, &data, solidify_shell_flip_cb, &settings);
     }
 
     for (i = 0, ed = medge + numEdges; i < numEdges; i++, ed++) {
@@ -504,7 +624,6 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
   if ((smd->flag & MOD_SOLIDIFY_EVEN) == 0) {
     /* no even thickness, very simple */
     float scalar_short;
-    float scalar_short_vgroup;
 
     /* for clamping */
     float *vert_lens = NULL;
@@ -523,75 +642,41 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
       }
     }
 
+    SolidifyOffsetData data = {
+        .new_vert_arr = new_vert_arr,
+        .dvert = dvert,
+        .defgrp_index = defgrp_index,
+        .defgrp_invert = defgrp_invert,
+        .offset_fac_vg = offset_fac_vg,
+        .offset_fac_vg_inv = offset_fac_vg_inv,
+        .vert_lens = vert_lens,
+        .offset = offset,
+        .offset_sq = offset_sq,
+    };
+
     if (ofs_new != 0.0f) {
-      unsigned int i_orig, i_end;
+      unsigned int i_end;
       bool do_shell_align;
 
-      scalar_short = scalar_short_vgroup = ofs_new / 32767.0f;
+      scalar_short = ofs_new / 32767.0f;
 
       INIT_VERT_ARRAY_OFFSETS(false);
 
-      for (i_orig = 0; i_orig < i_end; i_orig++, mv++) {
-        const unsigned int i = do_shell_align ? i_orig : new_vert_arr[i_orig];
-        if (dvert) {
-          MDeformVert *dv = &dvert[i];
-          if (defgrp_invert) {
-            scalar_short_vgroup = 1.0f - defvert_find_weight(dv, defgrp_index);
-          }
-          else {
-            scalar_short_vgroup = defvert_find_weight(dv, defgrp_index);
-          }
-          scalar_short_vgroup = (offset_fac_vg + (scalar_short_vgroup * offset_fac_vg_inv)) *
-                                scalar_short;
-        }
-        if (do_clamp) {
-          /* always reset becaise we may have set before */
-          if (dvert == NULL) {
-            scalar_short_vgroup = scalar_short;
-          }
-          if (vert_lens[i] < offset_sq) {
-            float scalar = sqrtf(vert_lens[i]) / offset;
-            scalar_short_vgroup *= scalar;
-          }
-        }
-        madd_v3v3short_fl(mv->co, mv->no, scalar_short_vgroup);
-      }
+      data.scalar_short = scalar_short;
+      solidify_offset_apply(&data, solidify_offset_cb, mv, i_end, do_shell_align);
     }
 
     if (ofs_orig != 0.0f) {
-      unsigned int i_orig, i_end;
+      unsigned int i_end;
       bool do_shell_align;
 
-      scalar_short = scalar_short_vgroup = ofs_orig / 32767.0f;
+      scalar_short = ofs_orig / 32767.0f;
 
       /* as above but swapped */
       INIT_VERT_ARRAY_OFFSETS(true);
 
-      for (i_orig = 0; i_orig < i_end; i_orig++, mv++) {
-        const unsigned int i = do_shell_align ? i_orig : new_vert_arr[i_orig];
-        if (dvert) {
-          MDeformVert *dv = &dvert[i];
-          if (defgrp_invert) {
-            scalar_short_vgroup = 1.0f - defvert_find_weight(dv, defgrp_index);
-          }
-          else {
-            scalar_short_vgroup = defvert_find_weight(dv, defgrp_index);
-          }
-          scalar_short_vgroup = (offset_fac_vg + (scalar_short_vgroup * offset_fac_vg_inv)) *
-                                scalar_short;
-        }
-        if (do_clamp) {
-          /* always reset becaise we may have set before */
-          if (dvert == NULL) {
-            scalar_short_vgroup = scalar_short;
-          }
-          if (vert_lens[i] < offset_sq) {
-            float scalar = sqrtf(vert_lens[i]) / offset;
-            scalar_short_vgroup *= scalar;
-          }
-        }
-        madd_v3v3short_fl(mv->co, mv->no, scalar_short_vgroup);
-      }
+      data.scalar_short = scalar_short;
+      solidify_offset_apply(&data, solidify_offset_cb, mv, i_end, do_shell_align);
     }
 
     if (do_clamp) {
@@ -706,35 +791,32 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
       MEM_freeN(vert_lens_sq);
     }
 
+    SolidifyOffsetData data = {
+        .new_vert_arr = new_vert_arr,
+        .vert_nors = (const float(*)[3])vert_nors,
+        .vert_angles = vert_angles,
+        .vert_accum = vert_accum,
+    };
+
     if (ofs_new != 0.0f) {
-      unsigned int i_orig, i_end;
+      unsigned int i_end;
       bool do_shell_align;
 
       INIT_VERT_ARRAY_OFFSETS(false);
 
-      for (i_orig = 0; i_orig < i_end; i_orig++, mv++) {
-        const unsigned int i_other = do_shell_align ? i_orig : new_vert_arr[i_orig];
-        if (vert_accum[i_other]) { /* zero if unselected */
-          madd_v3_v3fl(
-              mv->co, vert_nors[i_other], ofs_new * (vert_angles[i_other] / vert_accum[i_other]));
-        }
-      }
+      data.ofs = ofs_new;
+      solidify_offset_apply(&data, solidify_offset_even_cb, mv, i_end, do_shell_align);
     }
 
     if (ofs_orig != 0.0f) {
-      unsigned int i_orig, i_end;
+      unsigned int i_end;
       bool do_shell_align;
 
       /* same as above but swapped, intentional use of 'ofs_new' */
       INIT_VERT_ARRAY_OFFSETS(true);
 
-      for (i_orig = 0; i_orig < i_end; i_orig++, mv++) {
-        const unsigned int i_other = do_shell_align ? i_orig : new_vert_arr[i_orig];
-        if (vert_accum[i_other]) { /* zero if unselected */
-          madd_v3_v3fl(
-              mv->co, vert_nors[i_other], ofs_orig * (vert_angles[i_other] / vert_accum[i_other]));
-        }
-      }
+      data.ofs = ofs_orig;
+      solidify_offset_apply(&data, solidify_offset_even_cb, mv, i_end, do_shell_align);
     }
 
     MEM_freeN(vert_angles);
@@ -33,6 +33,7 @@ extern "C" {
 
 #include "BLI_math.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -74,6 +75,86 @@ static int cloth_count_nondiag_blocks(Cloth *cloth)
   return nondiag;
 }
 
+/* Minimum number of springs for calculating their forces in parallel. */
+#define CLOTH_PARALLEL_SPRINGS 4096
+
+/* Group springs into colors that don't share vertices, so the springs of one color can be
+ * calculated in parallel. Hair bending springs add several matrix blocks and stay serial. */
+static void cloth_build_spring_colors(Cloth *cloth)
+{
+  const int springs_num = BLI_linklist_count(cloth->springs);
+  int *verts_start, *verts, *colors, *color_fill;
+  int verts_num = 0, s = 0;
+
+  cloth->spring_order = NULL;
+  cloth->spring_color_start = NULL;
+  cloth->spring_order_len = 0;
+  cloth->spring_colors = 0;
+
+  if (springs_num < CLOTH_PARALLEL_SPRINGS) {
+    return;
+  }
+
+  for (LinkNode *link = cloth->springs; link; link = link->next) {
+    ClothSpring *spring = (ClothSpring *)link->link;
+    verts_num += 2 + spring->la + spring->lb;
+  }
+
+  verts_start = (int *)MEM_malloc_arrayN(springs_num + 1, sizeof(int), "spring verts start");
+  verts = (int *)MEM_malloc_arrayN(verts_num, sizeof(int), "spring verts");
+  colors = (int *)MEM_malloc_arrayN(springs_num, sizeof(int), "spring colors");
+
+  verts_num = 0;
+  for (LinkNode *link = cloth->springs; link; link = link->next, s++) {
+    ClothSpring *spring = (ClothSpring *)link->link;
+
+    verts_start[s] = verts_num;
+    if (spring->type != CLOTH_SPRING_TYPE_BENDING_HAIR) {
+      verts[verts_num++] = spring->ij;
+      verts[verts_num++] = spring->kl;
+      for (int k = 0; k < spring->la; k++) {
+        verts[verts_num++] = spring->pa[k];
+      }
+      for (int k = 0; k < spring->lb; k++) {
+        verts[verts_num++] = spring->pb[k];
+      }
+    }
+  }
+  verts_start[s] = verts_num;
+
+  cloth->spring_colors = BPH_mass_spring_color_springs(
+      cloth->mvert_num, springs_num, verts_start, verts, colors);
+
+  /* Count sort by color, uncolored and hair bending springs go last. */
+  color_fill = (int *)MEM_calloc_arrayN(cloth->spring_colors + 2, sizeof(int), __func__);
+  s = 0;
+  for (LinkNode *link = cloth->springs; link; link = link->next, s++) {
+    ClothSpring *spring = (ClothSpring *)link->link;
+    if (spring->type == CLOTH_SPRING_TYPE_BENDING_HAIR || colors[s] == -1) {
+      colors[s] = cloth->spring_colors;
+    }
+    color_fill[colors[s] + 1]++;
+  }
+  for (int c = 0; c <= cloth->spring_colors; c++) {
+    color_fill[c + 1] += color_fill[c];
+  }
+
+  cloth->spring_color_start = (int *)MEM_dupallocN(color_fill);
+  cloth->spring_order = (ClothSpring **)MEM_malloc_arrayN(
+      springs_num, sizeof(ClothSpring *), "spring order");
+  cloth->spring_order_len = springs_num;
+
+  s = 0;
+  for (LinkNode *link = cloth->springs; link; link = link->next, s++) {
+    cloth->spring_order[color_fill[colors[s]]++] = (ClothSpring *)link->link;
+  }
+
+  MEM_freeN(color_fill);
+  MEM_freeN(colors);
+  MEM_freeN(verts);
+  MEM_freeN(verts_start);
+}
+
 int BPH_cloth_solver_init(Object *UNUSED(ob), ClothModifierData *clmd)
 {
   Cloth *cloth = clmd->clothObject;
@@ -93,6 +174,8 @@ int BPH_cloth_solver_init(Object *UNUSED(ob), ClothModifierData *clmd)
     BPH_mass_spring_set_motion_state(id, i, verts[i].x, ZERO);
   }
 
+  cloth_build_spring_colors(cloth);
+
   return 1;
 }
 
@@ -104,6 +187,11 @@ void BPH_cloth_solver_free(ClothModifierData *clmd)
     BPH_mass_spring_solver_free(cloth->implicit);
     cloth->implicit = NULL;
   }
+
+  MEM_SAFE_FREE(cloth->spring_order);
+  MEM_SAFE_FREE(cloth->spring_color_start);
+  cloth->spring_order_len = 0;
+  cloth->spring_colors = 0;
 }
 
 void BKE_cloth_solver_set_positions(ClothModifierData *clmd)
@@ -343,7 +431,9 @@ static int UNUSED_FUNCTION(cloth_calc_helper_forces)(Object *UNUSED(ob),
   return 1;
 }
 
-BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
+/* Spring forces are added to the matrix through the spring index when it's not -1,
+ * see BPH_mass_spring_force_springs_begin(). */
+BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s, int spring)
 {
   Cloth *cloth = clmd->clothObject;
   ClothSimSettings *parms = clmd->sim_parms;
@@ -395,7 +485,8 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
                                           0.0f,
                                           false,
                                           false,
-                                          parms->max_sewing);
+                                          parms->max_sewing,
+                                          spring);
     }
     else {
       float k_compression, scaling_compression;
@@ -413,7 +504,8 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
                                           parms->compression_damp,
                                           resist_compress,
                                           using_angular,
-                                          0.0f);
+                                          0.0f,
+                                          spring);
     }
 #endif
   }
@@ -436,7 +528,8 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
                                         0.0f,
                                         resist_compress,
                                         false,
-                                        0.0f);
+                                        0.0f,
+                                        spring);
 #endif
   }
   else if (s->type & CLOTH_SPRING_TYPE_BENDING) { /* calculate force of bending springs */
@@ -451,7 +544,7 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
     // Fix for [#45084] for cloth stiffness must have cb proportional to kb
     cb = kb * parms->bending_damping;
 
-    BPH_mass_spring_force_spring_bending(data, s->ij, s->kl, s->restlen, kb, cb);
+    BPH_mass_spring_force_spring_bending(data, s->ij, s->kl, s->restlen, kb, cb, spring);
 #endif
   }
   else if (s->type & CLOTH_SPRING_TYPE_BENDING_HAIR) {
@@ -512,6 +605,50 @@ static void hair_get_boundbox(ClothModifierData *clmd, float gmin[3], float gmax
   }
 }
 
+typedef struct ClothSpringForceData {
+  ClothModifierData *clmd;
+  ClothSpring **springs;
+} ClothSpringForceData;
+
+static void cloth_calc_spring_force_cb(void *__restrict userdata,
+                                       const int index,
+                                       const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  ClothSpringForceData *data = (ClothSpringForceData *)userdata;
+  ClothSpring *spring = data->springs[index];
+
+  if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+    cloth_calc_spring_force(data->clmd, spring, index);
+  }
+}
+
+static void cloth_calc_spring_forces_colored(ClothModifierData *clmd)
+{
+  Cloth *cloth = clmd->clothObject;
+  const int *color_start = cloth->spring_color_start;
+  ClothSpringForceData data = {clmd, cloth->spring_order};
+
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 256;
+
+  BPH_mass_spring_force_springs_begin(cloth->implicit, color_start[cloth->spring_colors]);
+
+  for (int c = 0; c < cloth->spring_colors; c++) {
+    BLI_task_parallel_range(
+        color_start[c], color_start[c + 1], &data, cloth_calc_spring_force_cb, &settings);
+  }
+
+  BPH_mass_spring_force_springs_end(cloth->implicit);
+
+  for (int i = color_start[cloth->spring_colors]; i < cloth->spring_order_len; i++) {
+    ClothSpring *spring = cloth->spring_order[i];
+    if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+      cloth_calc_spring_force(clmd, spring, -1);
+    }
+  }
+}
+
 static void cloth_calc_force(
     Scene *scene, ClothModifierData *clmd, float UNUSED(frame), ListBase *effectors, float time)
 {
@@ -619,11 +756,16 @@ static void cloth_calc_force(
   }
 
   // calculate spring forces
-  for (LinkNode *link = cloth->springs; link; link = link->next) {
-    ClothSpring *spring = (ClothSpring *)link->link;
-    // only handle active springs
-    if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
-      cloth_calc_spring_force(clmd, spring);
+  if (cloth->spring_order) {
+    cloth_calc_spring_forces_colored(clmd);
+  }
+  else {
+    for (LinkNode *link = cloth->springs; link; link = link->next) {
+      ClothSpring *spring = (ClothSpring *)link->link;
+      // only handle active springs
+      if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+        cloth_calc_spring_force(clmd, spring, -1);
+      }
     }
   }
 }
@@ -151,7 +151,8 @@ bool BPH_mass_spring_force_spring_linear(struct Implicit_Data *data,
                                          float damping_compression,
                                          bool resist_compress,
                                          bool new_compress,
-                                         float clamp_force);
+                                         float clamp_force,
+                                         int spring);
 /* Angular spring force between two polygons */
 bool BPH_mass_spring_force_spring_angular(struct Implicit_Data *data,
                                           int i,
@@ -165,7 +166,7 @@ bool BPH_mass_spring_force_spring_angular(struct Implicit_Data *data,
                                           float damping);
 /* Bending force, forming a triangle at the base of two structural springs */
 bool BPH_mass_spring_force_spring_bending(
-    struct Implicit_Data *data, int i, int j, float restlen, float kb, float cb);
+    struct Implicit_Data *data, int i, int j, float restlen, float kb, float cb, int spring);
 /* Angular bending force based on local target vectors */
 bool BPH_mass_spring_force_spring_bending_hair(struct Implicit_Data *data,
                                                int i,
@@ -182,6 +183,18 @@ bool BPH_mass_spring_force_spring_goal(struct Implicit_Data *data,
                                        float stiffness,
                                        float damping);
 
+/* Parallel assembly of linear and bending springs.
+ * Springs are grouped by color, springs of one color don't share vertices and can be
+ * computed from multiple threads. Between begin and end they pass their index
+ * (below num_springs) instead of -1, the matrix blocks are then added in that order. */
+int BPH_mass_spring_color_springs(int numverts,
+                                  int numsprings,
+                                  const int *spring_verts_start,
+                                  const int *spring_verts,
+                                  int *r_spring_color);
+void BPH_mass_spring_force_springs_begin(struct Implicit_Data *data, int num_springs);
+void BPH_mass_spring_force_springs_end(struct Implicit_Data *data);
+
 /* ======== Hair Volumetric Forces ======== */
 
 struct HairGrid;
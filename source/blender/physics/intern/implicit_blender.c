@@ -34,6 +34,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -50,6 +51,9 @@
 #    define CLOTH_OPENMP_LIMIT 512
 #  endif
 
+/* Minimum number of vertices before sparse matrix products are threaded. */
+#  define CLOTH_PARALLEL_LIMIT 1024
+
 //#define DEBUG_TIME
 
 #  ifdef DEBUG_TIME
@@ -636,6 +640,109 @@ DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector
   del_lfvector(temp);
 }
 
+/* Row-wise view of a sparse symmetric big matrix, so each row of a product can be computed
+ * independently. Entries are block indices shifted left by one, with the lowest bit set when
+ * the block is used transposed (as the upper triangle of the matrix). */
+typedef struct BlockRowIndex {
+  unsigned int *row_start; /* vcount + 1 offsets into entries */
+  unsigned int *entries;
+} BlockRowIndex;
+
+/* Build the row view for the vertex blocks and the first num_blocks off-diagonal blocks,
+ * the remaining ones are unused in this step. */
+static void build_block_row_index(BlockRowIndex *index, fmatrix3x3 *m, unsigned int num_blocks)
+{
+  const unsigned int vcount = m[0].vcount;
+  const unsigned int totblock = vcount + num_blocks;
+  unsigned int *row_fill;
+  unsigned int i;
+
+  index->row_start = MEM_calloc_arrayN(vcount + 1, sizeof(unsigned int), "block row start");
+  index->entries = MEM_malloc_arrayN(
+      vcount + 2 * num_blocks, sizeof(unsigned int), "block row entries");
+
+  for (i = 0; i < vcount; i++) {
+    index->row_start[i + 1]++;
+  }
+  for (i = vcount; i < totblock; i++) {
+    index->row_start[m[i].r + 1]++;
+    index->row_start[m[i].c + 1]++;
+  }
+  for (i = 0; i < vcount; i++) {
+    index->row_start[i + 1] += index->row_start[i];
+  }
+
+  row_fill = MEM_dupallocN(index->row_start);
+  for (i = 0; i < vcount; i++) {
+    index->entries[row_fill[i]++] = i << 1;
+  }
+  for (i = vcount; i < totblock; i++) {
+    index->entries[row_fill[m[i].r]++] = i << 1;
+    index->entries[row_fill[m[i].c]++] = (i << 1) | 1;
+  }
+  MEM_freeN(row_fill);
+}
+
+static void free_block_row_index(BlockRowIndex *index)
+{
+  MEM_freeN(index->row_start);
+  MEM_freeN(index->entries);
+}
+
+typedef struct BlockRowMulData {
+  float (*to)[3];
+  fmatrix3x3 *from;
+  const BlockRowIndex *index;
+  lfVector *fLongVector;
+} BlockRowMulData;
+
+static void mul_bfmatrix_lfvector_row_cb(void *__restrict userdata,
+                                         const int row,
+                                         const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const BlockRowMulData *data = userdata;
+  const BlockRowIndex *index = data->index;
+  float *to = data->to[row];
+  unsigned int i;
+
+  zero_v3(to);
+  for (i = index->row_start[row]; i < index->row_start[row + 1]; i++) {
+    const unsigned int entry = index->entries[i];
+    fmatrix3x3 *block = &data->from[entry >> 1];
+
+    if (entry & 1) {
+      /* Upper triangle, multiplication occurs with the transposed submatrix. */
+      muladd_fmatrixT_fvector(to, block->m, data->fLongVector[block->r]);
+    }
+    else {
+      muladd_fmatrix_fvector(to, block->m, data->fLongVector[block->c]);
+    }
+  }
+}
+
+/* SPARSE SYMMETRIC multiply big matrix with long vector, using a row index of its blocks.
+ * Rows are computed in parallel, each one summed in a fixed order so results don't depend
+ * on threading. */
+static void mul_bfmatrix_lfvector_indexed(float (*to)[3],
+                                          fmatrix3x3 *from,
+                                          const BlockRowIndex *index,
+                                          lfVector *fLongVector)
+{
+  const unsigned int vcount = from[0].vcount;
+  BlockRowMulData data = {
+      .to = to,
+      .from = from,
+      .index = index,
+      .fLongVector = fLongVector,
+  };
+
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (vcount > CLOTH_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, (int)vcount, &data, mul_bfmatrix_lfvector_row_cb, &settings);
+}
+
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
 /* A -= B * float + C * float --> for big matrix */
 /* VERIFIED */
@@ -654,6 +761,13 @@ DO_INLINE void subadd_bfmatrixS_bfmatrixS(
 // simulator start
 ///////////////////////////////////////////////////////////////////
 
+/* Off-diagonal block of a spring, stored per spring while springs are assembled in parallel. */
+typedef struct SpringBlock {
+  int i, j;
+  bool used;
+  float dfdx[3][3], dfdv[3][3];
+} SpringBlock;
+
 typedef struct Implicit_Data {
   /* inputs */
   fmatrix3x3 *bigI;        /* identity (constant) */
@@ -675,6 +789,10 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+
+  /* parallel spring assembly, see BPH_mass_spring_force_springs_begin() */
+  SpringBlock *spring_blocks;
+  int spring_blocks_len, spring_blocks_alloc;
 } Implicit_Data;
 
 Implicit_Data *BPH_mass_spring_solver_create(int numverts, int numsprings)
@@ -726,6 +844,8 @@ void BPH_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->dV);
   del_lfvector(id->z);
 
+  MEM_SAFE_FREE(id->spring_blocks);
+
   MEM_freeN(id);
 }
 
@@ -838,6 +958,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const BlockRowIndex *lA_index,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
@@ -865,7 +986,7 @@ static int cg_filtered(lfVector *ldV,
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
   /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
+  mul_bfmatrix_lfvector_indexed(AdV, lA, lA_index, ldV);
   sub_lfvector_lfvector(r, lB, AdV, numverts);
   filter(r, S);
 
@@ -888,7 +1009,7 @@ static int cg_filtered(lfVector *ldV,
 #  endif
 
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
+    mul_bfmatrix_lfvector_indexed(q, lA, lA_index, c);
     filter(q, S);
 
     alpha = delta_new / dot_lfvector(c, q, numverts);
@@ -1140,6 +1261,7 @@ static int cg_filtered_pre(lfVector *dv,
 bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSolverResult *result)
 {
   unsigned int numverts = data->dFdV[0].vcount;
+  BlockRowIndex index;
 
   lfVector *dFdXmV = create_lfvector(numverts);
   zero_lfvector(data->dV, numverts);
@@ -1148,7 +1270,10 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  /* All big matrices share the same block layout. */
+  build_block_row_index(&index, data->A, (unsigned int)data->num_blocks);
+
+  mul_bfmatrix_lfvector_indexed(dFdXmV, data->dFdX, &index, data->V);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1158,6 +1283,7 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   cg_filtered(data->dV,
               data->A,
+              &index,
               data->B,
               data->z,
               data->S,
@@ -1173,6 +1299,7 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
   add_lfvector_lfvector(data->Vnew, data->V, data->dV, numverts);
 
   del_lfvector(dFdXmV);
+  free_block_row_index(&index);
 
   return result->status == BPH_SOLVER_SUCCESS;
 }
@@ -1649,21 +1776,110 @@ BLI_INLINE bool spring_length(Implicit_Data *data,
   return true;
 }
 
-BLI_INLINE void apply_spring(
-    Implicit_Data *data, int i, int j, const float f[3], float dfdx[3][3], float dfdv[3][3])
+BLI_INLINE void apply_spring(Implicit_Data *data,
+                             int i,
+                             int j,
+                             const float f[3],
+                             float dfdx[3][3],
+                             float dfdv[3][3],
+                             int spring)
 {
-  int block_ij = BPH_mass_spring_add_block(data, i, j);
-
   add_v3_v3(data->F[i], f);
   sub_v3_v3(data->F[j], f);
 
   add_m3_m3m3(data->dFdX[i].m, data->dFdX[i].m, dfdx);
   add_m3_m3m3(data->dFdX[j].m, data->dFdX[j].m, dfdx);
-  sub_m3_m3m3(data->dFdX[block_ij].m, data->dFdX[block_ij].m, dfdx);
 
   add_m3_m3m3(data->dFdV[i].m, data->dFdV[i].m, dfdv);
   add_m3_m3m3(data->dFdV[j].m, data->dFdV[j].m, dfdv);
-  sub_m3_m3m3(data->dFdV[block_ij].m, data->dFdV[block_ij].m, dfdv);
+
+  if (spring >= 0) {
+    /* Off-diagonal block is added later by BPH_mass_spring_force_springs_end(). */
+    SpringBlock *block = &data->spring_blocks[spring];
+    BLI_assert(spring < data->spring_blocks_len);
+
+    block->i = i;
+    block->j = j;
+    block->used = true;
+    copy_m3_m3(block->dfdx, dfdx);
+    copy_m3_m3(block->dfdv, dfdv);
+  }
+  else {
+    int block_ij = BPH_mass_spring_add_block(data, i, j);
+
+    sub_m3_m3m3(data->dFdX[block_ij].m, data->dFdX[block_ij].m, dfdx);
+    sub_m3_m3m3(data->dFdV[block_ij].m, data->dFdV[block_ij].m, dfdv);
+  }
+}
+
+int BPH_mass_spring_color_springs(int numverts,
+                                  int numsprings,
+                                  const int *spring_verts_start,
+                                  const int *spring_verts,
+                                  int *r_spring_color)
+{
+  uint64_t *vert_colors = MEM_calloc_arrayN(numverts, sizeof(uint64_t), __func__);
+  int num_colors = 0;
+  int s, k;
+
+  for (s = 0; s < numsprings; s++) {
+    uint64_t used = 0;
+    int color;
+
+    for (k = spring_verts_start[s]; k < spring_verts_start[s + 1]; k++) {
+      used |= vert_colors[spring_verts[k]];
+    }
+
+    for (color = 0; color < 64 && (used & ((uint64_t)1 << color)); color++) {
+      /* pass */
+    }
+
+    if (color == 64) {
+      r_spring_color[s] = -1;
+      continue;
+    }
+
+    for (k = spring_verts_start[s]; k < spring_verts_start[s + 1]; k++) {
+      vert_colors[spring_verts[k]] |= (uint64_t)1 << color;
+    }
+    r_spring_color[s] = color;
+    num_colors = max_ii(num_colors, color + 1);
+  }
+
+  MEM_freeN(vert_colors);
+
+  return num_colors;
+}
+
+void BPH_mass_spring_force_springs_begin(Implicit_Data *data, int num_springs)
+{
+  if (data->spring_blocks_alloc < num_springs) {
+    MEM_SAFE_FREE(data->spring_blocks);
+    data->spring_blocks = MEM_malloc_arrayN(num_springs, sizeof(SpringBlock), "spring blocks");
+    data->spring_blocks_alloc = num_springs;
+  }
+  data->spring_blocks_len = num_springs;
+
+  for (int s = 0; s < num_springs; s++) {
+    data->spring_blocks[s].used = false;
+  }
+}
+
+void BPH_mass_spring_force_springs_end(Implicit_Data *data)
+{
+  /* Blocks are added in spring order, so the matrix doesn't depend on threading. */
+  for (int s = 0; s < data->spring_blocks_len; s++) {
+    const SpringBlock *block = &data->spring_blocks[s];
+
+    if (block->used) {
+      int block_ij = BPH_mass_spring_add_block(data, block->i, block->j);
+
+      sub_m3_m3m3(data->dFdX[block_ij].m, data->dFdX[block_ij].m, block->dfdx);
+      sub_m3_m3m3(data->dFdV[block_ij].m, data->dFdV[block_ij].m, block->dfdv);
+    }
+  }
+
+  data->spring_blocks_len = 0;
 }
 
 bool BPH_mass_spring_force_spring_linear(Implicit_Data *data,
@@ -1676,7 +1892,8 @@ bool BPH_mass_spring_force_spring_linear(Implicit_Data *data,
                                          float damping_compression,
                                          bool resist_compress,
                                          bool new_compress,
-                                         float clamp_force)
+                                         float clamp_force,
+                                         int spring)
 {
   float extent[3], length, dir[3], vel[3];
   float f[3], dfdx[3][3], dfdv[3][3];
@@ -1721,14 +1938,14 @@ bool BPH_mass_spring_force_spring_linear(Implicit_Data *data,
   madd_v3_v3fl(f, dir, damping * dot_v3v3(vel, dir));
   dfdv_damp(dfdv, dir, damping);
 
-  apply_spring(data, i, j, f, dfdx, dfdv);
+  apply_spring(data, i, j, f, dfdx, dfdv, spring);
 
   return true;
 }
 
 /* See "Stable but Responsive Cloth" (Choi, Ko 2005) */
 bool BPH_mass_spring_force_spring_bending(
-    Implicit_Data *data, int i, int j, float restlen, float kb, float cb)
+    Implicit_Data *data, int i, int j, float restlen, float kb, float cb, int spring)
 {
   float extent[3], length, dir[3], vel[3];
 
@@ -1746,7 +1963,7 @@ bool BPH_mass_spring_force_spring_bending(
     /* XXX damping not supported */
     zero_m3(dfdv);
 
-    apply_spring(data, i, j, f, dfdx, dfdv);
+    apply_spring(data, i, j, f, dfdx, dfdv, spring);
 
     return true;
   }
@@ -0,0 +1,122 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <vector>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+#include "BKE_softbody.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+}
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+#define FRAMES_LEN 16
+
+class SceneEvaluateFramesTest : public testing::Test {
+ protected:
+  Main *bmain;
+  Scene *scene;
+  ViewLayer *view_layer;
+  Object *ob;
+
+  virtual void SetUp()
+  {
+    DEG_register_node_types();
+
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = (ViewLayer *)scene->view_layers.first;
+    ob = BKE_object_add(bmain, scene, view_layer, OB_EMPTY, "Empty");
+  }
+
+  virtual void TearDown()
+  {
+    BKE_main_free(bmain);
+    DEG_free_node_types();
+  }
+};
+
+struct FramesResult {
+  Object *ob;
+  std::vector<float> frames;
+  std::vector<float> depsgraph_frames;
+  bool evaluated_copies;
+};
+
+static void frame_evaluated_cb(Depsgraph *depsgraph, float ctime, void *userdata)
+{
+  FramesResult *result = static_cast<FramesResult *>(userdata);
+
+  result->frames.push_back(ctime);
+  result->depsgraph_frames.push_back(DEG_get_ctime(depsgraph));
+  if (DEG_get_evaluated_object(depsgraph, result->ob) == result->ob) {
+    result->evaluated_copies = false;
+  }
+}
+
+TEST_F(SceneEvaluateFramesTest, FramesInOrder)
+{
+  float frames[FRAMES_LEN];
+  for (int i = 0; i < FRAMES_LEN; i++) {
+    frames[i] = (float)(i + 1);
+  }
+  const int orig_frame = scene->r.cfra;
+
+  EXPECT_FALSE(BKE_scene_has_simulation_history(scene, view_layer));
+
+  /* Serial and with more graphs than frames, as well as an uneven share of the frames. */
+  const int num_graphs[] = {1, 3, 4, FRAMES_LEN * 2};
+  for (int i = 0; i < ARRAY_SIZE(num_graphs); i++) {
+    FramesResult result;
+    result.ob = ob;
+    result.evaluated_copies = true;
+
+    EXPECT_TRUE(BKE_scene_graph_evaluate_frames(bmain,
+                                                scene,
+                                                view_layer,
+                                                false,
+                                                frames,
+                                                FRAMES_LEN,
+                                                num_graphs[i],
+                                                frame_evaluated_cb,
+                                                &result));
+
+    ASSERT_EQ(FRAMES_LEN, result.frames.size());
+    for (int frame = 0; frame < FRAMES_LEN; frame++) {
+      EXPECT_EQ(frames[frame], result.frames[frame]);
+      EXPECT_EQ(frames[frame], result.depsgraph_frames[frame]);
+    }
+    EXPECT_TRUE(result.evaluated_copies);
+  }
+
+  /* The graphs are private, the original scene stays on its frame. */
+  EXPECT_EQ(orig_frame, scene->r.cfra);
+}
+
+TEST_F(SceneEvaluateFramesTest, SimulationHistoryRejected)
+{
+  float frames[FRAMES_LEN];
+  for (int i = 0; i < FRAMES_LEN; i++) {
+    frames[i] = (float)(i + 1);
+  }
+
+  /* The soft body point cache makes each frame depend on the previous one. */
+  ob->soft = sbNew(scene);
+
+  EXPECT_TRUE(BKE_scene_has_simulation_history(scene, view_layer));
+
+  FramesResult result;
+  result.ob = ob;
+  result.evaluated_copies = true;
+
+  EXPECT_FALSE(BKE_scene_graph_evaluate_frames(
+      bmain, scene, view_layer, false, frames, FRAMES_LEN, 4, frame_evaluated_cb, &result));
+  EXPECT_EQ(0, result.frames.size());
+}
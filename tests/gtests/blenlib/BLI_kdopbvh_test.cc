@@ -2,7 +2,7 @@
 
 #include "testing/testing.h"
 
-/* TODO: ray intersection, overlap ... etc.*/
+/* TODO: ray intersection ... etc.*/
 
 extern "C" {
 #include "BLI_compiler_attrs.h"
@@ -119,6 +119,11 @@ TEST(kdopbvh, FindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12);
 }
+/* Big enough for the top level bounds to be computed in parallel. */
+TEST(kdopbvh, FindNearest_20000)
+{
+  find_nearest_points_test(20000, 1.0, 1000, 12);
+}
 
 TEST(kdopbvh, OptimalFindNearest_1)
 {
@@ -132,3 +137,97 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/* Compare self overlap against brute force, with enough leafs to split the tree in many tasks. */
+static void overlap_self_test(int points_len, char tree_type, int random_seed)
+{
+  /* Points are on a 0.01 grid, so the distances are never close to the overlap limit. */
+  const float epsilon = 0.0125f;
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, epsilon, tree_type, 6);
+
+  void *mem = MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*points)[3] = (float(*)[3])mem;
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 100, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  unsigned int overlap_len_expect = 0;
+  for (int i = 0; i < points_len; i++) {
+    for (int j = 0; j < points_len; j++) {
+      if (i != j && fabsf(points[i][0] - points[j][0]) < 2.0f * epsilon &&
+          fabsf(points[i][1] - points[j][1]) < 2.0f * epsilon &&
+          fabsf(points[i][2] - points[j][2]) < 2.0f * epsilon) {
+        overlap_len_expect++;
+      }
+    }
+  }
+
+  unsigned int overlap_len = 0;
+  BVHTreeOverlap *overlap = BLI_bvhtree_overlap(tree, tree, &overlap_len, NULL, NULL);
+  EXPECT_EQ(overlap_len, overlap_len_expect);
+  for (unsigned int i = 0; i < overlap_len; i++) {
+    EXPECT_NE(overlap[i].indexA, overlap[i].indexB);
+  }
+
+  if (overlap) {
+    MEM_freeN(overlap);
+  }
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+}
+
+TEST(kdopbvh, OverlapSelf_Binary_5000)
+{
+  overlap_self_test(5000, 2, 1234);
+}
+TEST(kdopbvh, OverlapSelf_Quad_5000)
+{
+  overlap_self_test(5000, 4, 123);
+}
+
+/* Batch ray-casting must give the same hits as casting one ray at a time. */
+TEST(kdopbvh, RayCastBatch)
+{
+  const int points_len = 2000;
+  const int rays_len = 1000;
+  struct RNG *rng = BLI_rng_new(12);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.01f, 4, 6);
+
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  BVHTreeRay *rays = (BVHTreeRay *)MEM_mallocN(sizeof(*rays) * rays_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * rays_len, __func__);
+  for (int i = 0; i < rays_len; i++) {
+    rng_v3_round(rays[i].origin, 3, rng, 1000, 2.0f);
+    BLI_rng_get_float_unit_v3(rng, rays[i].direction);
+    rays[i].radius = 0.0f;
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_batch(tree, rays, hits, rays_len, NULL, NULL, BVH_RAYCAST_DEFAULT);
+
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, rays[i].origin, rays[i].direction, 0.0f, &hit, NULL, NULL);
+    EXPECT_EQ(hits[i].index, hit.index);
+    EXPECT_EQ(hits[i].dist, hit.dist);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(rays);
+  MEM_freeN(hits);
+}
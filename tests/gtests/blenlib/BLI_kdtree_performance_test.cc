@@ -0,0 +1,72 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+}
+
+/* Compare one query at a time with batch queries, as done by merge by distance. */
+
+static void kdtree_find_nearest_tests(const int points_len, const char *id)
+{
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  KDTreeNearest_3d *nearest = (KDTreeNearest_3d *)MEM_mallocN(sizeof(*nearest) * points_len,
+                                                              __func__);
+  KDTree_3d *tree = BLI_kdtree_3d_new((unsigned int)points_len);
+  RNG *rng = BLI_rng_new(0);
+  int i;
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  for (i = 0; i < points_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i]);
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+
+  {
+    TIMEIT_START(kdtree_balance);
+    BLI_kdtree_3d_balance(tree);
+    TIMEIT_END(kdtree_balance);
+  }
+
+  {
+    TIMEIT_START(kdtree_find_nearest);
+    for (i = 0; i < points_len; i++) {
+      BLI_kdtree_3d_find_nearest(tree, points[i], &nearest[i]);
+    }
+    TIMEIT_END(kdtree_find_nearest);
+  }
+
+  {
+    TIMEIT_START(kdtree_find_nearest_batch);
+    BLI_kdtree_3d_find_nearest_batch(tree, points, (unsigned int)points_len, nearest);
+    TIMEIT_END(kdtree_find_nearest_batch);
+  }
+
+  for (i = 0; i < points_len; i++) {
+    EXPECT_EQ(nearest[i].dist, 0.0f);
+  }
+
+  BLI_rng_free(rng);
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(nearest);
+  MEM_freeN(points);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdtree, FindNearest100000)
+{
+  kdtree_find_nearest_tests(100000, "KDTree 3D - 100000");
+}
+
+TEST(kdtree, FindNearest1000000)
+{
+  kdtree_find_nearest_tests(1000000, "KDTree 3D - 1000000");
+}
@@ -0,0 +1,116 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+}
+
+static KDTree_3d *kdtree_random_points(float (*points)[3], const int points_len, const int seed)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new((unsigned int)points_len);
+  RNG *rng = BLI_rng_new(seed);
+
+  for (int i = 0; i < points_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i]);
+    mul_v3_fl(points[i], BLI_rng_get_float(rng));
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  BLI_rng_free(rng);
+  return tree;
+}
+
+static void find_nearest_batch_test(const int points_len, const int queries_len, const int seed)
+{
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  float(*queries)[3] = (float(*)[3])MEM_mallocN(sizeof(*queries) * queries_len, __func__);
+  KDTreeNearest_3d *nearest = (KDTreeNearest_3d *)MEM_mallocN(sizeof(*nearest) * queries_len,
+                                                              __func__);
+  KDTree_3d *tree = kdtree_random_points(points, points_len, seed);
+  RNG *rng = BLI_rng_new(seed + 1);
+
+  for (int i = 0; i < queries_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, queries[i]);
+  }
+
+  BLI_kdtree_3d_find_nearest_batch(tree, queries, (unsigned int)queries_len, nearest);
+
+  for (int i = 0; i < queries_len; i++) {
+    float dist_sq_best = FLT_MAX;
+    for (int j = 0; j < points_len; j++) {
+      dist_sq_best = min_ff(dist_sq_best, len_squared_v3v3(points[j], queries[i]));
+    }
+    ASSERT_NE(nearest[i].index, -1);
+    EXPECT_EQ(len_squared_v3v3(points[nearest[i].index], queries[i]), dist_sq_best);
+  }
+
+  BLI_rng_free(rng);
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(nearest);
+  MEM_freeN(queries);
+  MEM_freeN(points);
+}
+
+TEST(kdtree, FindNearestBatch_Small)
+{
+  find_nearest_batch_test(100, 100, 0);
+}
+
+/* Big enough for both balancing and queries to be threaded. */
+TEST(kdtree, FindNearestBatch_Large)
+{
+  find_nearest_batch_test(50000, 2000, 1);
+}
+
+TEST(kdtree, FindNearestBatch_Empty)
+{
+  const float co[1][3] = {{0.0f, 0.0f, 0.0f}};
+  KDTreeNearest_3d nearest;
+  KDTree_3d *tree = BLI_kdtree_3d_new(0);
+  BLI_kdtree_3d_balance(tree);
+  BLI_kdtree_3d_find_nearest_batch(tree, co, 1, &nearest);
+  EXPECT_EQ(nearest.index, -1);
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, RangeSearchBatch)
+{
+  const int points_len = 20000, queries_len = 1500;
+  const float range = 0.05f;
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  KDTreeNearest_3d **nearest = (KDTreeNearest_3d **)MEM_mallocN(sizeof(*nearest) * queries_len,
+                                                                __func__);
+  int *found = (int *)MEM_mallocN(sizeof(*found) * queries_len, __func__);
+  KDTree_3d *tree = kdtree_random_points(points, points_len, 2);
+
+  /* Query around the first points of the tree. */
+  BLI_kdtree_3d_range_search_batch(
+      tree, points, (unsigned int)queries_len, range, nearest, found);
+
+  for (int i = 0; i < queries_len; i++) {
+    int found_expect = 0;
+    for (int j = 0; j < points_len; j++) {
+      if (len_squared_v3v3(points[j], points[i]) < range * range) {
+        found_expect++;
+      }
+    }
+    EXPECT_EQ(found[i], found_expect);
+    for (int j = 1; j < found[i]; j++) {
+      EXPECT_LE(nearest[i][j - 1].dist, nearest[i][j].dist);
+    }
+    if (nearest[i]) {
+      MEM_freeN(nearest[i]);
+    }
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(found);
+  MEM_freeN(nearest);
+  MEM_freeN(points);
+}
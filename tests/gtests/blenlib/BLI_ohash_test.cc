@@ -0,0 +1,196 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_ohash.h"
+#include "BLI_rand.h"
+}
+
+#define TESTCASE_SIZE 10000
+
+static void init_keys(unsigned int keys[TESTCASE_SIZE], const int seed)
+{
+  RNG *rng = BLI_rng_new(seed);
+  unsigned int *k;
+  int i;
+
+  for (i = 0, k = keys; i < TESTCASE_SIZE;) {
+    /* Avoid duplicates, the keys are expected to be unique. */
+    unsigned int t = BLI_rng_get_uint(rng);
+    int j;
+    for (j = i; j--;) {
+      if (keys[j] == t) {
+        break;
+      }
+    }
+    if (j != -1) {
+      continue;
+    }
+    *k = t;
+    i++;
+    k++;
+  }
+  BLI_rng_free(rng);
+}
+
+TEST(ohash, InsertLookup)
+{
+  OHash *ohash = BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+  unsigned int keys[TESTCASE_SIZE], *k;
+  int i;
+
+  init_keys(keys, 0);
+
+  for (i = TESTCASE_SIZE, k = keys; i--; k++) {
+    BLI_ohash_insert(ohash, POINTER_FROM_UINT(*k), POINTER_FROM_UINT(*k));
+  }
+
+  EXPECT_EQ(BLI_ohash_len(ohash), TESTCASE_SIZE);
+
+  for (i = TESTCASE_SIZE, k = keys; i--; k++) {
+    void *v = BLI_ohash_lookup(ohash, POINTER_FROM_UINT(*k));
+    EXPECT_EQ(POINTER_AS_UINT(v), *k);
+  }
+
+  BLI_ohash_free(ohash, NULL, NULL);
+}
+
+TEST(ohash, InsertRemove)
+{
+  OHash *ohash = BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+  unsigned int keys[TESTCASE_SIZE], *k;
+  int i;
+
+  init_keys(keys, 10);
+
+  for (i = TESTCASE_SIZE, k = keys; i--; k++) {
+    BLI_ohash_insert(ohash, POINTER_FROM_UINT(*k), POINTER_FROM_UINT(*k));
+  }
+
+  EXPECT_EQ(BLI_ohash_len(ohash), TESTCASE_SIZE);
+
+  /* Remove every other key, the remaining ones must still be found. */
+  for (i = 0; i < TESTCASE_SIZE; i += 2) {
+    void *v = BLI_ohash_popkey(ohash, POINTER_FROM_UINT(keys[i]), NULL);
+    EXPECT_EQ(POINTER_AS_UINT(v), keys[i]);
+  }
+
+  EXPECT_EQ(BLI_ohash_len(ohash), TESTCASE_SIZE / 2);
+
+  for (i = 0; i < TESTCASE_SIZE; i++) {
+    EXPECT_EQ(BLI_ohash_haskey(ohash, POINTER_FROM_UINT(keys[i])), (i % 2) == 1);
+  }
+
+  for (i = 1; i < TESTCASE_SIZE; i += 2) {
+    EXPECT_TRUE(BLI_ohash_remove(ohash, POINTER_FROM_UINT(keys[i]), NULL, NULL));
+  }
+
+  EXPECT_EQ(BLI_ohash_len(ohash), 0);
+
+  BLI_ohash_free(ohash, NULL, NULL);
+}
+
+/* Many removals followed by insertions, exercising the reuse of removed slots. */
+TEST(ohash, RemoveReinsert)
+{
+  OHash *ohash = BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+  unsigned int keys[TESTCASE_SIZE];
+  int i, pass;
+
+  init_keys(keys, 20);
+
+  for (pass = 0; pass < 4; pass++) {
+    for (i = 0; i < TESTCASE_SIZE; i++) {
+      EXPECT_TRUE(BLI_ohash_reinsert(
+          ohash, POINTER_FROM_UINT(keys[i]), POINTER_FROM_INT(pass), NULL, NULL));
+    }
+    for (i = 0; i < TESTCASE_SIZE; i++) {
+      EXPECT_FALSE(BLI_ohash_reinsert(
+          ohash, POINTER_FROM_UINT(keys[i]), POINTER_FROM_INT(pass + 1), NULL, NULL));
+    }
+    EXPECT_EQ(BLI_ohash_len(ohash), TESTCASE_SIZE);
+    for (i = 0; i < TESTCASE_SIZE; i++) {
+      EXPECT_EQ(POINTER_AS_INT(BLI_ohash_popkey(ohash, POINTER_FROM_UINT(keys[i]), NULL)),
+                pass + 1);
+    }
+    EXPECT_EQ(BLI_ohash_len(ohash), 0);
+  }
+
+  BLI_ohash_free(ohash, NULL, NULL);
+}
+
+TEST(ohash, EnsureP)
+{
+  OHash *ohash = BLI_ohash_int_new(__func__);
+  void **val_p;
+
+  EXPECT_FALSE(BLI_ohash_ensure_p(ohash, POINTER_FROM_INT(1), &val_p));
+  *val_p = POINTER_FROM_INT(10);
+  EXPECT_TRUE(BLI_ohash_ensure_p(ohash, POINTER_FROM_INT(1), &val_p));
+  EXPECT_EQ(POINTER_AS_INT(*val_p), 10);
+  EXPECT_EQ(BLI_ohash_lookup_default(ohash, POINTER_FROM_INT(2), POINTER_FROM_INT(-1)),
+            POINTER_FROM_INT(-1));
+  EXPECT_EQ(BLI_ohash_lookup_p(ohash, POINTER_FROM_INT(2)), (void **)NULL);
+
+  BLI_ohash_free(ohash, NULL, NULL);
+}
+
+TEST(ohash, Iterator)
+{
+  OHash *ohash = BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+  OHashIterator ohi;
+  unsigned int keys[TESTCASE_SIZE], *k;
+  int i, count = 0;
+
+  init_keys(keys, 30);
+
+  for (i = TESTCASE_SIZE, k = keys; i--; k++) {
+    BLI_ohash_insert(ohash, POINTER_FROM_UINT(*k), POINTER_FROM_UINT(*k));
+  }
+
+  OHASH_ITER (ohi, ohash) {
+    EXPECT_EQ(BLI_ohashIterator_getKey(&ohi), BLI_ohashIterator_getValue(&ohi));
+    count++;
+  }
+  EXPECT_EQ(count, TESTCASE_SIZE);
+
+  BLI_ohash_clear(ohash, NULL, NULL);
+  EXPECT_EQ(BLI_ohash_len(ohash), 0);
+  OHASH_ITER (ohi, ohash) {
+    count++;
+  }
+  EXPECT_EQ(count, TESTCASE_SIZE);
+
+  BLI_ohash_free(ohash, NULL, NULL);
+}
+
+TEST(oset, AddHasKey)
+{
+  OSet *oset = BLI_oset_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+  OSetIterator osi;
+  unsigned int keys[TESTCASE_SIZE];
+  int i, count = 0;
+
+  init_keys(keys, 40);
+
+  for (i = 0; i < TESTCASE_SIZE; i++) {
+    EXPECT_TRUE(BLI_oset_add(oset, POINTER_FROM_UINT(keys[i])));
+    EXPECT_FALSE(BLI_oset_add(oset, POINTER_FROM_UINT(keys[i])));
+  }
+
+  EXPECT_EQ(BLI_oset_len(oset), TESTCASE_SIZE);
+
+  for (i = 0; i < TESTCASE_SIZE; i++) {
+    EXPECT_TRUE(BLI_oset_haskey(oset, POINTER_FROM_UINT(keys[i])));
+  }
+
+  OSET_ITER (osi, oset) {
+    EXPECT_TRUE(BLI_oset_haskey(oset, BLI_osetIterator_getKey(&osi)));
+    count++;
+  }
+  EXPECT_EQ(count, TESTCASE_SIZE);
+
+  BLI_oset_free(oset, NULL);
+}
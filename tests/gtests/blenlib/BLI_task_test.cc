@@ -77,3 +77,73 @@ TEST(task, MempoolIter)
 
   BLI_mempool_destroy(mempool);
 }
+
+/* Allocate elements from worker threads, then iterate over them from another parallel loop. */
+
+static void task_mempool_local_alloc_func(void *__restrict userdata,
+                                          const int index,
+                                          const ParallelRangeTLS *__restrict tls)
+{
+  int **data = (int **)userdata;
+  BLI_mempool_local *local = (BLI_mempool_local *)tls->userdata_chunk;
+
+  data[index] = (int *)BLI_mempool_local_alloc(local);
+  *data[index] = index - 1;
+
+  /* Free some of the items allocated so far by this thread, to also reuse them. */
+  if ((index % 5) == 0) {
+    BLI_mempool_local_free(local, data[index]);
+    data[index] = NULL;
+  }
+}
+
+static void task_mempool_local_finalize_func(void *__restrict UNUSED(userdata),
+                                             void *__restrict userdata_chunk)
+{
+  BLI_mempool_local_finalize((BLI_mempool_local *)userdata_chunk);
+}
+
+TEST(task, MempoolLocalAlloc)
+{
+  int *data[NUM_ITEMS];
+  BLI_mempool *mempool = BLI_mempool_create(sizeof(*data[0]), 0, 32, BLI_MEMPOOL_ALLOW_ITER);
+  BLI_mempool_local local;
+  int i;
+
+  BLI_mempool_local_init(mempool, &local);
+
+  ParallelRangeSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &local;
+  settings.userdata_chunk_size = sizeof(local);
+  settings.func_finalize = task_mempool_local_finalize_func;
+  settings.min_iter_per_thread = 16;
+
+  BLI_task_parallel_range(0, NUM_ITEMS, data, task_mempool_local_alloc_func, &settings);
+
+  int num_items = 0;
+  for (i = 0; i < NUM_ITEMS; i++) {
+    if (data[i] != NULL) {
+      num_items++;
+    }
+  }
+  EXPECT_EQ(num_items, NUM_ITEMS - (NUM_ITEMS + 4) / 5);
+  EXPECT_EQ(BLI_mempool_len(mempool), num_items);
+
+  BLI_task_parallel_mempool(mempool, &num_items, task_mempool_iter_func, true);
+
+  EXPECT_EQ(num_items, 0);
+  for (i = 0; i < NUM_ITEMS; i++) {
+    if (data[i] != NULL) {
+      EXPECT_EQ(*data[i], i);
+    }
+  }
+
+  /* Elements given back by the threads are reused by regular allocations. */
+  for (i = 0; i < NUM_ITEMS; i += 5) {
+    data[i] = (int *)BLI_mempool_alloc(mempool);
+  }
+  EXPECT_EQ(BLI_mempool_len(mempool), NUM_ITEMS);
+
+  BLI_mempool_destroy(mempool);
+}
@@ -0,0 +1,318 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include <string.h>
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_math_base.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+#include "PIL_time.h"
+
+#include "BPH_mass_spring.h"
+#include "implicit.h"
+}
+
+/* Synthetic cloth: a square grid of size x size vertices hanging from its top row,
+ * with the structural, shear and bending springs the cloth modifier creates for a
+ * grid mesh. Times force assembly and the velocity solve separately, with springs
+ * assembled one by one or by color in parallel. */
+
+#define STEPS 5
+
+typedef struct GridSpring {
+  int i, j;
+  float restlen;
+  int type;
+} GridSpring;
+
+enum {
+  SPRING_STRUCTURAL,
+  SPRING_SHEAR,
+  SPRING_BENDING,
+};
+
+static int grid_springs_create(const int size, const float spacing, GridSpring **r_springs)
+{
+  const int springs_len = 2 * size * (size - 1) + 2 * (size - 1) * (size - 1) +
+                          2 * size * (size - 2);
+  GridSpring *springs = (GridSpring *)MEM_mallocN(sizeof(*springs) * springs_len, __func__);
+  GridSpring *s = springs;
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int v = y * size + x;
+      if (x + 1 < size) {
+        *s++ = {v, v + 1, spacing, SPRING_STRUCTURAL};
+      }
+      if (y + 1 < size) {
+        *s++ = {v, v + size, spacing, SPRING_STRUCTURAL};
+      }
+      if (x + 1 < size && y + 1 < size) {
+        *s++ = {v, v + size + 1, spacing * (float)M_SQRT2, SPRING_SHEAR};
+        *s++ = {v + 1, v + size, spacing * (float)M_SQRT2, SPRING_SHEAR};
+      }
+      if (x + 2 < size) {
+        *s++ = {v, v + 2, spacing * 2.0f, SPRING_BENDING};
+      }
+      if (y + 2 < size) {
+        *s++ = {v, v + 2 * size, spacing * 2.0f, SPRING_BENDING};
+      }
+    }
+  }
+  EXPECT_EQ(s - springs, springs_len);
+
+  *r_springs = springs;
+  return springs_len;
+}
+
+/* Sort springs by color, returns the number of colors. */
+static int grid_springs_color(GridSpring *springs,
+                              const int springs_len,
+                              const int verts_len,
+                              int **r_color_start)
+{
+  int *verts_start = (int *)MEM_mallocN(sizeof(int) * (springs_len + 1), __func__);
+  int *verts = (int *)MEM_mallocN(sizeof(int) * springs_len * 2, __func__);
+  int *colors = (int *)MEM_mallocN(sizeof(int) * springs_len, __func__);
+
+  for (int i = 0; i < springs_len; i++) {
+    verts_start[i] = i * 2;
+    verts[i * 2] = springs[i].i;
+    verts[i * 2 + 1] = springs[i].j;
+  }
+  verts_start[springs_len] = springs_len * 2;
+
+  const int colors_len = BPH_mass_spring_color_springs(
+      verts_len, springs_len, verts_start, verts, colors);
+
+  int *color_start = (int *)MEM_callocN(sizeof(int) * (colors_len + 1), __func__);
+  GridSpring *sorted = (GridSpring *)MEM_mallocN(sizeof(*sorted) * springs_len, __func__);
+  for (int i = 0; i < springs_len; i++) {
+    /* A regular grid never needs more than 64 colors. */
+    EXPECT_NE(colors[i], -1);
+    color_start[colors[i] + 1]++;
+  }
+  for (int c = 0; c < colors_len; c++) {
+    color_start[c + 1] += color_start[c];
+  }
+  int *color_fill = (int *)MEM_dupallocN(color_start);
+  for (int i = 0; i < springs_len; i++) {
+    sorted[color_fill[colors[i]]++] = springs[i];
+  }
+  memcpy(springs, sorted, sizeof(*springs) * springs_len);
+
+  MEM_freeN(color_fill);
+  MEM_freeN(sorted);
+  MEM_freeN(colors);
+  MEM_freeN(verts);
+  MEM_freeN(verts_start);
+
+  *r_color_start = color_start;
+  return colors_len;
+}
+
+typedef struct GridForceData {
+  Implicit_Data *data;
+  const GridSpring *springs;
+  float k_tension, k_shear, k_bend;
+  bool colored;
+} GridForceData;
+
+static void grid_calc_spring_force_cb(void *__restrict userdata,
+                                      const int index,
+                                      const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+  const GridForceData *force = (const GridForceData *)userdata;
+  const GridSpring *s = &force->springs[index];
+  const int spring = force->colored ? index : -1;
+
+  switch (s->type) {
+    case SPRING_STRUCTURAL:
+      BPH_mass_spring_force_spring_linear(force->data,
+                                          s->i,
+                                          s->j,
+                                          s->restlen,
+                                          force->k_tension,
+                                          5.0f,
+                                          0.0f,
+                                          0.0f,
+                                          false,
+                                          false,
+                                          0.0f,
+                                          spring);
+      break;
+    case SPRING_SHEAR:
+      BPH_mass_spring_force_spring_linear(force->data,
+                                          s->i,
+                                          s->j,
+                                          s->restlen,
+                                          force->k_shear,
+                                          5.0f,
+                                          0.0f,
+                                          0.0f,
+                                          false,
+                                          false,
+                                          0.0f,
+                                          spring);
+      break;
+    case SPRING_BENDING:
+      BPH_mass_spring_force_spring_bending(
+          force->data, s->i, s->j, s->restlen, force->k_bend, force->k_bend * 0.5f, spring);
+      break;
+  }
+}
+
+static void grid_calc_force(Implicit_Data *data,
+                            const int verts_len,
+                            const GridSpring *springs,
+                            const int springs_len,
+                            const int *color_start,
+                            const int colors_len,
+                            const float spacing)
+{
+  /* Same scale as the default cloth settings. */
+  const float gravity[3] = {0.0f, 0.0f, -9.81f * 0.001f};
+  GridForceData force = {
+      data, springs, 15.0f / spacing, 5.0f / spacing, 0.5f / (20.0f * spacing), colors_len > 0};
+
+  BPH_mass_spring_clear_forces(data);
+  for (int i = 0; i < verts_len; i++) {
+    BPH_mass_spring_force_gravity(data, i, 0.3f, gravity);
+  }
+  BPH_mass_spring_force_drag(data, 0.01f);
+
+  if (force.colored) {
+    ParallelRangeSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 256;
+
+    BPH_mass_spring_force_springs_begin(data, springs_len);
+    for (int c = 0; c < colors_len; c++) {
+      BLI_task_parallel_range(
+          color_start[c], color_start[c + 1], &force, grid_calc_spring_force_cb, &settings);
+    }
+    BPH_mass_spring_force_springs_end(data);
+  }
+  else {
+    for (int i = 0; i < springs_len; i++) {
+      grid_calc_spring_force_cb(&force, i, NULL);
+    }
+  }
+}
+
+static void mass_spring_grid_test(const int size, const bool colored, float r_co_last[3])
+{
+  const int verts_len = size * size;
+  const float spacing = 2.0f / (float)(size - 1);
+  const float dt = 1.0f / 5.0f;
+  const float zero[3] = {0.0f, 0.0f, 0.0f};
+  GridSpring *springs;
+  const int springs_len = grid_springs_create(size, spacing, &springs);
+  int *color_start = NULL;
+  int colors_len = 0;
+  double time_force = 0.0, time_solve = 0.0;
+  int iterations = 0;
+
+  printf("\n========== STARTING Mass Spring Grid %d x %d (%d springs%s) ==========\n",
+         size,
+         size,
+         springs_len,
+         colored ? ", colored" : "");
+
+  if (colored) {
+    colors_len = grid_springs_color(springs, springs_len, verts_len, &color_start);
+    printf("%d colors\n", colors_len);
+  }
+
+  Implicit_Data *data = BPH_mass_spring_solver_create(verts_len, springs_len);
+  for (int i = 0; i < verts_len; i++) {
+    /* Slightly stretched, so the structural springs are active from the start. */
+    const float co[3] = {
+        (float)(i % size) * spacing * 1.01f, 0.0f, -(float)(i / size) * spacing * 1.01f};
+    float rot[3][3];
+    unit_m3(rot);
+    BPH_mass_spring_set_vertex_mass(data, i, 0.3f);
+    BPH_mass_spring_set_rest_transform(data, i, rot);
+    BPH_mass_spring_set_motion_state(data, i, co, zero);
+  }
+
+  for (int step = 0; step < STEPS; step++) {
+    ImplicitSolverResult result;
+
+    /* Pin the top row. */
+    BPH_mass_spring_clear_constraints(data);
+    for (int i = 0; i < size; i++) {
+      BPH_mass_spring_add_constraint_ndof0(data, i, zero);
+    }
+
+    double time_start = PIL_check_seconds_timer();
+    grid_calc_force(
+        data, verts_len, springs, springs_len, color_start, colors_len, spacing);
+    time_force += PIL_check_seconds_timer() - time_start;
+
+    time_start = PIL_check_seconds_timer();
+    BPH_mass_spring_solve_velocities(data, dt, &result);
+    time_solve += PIL_check_seconds_timer() - time_start;
+
+    /* Dense grids may hit the iteration limit, like real cloth does. */
+    EXPECT_EQ(result.status & (BPH_SOLVER_NUMERICAL_ISSUE | BPH_SOLVER_INVALID_INPUT), 0);
+    iterations += result.iterations;
+
+    BPH_mass_spring_solve_positions(data, dt);
+    BPH_mass_spring_apply_result(data);
+  }
+
+  /* The cloth falls, but stays in one piece. */
+  float co_first[3], co_last[3];
+  BPH_mass_spring_get_position(data, 0, co_first);
+  BPH_mass_spring_get_position(data, verts_len - 1, co_last);
+  EXPECT_FLOAT_EQ(co_first[2], 0.0f);
+  EXPECT_LT(co_last[2], -2.0f);
+  EXPECT_GT(co_last[2], -3.0f);
+  copy_v3_v3(r_co_last, co_last);
+
+  printf("force assembly: %.4fs, velocity solve: %.4fs (%d CG iterations) per step\n",
+         time_force / STEPS,
+         time_solve / STEPS,
+         iterations / STEPS);
+
+  BPH_mass_spring_solver_free(data);
+  MEM_freeN(springs);
+  if (color_start) {
+    MEM_freeN(color_start);
+  }
+
+  printf("========== ENDED Mass Spring Grid %d x %d ==========\n\n", size, size);
+}
+
+/* Colored assembly only changes the order diagonal blocks are summed in. */
+static void mass_spring_grid_compare(const int size)
+{
+  float co_serial[3], co_colored[3];
+
+  mass_spring_grid_test(size, false, co_serial);
+  mass_spring_grid_test(size, true, co_colored);
+
+  EXPECT_NEAR(co_serial[0], co_colored[0], 1e-4f);
+  EXPECT_NEAR(co_serial[1], co_colored[1], 1e-4f);
+  EXPECT_NEAR(co_serial[2], co_colored[2], 1e-4f);
+}
+
+TEST(mass_spring, Grid64)
+{
+  mass_spring_grid_compare(64);
+}
+
+TEST(mass_spring, Grid256)
+{
+  mass_spring_grid_compare(256);
+}
+
+TEST(mass_spring, Grid448)
+{
+  mass_spring_grid_compare(448);
+}